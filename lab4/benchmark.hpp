@@ -0,0 +1,296 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "csr_matrix.hpp"
+#include "compressed_vector.hpp"
+#include "triplet_builder.hpp"
+
+// Статистика по повторным запускам одной операции
+struct TimingStats
+{
+    size_t repeats = 0;
+    double min = 0, p10 = 0, median = 0, p90 = 0, max = 0, mean = 0; // секунды
+};
+
+inline double percentile(const std::vector<double> &sorted, double q)
+{
+    if (sorted.empty())
+        return 0;
+    double position = q * (sorted.size() - 1);
+    size_t lower = static_cast<size_t>(position);
+    size_t upper = std::min(lower + 1, sorted.size() - 1);
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * (position - lower);
+}
+
+inline TimingStats summarize(std::vector<double> samples)
+{
+    TimingStats stats;
+    std::sort(samples.begin(), samples.end());
+    stats.repeats = samples.size();
+    if (samples.empty())
+        return stats;
+    stats.min = samples.front();
+    stats.max = samples.back();
+    stats.p10 = percentile(samples, 0.1);
+    stats.median = percentile(samples, 0.5);
+    stats.p90 = percentile(samples, 0.9);
+    for (double sample : samples)
+        stats.mean += sample;
+    stats.mean /= samples.size();
+    return stats;
+}
+
+// warmup прогревочных запусков (не учитываются) и repeats измеряемых
+template <typename F>
+TimingStats measure(F operation, size_t warmup, size_t repeats)
+{
+    for (size_t r = 0; r < warmup; ++r)
+        operation();
+    std::vector<double> samples;
+    samples.reserve(repeats);
+    for (size_t r = 0; r < repeats; ++r)
+    {
+        auto start = std::chrono::steady_clock::now();
+        operation();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double>(end - start).count());
+    }
+    return summarize(samples);
+}
+
+// Одна строка результатов
+struct BenchmarkRecord
+{
+    std::string operation;      // например "matvec"
+    std::string implementation; // например "csr", "dense"
+    std::string type;           // "double", "float"
+    std::string structure;      // "random", "banded", "powerlaw", "blocked"
+    size_t size = 0;
+    double density = 0;
+    size_t nonZeros = 0;
+    double flops = 0; // число операций за один запуск, 0 — не определено
+    double bytes = 0; // объём прочитанных данных за один запуск, 0 — не определено
+    double items = 0; // число обработанных объектов за один запуск (например, матриц), 0 — не определено
+    TimingStats stats;
+
+    double gflops() const { return flops > 0 && stats.median > 0 ? flops / stats.median / 1e9 : 0; }
+    double gbytes() const { return bytes > 0 && stats.median > 0 ? bytes / stats.median / 1e9 : 0; }
+    double itemsPerSecond() const { return items > 0 && stats.median > 0 ? items / stats.median : 0; }
+};
+
+enum class ReportFormat
+{
+    Text,
+    CSV,
+    JSON
+};
+
+inline ReportFormat parseReportFormat(const std::string &name)
+{
+    if (name == "text")
+        return ReportFormat::Text;
+    if (name == "csv")
+        return ReportFormat::CSV;
+    if (name == "json")
+        return ReportFormat::JSON;
+    throw std::invalid_argument("Unknown report format: " + name);
+}
+
+inline std::string jsonEscape(const std::string &text)
+{
+    std::string result;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+inline void writeReport(std::ostream &out, const std::vector<BenchmarkRecord> &records, ReportFormat format)
+{
+    out << std::setprecision(6);
+    if (format == ReportFormat::CSV)
+    {
+        out << "operation,implementation,type,structure,size,density,nnz,repeats,min_s,p10_s,median_s,p90_s,max_s,"
+               "mean_s,gflops,gbytes_per_s,items_per_s\n";
+        for (const BenchmarkRecord &r : records)
+            out << r.operation << "," << r.implementation << "," << r.type << "," << r.structure << "," << r.size << ","
+                << r.density << "," << r.nonZeros << "," << r.stats.repeats << "," << r.stats.min << "," << r.stats.p10
+                << "," << r.stats.median << "," << r.stats.p90 << "," << r.stats.max << "," << r.stats.mean << ","
+                << r.gflops() << "," << r.gbytes() << "," << r.itemsPerSecond() << "\n";
+    }
+    else if (format == ReportFormat::JSON)
+    {
+        out << "[\n";
+        for (size_t k = 0; k < records.size(); ++k)
+        {
+            const BenchmarkRecord &r = records[k];
+            out << "  {\"operation\": \"" << jsonEscape(r.operation) << "\", \"implementation\": \""
+                << jsonEscape(r.implementation) << "\", \"type\": \"" << jsonEscape(r.type) << "\", \"structure\": \""
+                << jsonEscape(r.structure) << "\", \"size\": " << r.size << ", \"density\": " << r.density
+                << ", \"nnz\": " << r.nonZeros << ", \"repeats\": " << r.stats.repeats << ", \"min_s\": " << r.stats.min
+                << ", \"p10_s\": " << r.stats.p10 << ", \"median_s\": " << r.stats.median << ", \"p90_s\": " << r.stats.p90
+                << ", \"max_s\": " << r.stats.max << ", \"mean_s\": " << r.stats.mean << ", \"gflops\": " << r.gflops()
+                << ", \"gbytes_per_s\": " << r.gbytes() << ", \"items_per_s\": " << r.itemsPerSecond() << "}"
+                << (k + 1 < records.size() ? "," : "") << "\n";
+        }
+        out << "]\n";
+    }
+    else
+    {
+        out << std::left << std::setw(18) << "operation" << std::setw(20) << "implementation" << std::setw(8) << "type"
+            << std::setw(10) << "structure" << std::right << std::setw(9) << "size" << std::setw(10) << "density"
+            << std::setw(11) << "nnz" << std::setw(12) << "median, s" << std::setw(12) << "p10, s" << std::setw(12)
+            << "p90, s" << std::setw(10) << "GFLOP/s" << std::setw(10) << "GB/s" << std::setw(12) << "items/s" << "\n";
+        out << std::setprecision(4);
+        for (const BenchmarkRecord &r : records)
+            out << std::left << std::setw(18) << r.operation << std::setw(20) << r.implementation << std::setw(8) << r.type
+                << std::setw(10) << r.structure << std::right << std::setw(9) << r.size << std::setw(10) << r.density
+                << std::setw(11) << r.nonZeros << std::setw(12) << r.stats.median << std::setw(12) << r.stats.p10
+                << std::setw(12) << r.stats.p90 << std::setw(10) << r.gflops() << std::setw(10) << r.gbytes()
+                << std::setw(12) << r.itemsPerSecond() << "\n";
+    }
+}
+
+// Генераторы тестовых данных с заданной плотностью (доля ненулевых элементов)
+enum class MatrixStructure
+{
+    Random,  // равномерно случайные позиции
+    Banded,  // лента вокруг диагонали
+    PowerLaw, // длины строк по степенному закону, как у графов реальных сетей
+    Blocked   // плотные блоки в случайных позициях, как в задачах МКЭ
+};
+
+inline std::string structureName(MatrixStructure structure)
+{
+    switch (structure)
+    {
+    case MatrixStructure::Banded:
+        return "banded";
+    case MatrixStructure::PowerLaw:
+        return "powerlaw";
+    case MatrixStructure::Blocked:
+        return "blocked";
+    default:
+        return "random";
+    }
+}
+
+inline MatrixStructure parseStructure(const std::string &name)
+{
+    if (name == "random")
+        return MatrixStructure::Random;
+    if (name == "banded")
+        return MatrixStructure::Banded;
+    if (name == "powerlaw")
+        return MatrixStructure::PowerLaw;
+    if (name == "blocked")
+        return MatrixStructure::Blocked;
+    throw std::invalid_argument("Unknown matrix structure: " + name);
+}
+
+template <typename T>
+T randomValue(std::mt19937_64 &rng)
+{
+    return static_cast<T>(1 + rng() % 99) / T(10);
+}
+
+template <typename T>
+CSRMatrix<T> generateMatrix(size_t n, double density, MatrixStructure structure, std::mt19937_64 &rng,
+                            size_t blockSize = 4)
+{
+    TripletBuilder<T> builder(n, n);
+    size_t target = static_cast<size_t>(std::max(1.0, density * n * n));
+    builder.reserve(target);
+    if (structure == MatrixStructure::Banded)
+    {
+        size_t halfBand = std::min(n, static_cast<size_t>(density * n / 2));
+        for (size_t i = 0; i < n; ++i)
+        {
+            size_t first = i > halfBand ? i - halfBand : 0;
+            size_t last = std::min(n - 1, i + halfBand);
+            for (size_t j = first; j <= last; ++j)
+                builder.add(i, j, randomValue<T>(rng));
+        }
+    }
+    else if (structure == MatrixStructure::PowerLaw)
+    {
+        // Длина строки ранга r пропорциональна 1 / (r + 1), ранги перемешаны
+        std::vector<size_t> ranks(n);
+        for (size_t i = 0; i < n; ++i)
+            ranks[i] = i;
+        std::shuffle(ranks.begin(), ranks.end(), rng);
+        double harmonic = 0;
+        for (size_t r = 0; r < n; ++r)
+            harmonic += 1.0 / (r + 1);
+        for (size_t i = 0; i < n; ++i)
+        {
+            size_t length = std::min(n, static_cast<size_t>(std::ceil(target / harmonic / (ranks[i] + 1))));
+            for (size_t k = 0; k < length; ++k)
+                builder.add(i, rng() % n, randomValue<T>(rng));
+        }
+    }
+    else if (structure == MatrixStructure::Blocked)
+    {
+        // Блоки blockSize x blockSize, выровненные по сетке блоков
+        size_t blocks = (n + blockSize - 1) / blockSize;
+        size_t count = std::max<size_t>(1, target / (blockSize * blockSize));
+        for (size_t k = 0; k < count; ++k)
+        {
+            size_t row = rng() % blocks * blockSize, col = rng() % blocks * blockSize;
+            for (size_t r = row; r < std::min(n, row + blockSize); ++r)
+                for (size_t c = col; c < std::min(n, col + blockSize); ++c)
+                    builder.add(r, c, randomValue<T>(rng));
+        }
+    }
+    else
+    {
+        for (size_t k = 0; k < target; ++k)
+            builder.add(rng() % n, rng() % n, randomValue<T>(rng));
+    }
+    return builder.build();
+}
+
+template <typename T>
+CompressedVector<T> generateVector(size_t n, double density, std::mt19937_64 &rng)
+{
+    VectorBuilder<T> builder(n);
+    size_t target = static_cast<size_t>(std::max(1.0, density * n));
+    for (size_t k = 0; k < target; ++k)
+        builder.add(rng() % n, randomValue<T>(rng));
+    return builder.build();
+}
+
+// Разбор списка через запятую: "1,2,3"
+template <typename T>
+std::vector<T> parseList(const std::string &text)
+{
+    std::vector<T> result;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        std::stringstream itemStream(item);
+        T value;
+        if (!(itemStream >> value))
+            throw std::invalid_argument("Cannot parse list item: " + item);
+        result.push_back(value);
+    }
+    return result;
+}
+
+#endif // BENCHMARK_HPP
@@ -0,0 +1,448 @@
+#ifndef BSR_MATRIX_HPP
+#define BSR_MATRIX_HPP
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "csr_matrix.hpp"
+#include "sparse_matrix.hpp"
+
+// Ядра для плотных блоков B x B (хранение по строкам). Размер блока известен при компиляции,
+// поэтому циклы разворачиваются полностью, а строка блока накапливается в регистрах
+// (в типе S — Accumulator<T> при умножении на вектор).
+namespace bsr_detail
+{
+    // y += A x
+    template <typename T, size_t B>
+    struct BlockMultiplyAdd
+    {
+        template <typename S>
+        static void apply(const T *block, const T *x, S *y)
+        {
+            for (size_t r = 0; r < B; ++r)
+            {
+                S sum = 0;
+                for (size_t c = 0; c < B; ++c)
+                    sum += static_cast<S>(block[r * B + c]) * x[c];
+                y[r] += sum;
+            }
+        }
+    };
+
+    template <typename T>
+    struct BlockMultiplyAdd<T, 3>
+    {
+        template <typename S>
+        static void apply(const T *a, const T *x, S *y)
+        {
+            S x0 = x[0], x1 = x[1], x2 = x[2];
+            y[0] += a[0] * x0 + a[1] * x1 + a[2] * x2;
+            y[1] += a[3] * x0 + a[4] * x1 + a[5] * x2;
+            y[2] += a[6] * x0 + a[7] * x1 + a[8] * x2;
+        }
+    };
+
+    template <typename T>
+    struct BlockMultiplyAdd<T, 4>
+    {
+        template <typename S>
+        static void apply(const T *a, const T *x, S *y)
+        {
+            S x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3];
+            y[0] += a[0] * x0 + a[1] * x1 + a[2] * x2 + a[3] * x3;
+            y[1] += a[4] * x0 + a[5] * x1 + a[6] * x2 + a[7] * x3;
+            y[2] += a[8] * x0 + a[9] * x1 + a[10] * x2 + a[11] * x3;
+            y[3] += a[12] * x0 + a[13] * x1 + a[14] * x2 + a[15] * x3;
+        }
+    };
+
+    // C += A * B для блоков
+    template <typename T, size_t B>
+    void multiplyBlocks(const T *a, const T *b, T *c)
+    {
+        for (size_t r = 0; r < B; ++r)
+            for (size_t k = 0; k < B; ++k)
+            {
+                T ark = a[r * B + k];
+                for (size_t j = 0; j < B; ++j)
+                    c[r * B + j] += ark * b[k * B + j];
+            }
+    }
+
+    template <typename T, size_t B>
+    void transposeBlock(const T *source, T *destination)
+    {
+        for (size_t r = 0; r < B; ++r)
+            for (size_t c = 0; c < B; ++c)
+                destination[c * B + r] = source[r * B + c];
+    }
+
+    template <typename T, size_t B>
+    bool isZeroBlock(const T *block)
+    {
+        for (size_t k = 0; k < B * B; ++k)
+            if (block[k] != 0)
+                return false;
+        return true;
+    }
+}
+
+// Блочный сжатый строчный формат (Block Compressed Sparse Row) с блоками B x B.
+// Блочная строка i занимает диапазон [block_ptr[i], block_ptr[i + 1]) массива block_col,
+// значения блока k хранятся по строкам в values[k * B * B, (k + 1) * B * B).
+// Если размеры матрицы не кратны B, последние блоки дополняются нулями.
+template <typename T, size_t B>
+class BSRMatrix
+{
+    static_assert(B > 0, "Block size must be positive");
+
+private:
+    static constexpr size_t BB = B * B;
+
+    size_t rows, cols;
+    size_t blockRows, blockCols;
+    std::vector<size_t> block_ptr;
+    std::vector<size_t> block_col;
+    std::vector<T> values;
+
+    static size_t blocksFor(size_t n) { return (n + B - 1) / B; }
+
+    // Удаление блоков, ставших нулевыми
+    void dropZeroBlocks()
+    {
+        size_t write = 0, start = 0;
+        for (size_t i = 0; i < blockRows; ++i)
+        {
+            for (size_t k = start; k < block_ptr[i + 1]; ++k)
+            {
+                if (bsr_detail::isZeroBlock<T, B>(&values[k * BB]))
+                    continue;
+                block_col[write] = block_col[k];
+                std::copy(values.begin() + k * BB, values.begin() + (k + 1) * BB, values.begin() + write * BB);
+                ++write;
+            }
+            start = block_ptr[i + 1];
+            block_ptr[i + 1] = write;
+        }
+        block_col.resize(write);
+        values.resize(write * BB);
+    }
+
+public:
+    BSRMatrix(size_t rows, size_t cols)
+        : rows(rows), cols(cols), blockRows(blocksFor(rows)), blockCols(blocksFor(cols)), block_ptr(blockRows + 1, 0) {}
+
+    BSRMatrix(size_t rows, size_t cols, std::vector<size_t> block_ptr, std::vector<size_t> block_col, std::vector<T> values)
+        : rows(rows), cols(cols), blockRows(blocksFor(rows)), blockCols(blocksFor(cols)),
+          block_ptr(std::move(block_ptr)), block_col(std::move(block_col)), values(std::move(values))
+    {
+        if (this->block_ptr.size() != blockRows + 1 || this->block_ptr.front() != 0 ||
+            this->block_ptr.back() != this->block_col.size() || this->values.size() != this->block_col.size() * BB)
+            throw std::invalid_argument("Inconsistent BSR arrays");
+        for (size_t i = 0; i < blockRows; ++i)
+        {
+            if (this->block_ptr[i] > this->block_ptr[i + 1])
+                throw std::invalid_argument("Inconsistent BSR arrays");
+            for (size_t k = this->block_ptr[i]; k < this->block_ptr[i + 1]; ++k)
+            {
+                if (this->block_col[k] >= blockCols)
+                    throw std::out_of_range("Index out of range");
+                if (k > this->block_ptr[i] && this->block_col[k - 1] >= this->block_col[k])
+                    throw std::invalid_argument("BSR block columns must be sorted and unique");
+            }
+        }
+    }
+
+    // Разбиение скалярной матрицы на блоки: блок хранится, если в нём есть хотя бы один ненулевой элемент
+    explicit BSRMatrix(const CSRMatrix<T> &matrix)
+        : rows(matrix.getRows()), cols(matrix.getCols()), blockRows(blocksFor(rows)), blockCols(blocksFor(cols)),
+          block_ptr(blockRows + 1, 0)
+    {
+        const std::vector<size_t> &ptr = matrix.rowPtr();
+        const std::vector<size_t> &idx = matrix.colIdx();
+        const std::vector<T> &val = matrix.getValues();
+        std::vector<size_t> position(blockCols, static_cast<size_t>(-1));
+        for (size_t bi = 0; bi < blockRows; ++bi)
+        {
+            size_t first = bi * B, last = std::min(rows, first + B);
+            size_t start = block_col.size();
+            for (size_t i = first; i < last; ++i)
+                for (size_t k = ptr[i]; k < ptr[i + 1]; ++k)
+                {
+                    size_t bj = idx[k] / B;
+                    if (position[bj] == static_cast<size_t>(-1))
+                    {
+                        position[bj] = 0;
+                        block_col.push_back(bj);
+                    }
+                }
+            std::sort(block_col.begin() + start, block_col.end());
+            for (size_t k = start; k < block_col.size(); ++k)
+                position[block_col[k]] = k;
+            values.resize(block_col.size() * BB, T(0));
+            for (size_t i = first; i < last; ++i)
+                for (size_t k = ptr[i]; k < ptr[i + 1]; ++k)
+                    values[position[idx[k] / B] * BB + (i - first) * B + idx[k] % B] = val[k];
+            for (size_t k = start; k < block_col.size(); ++k)
+                position[block_col[k]] = static_cast<size_t>(-1);
+            block_ptr[bi + 1] = block_col.size();
+        }
+    }
+
+    explicit BSRMatrix(const SparseMatrix<T> &matrix) : BSRMatrix(CSRMatrix<T>(matrix)) {}
+
+    CSRMatrix<T> toCSR() const
+    {
+        std::vector<size_t> ptr(rows + 1, 0), idx;
+        std::vector<T> val;
+        for (size_t i = 0; i < rows; ++i)
+        {
+            size_t bi = i / B, r = i % B;
+            for (size_t k = block_ptr[bi]; k < block_ptr[bi + 1]; ++k)
+            {
+                const T *line = &values[k * BB + r * B];
+                for (size_t c = 0; c < B; ++c)
+                {
+                    size_t col = block_col[k] * B + c;
+                    if (col < cols && line[c] != 0)
+                    {
+                        idx.push_back(col);
+                        val.push_back(line[c]);
+                    }
+                }
+            }
+            ptr[i + 1] = idx.size();
+        }
+        return CSRMatrix<T>(rows, cols, std::move(ptr), std::move(idx), std::move(val));
+    }
+
+    SparseMatrix<T> toSparseMatrix() const { return toCSR().toSparseMatrix(); }
+
+    static constexpr size_t blockSize() { return B; }
+    size_t getRows() const { return rows; }
+    size_t getCols() const { return cols; }
+    size_t blockCount() const { return block_col.size(); }
+
+    // Число хранимых значений, включая нули внутри блоков
+    size_t storedEntries() const { return values.size(); }
+
+    size_t nonZeros() const
+    {
+        return values.size() - std::count(values.begin(), values.end(), T(0));
+    }
+
+    // Доля ненулевых элементов среди хранимых
+    double fillRatio() const { return values.empty() ? 1.0 : static_cast<double>(nonZeros()) / values.size(); }
+
+    const std::vector<size_t> &blockPtr() const { return block_ptr; }
+    const std::vector<size_t> &blockCol() const { return block_col; }
+    const std::vector<T> &getValues() const { return values; }
+
+    T get(size_t row, size_t col) const
+    {
+        if (row >= rows || col >= cols)
+            throw std::out_of_range("Index out of range");
+        size_t bi = row / B, bj = col / B;
+        auto first = block_col.begin() + block_ptr[bi];
+        auto last = block_col.begin() + block_ptr[bi + 1];
+        auto it = std::lower_bound(first, last, bj);
+        if (it != last && *it == bj)
+            return values[(it - block_col.begin()) * BB + (row % B) * B + col % B];
+        return 0;
+    }
+
+    // y = A x; при размерах, не кратных B, x и y дополняются нулями во временных буферах
+    void multiply(const std::vector<T> &x, std::vector<T> &y) const
+    {
+        if (cols != x.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        bool padded = rows % B != 0 || cols % B != 0;
+        std::vector<T> xPadded, yPadded;
+        const T *xs = x.data();
+        if (padded)
+        {
+            xPadded.assign(blockCols * B, T(0));
+            std::copy(x.begin(), x.end(), xPadded.begin());
+            xs = xPadded.data();
+            yPadded.assign(blockRows * B, T(0));
+        }
+        else
+            y.assign(rows, T(0));
+        T *ys = padded ? yPadded.data() : y.data();
+        for (size_t bi = 0; bi < blockRows; ++bi)
+        {
+            Accumulator<T> local[B] = {};
+            for (size_t k = block_ptr[bi]; k < block_ptr[bi + 1]; ++k)
+                bsr_detail::BlockMultiplyAdd<T, B>::apply(&values[k * BB], xs + block_col[k] * B, local);
+            std::copy(local, local + B, ys + bi * B);
+        }
+        if (padded)
+            y.assign(yPadded.begin(), yPadded.begin() + rows);
+    }
+
+    std::vector<T> operator*(const std::vector<T> &vec) const
+    {
+        std::vector<T> result;
+        multiply(vec, result);
+        return result;
+    }
+
+    // Транспонирование сортировкой подсчётом по блочным столбцам, блоки транспонируются целиком
+    BSRMatrix<T, B> transpose() const
+    {
+        std::vector<size_t> ptr(blockCols + 1, 0);
+        for (size_t bj : block_col)
+            ++ptr[bj + 1];
+        for (size_t j = 0; j < blockCols; ++j)
+            ptr[j + 1] += ptr[j];
+
+        std::vector<size_t> idx(block_col.size());
+        std::vector<T> val(values.size());
+        std::vector<size_t> next(ptr.begin(), ptr.end() - 1);
+        for (size_t bi = 0; bi < blockRows; ++bi)
+        {
+            for (size_t k = block_ptr[bi]; k < block_ptr[bi + 1]; ++k)
+            {
+                size_t dest = next[block_col[k]]++;
+                idx[dest] = bi;
+                bsr_detail::transposeBlock<T, B>(&values[k * BB], &val[dest * BB]);
+            }
+        }
+        return BSRMatrix<T, B>(cols, rows, std::move(ptr), std::move(idx), std::move(val));
+    }
+
+    // Умножение по Густавсону на уровне блоков: символическая фаза считает блоки
+    // каждой блочной строки, численная накапливает их в плотном буфере блочной строки
+    BSRMatrix<T, B> operator*(const BSRMatrix<T, B> &other) const
+    {
+        if (cols != other.rows)
+            throw std::invalid_argument("Matrix dimensions do not allow multiplication");
+        std::vector<size_t> ptr(blockRows + 1, 0);
+        std::vector<size_t> marker(other.blockCols, blockRows);
+        for (size_t bi = 0; bi < blockRows; ++bi)
+        {
+            size_t count = 0;
+            for (size_t k = block_ptr[bi]; k < block_ptr[bi + 1]; ++k)
+                for (size_t m = other.block_ptr[block_col[k]]; m < other.block_ptr[block_col[k] + 1]; ++m)
+                    if (marker[other.block_col[m]] != bi)
+                    {
+                        marker[other.block_col[m]] = bi;
+                        ++count;
+                    }
+            ptr[bi + 1] = ptr[bi] + count;
+        }
+
+        std::vector<size_t> idx(ptr[blockRows]);
+        std::vector<T> val(ptr[blockRows] * BB);
+        std::vector<T> accumulator(other.blockCols * BB, T(0));
+        std::fill(marker.begin(), marker.end(), blockRows);
+        for (size_t bi = 0; bi < blockRows; ++bi)
+        {
+            size_t next = ptr[bi];
+            for (size_t k = block_ptr[bi]; k < block_ptr[bi + 1]; ++k)
+            {
+                size_t mid = block_col[k];
+                for (size_t m = other.block_ptr[mid]; m < other.block_ptr[mid + 1]; ++m)
+                {
+                    size_t bj = other.block_col[m];
+                    if (marker[bj] != bi)
+                    {
+                        marker[bj] = bi;
+                        idx[next++] = bj;
+                    }
+                    bsr_detail::multiplyBlocks<T, B>(&values[k * BB], &other.values[m * BB], &accumulator[bj * BB]);
+                }
+            }
+            std::sort(idx.begin() + ptr[bi], idx.begin() + ptr[bi + 1]);
+            for (size_t k = ptr[bi]; k < ptr[bi + 1]; ++k)
+            {
+                T *block = &accumulator[idx[k] * BB];
+                std::copy(block, block + BB, &val[k * BB]);
+                std::fill(block, block + BB, T(0));
+            }
+        }
+
+        BSRMatrix<T, B> result(rows, other.cols, std::move(ptr), std::move(idx), std::move(val));
+        result.dropZeroBlocks();
+        return result;
+    }
+
+    void print() const
+    {
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t j = 0; j < cols; ++j)
+                std::cout << get(i, j) << " ";
+            std::cout << "\n";
+        }
+    }
+};
+
+// Доля ненулевых элементов в блоках B x B при разбиении матрицы на блоки
+template <typename T>
+double blockFillRatio(const CSRMatrix<T> &matrix, size_t blockSize)
+{
+    if (blockSize == 0)
+        throw std::invalid_argument("Block size must be positive");
+    const std::vector<size_t> &ptr = matrix.rowPtr();
+    const std::vector<size_t> &idx = matrix.colIdx();
+    size_t blockRows = (matrix.getRows() + blockSize - 1) / blockSize;
+    size_t blockCols = (matrix.getCols() + blockSize - 1) / blockSize;
+    std::vector<size_t> marker(blockCols, blockRows);
+    size_t blocks = 0;
+    for (size_t bi = 0; bi < blockRows; ++bi)
+    {
+        size_t last = std::min(matrix.getRows(), (bi + 1) * blockSize);
+        for (size_t i = bi * blockSize; i < last; ++i)
+            for (size_t k = ptr[i]; k < ptr[i + 1]; ++k)
+                if (marker[idx[k] / blockSize] != bi)
+                {
+                    marker[idx[k] / blockSize] = bi;
+                    ++blocks;
+                }
+    }
+    return blocks ? static_cast<double>(matrix.nonZeros()) / (blocks * blockSize * blockSize) : 1.0;
+}
+
+// Наибольший из поддерживаемых размеров блока (8, 4, 3, 2), при котором заполненность
+// блоков не ниже minFill; 1, если блочная структура не найдена
+template <typename T>
+size_t detectBlockSize(const CSRMatrix<T> &matrix, double minFill = 0.8)
+{
+    for (size_t blockSize : {8, 4, 3, 2})
+        if (blockSize <= std::max(matrix.getRows(), matrix.getCols()) && blockFillRatio(matrix, blockSize) >= minFill)
+            return blockSize;
+    return 1;
+}
+
+// Преобразование в BSRMatrix с определённым автоматически размером блока и вызов f(bsr).
+// Размер блока — параметр шаблона, поэтому f должна принимать BSRMatrix<T, B> для любого B
+// (например, обобщённая лямбда [&](const auto &bsr) { ... }).
+template <typename T, typename F>
+decltype(auto) withDetectedBlockSize(const CSRMatrix<T> &matrix, F f, double minFill = 0.8)
+{
+    switch (detectBlockSize(matrix, minFill))
+    {
+    case 8:
+        return f(BSRMatrix<T, 8>(matrix));
+    case 4:
+        return f(BSRMatrix<T, 4>(matrix));
+    case 3:
+        return f(BSRMatrix<T, 3>(matrix));
+    case 2:
+        return f(BSRMatrix<T, 2>(matrix));
+    default:
+        return f(BSRMatrix<T, 1>(matrix));
+    }
+}
+
+template <typename T, typename F>
+decltype(auto) withDetectedBlockSize(const SparseMatrix<T> &matrix, F f, double minFill = 0.8)
+{
+    return withDetectedBlockSize(CSRMatrix<T>(matrix), f, minFill);
+}
+
+#endif // BSR_MATRIX_HPP
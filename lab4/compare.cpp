@@ -1,129 +1,1029 @@
 #include <iostream>
+#include <fstream>
 #include <vector>
-#include <unordered_map>
-#include <chrono>
 #include <cmath>
+#include <string>
+#include <random>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstdio>
+#include <type_traits>
+#include <unordered_map>
+#include <numeric>
+#include <algorithm>
+
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+#include "csr_matrix.hpp"
+#include "compressed_vector.hpp"
+#include "parallel_spmv.hpp"
+#include "transpose_view.hpp"
+#include "sell_matrix.hpp"
+#include "bsr_matrix.hpp"
+#include "memory_resource.hpp"
+#include "dynamic_matrix.hpp"
+#include "reordering.hpp"
+#include "streaming_matrix.hpp"
+#include "instrumentation.hpp"
+#include "task_graph.hpp"
+#include "fixed_matrix.hpp"
+#include "matrix_batch.hpp"
+#include "graph_algorithms.hpp"
+#include "benchmark.hpp"
+
+// Параметры запуска; все списки задаются через запятую в командной строке
+struct Config {
+    std::vector<size_t> sizes = {256, 1024, 4096};
+    std::vector<double> densities = {0.001, 0.01, 0.05};
+    std::vector<std::string> types = {"double", "float"};
+    std::vector<MatrixStructure> structures = {MatrixStructure::Random, MatrixStructure::Banded, MatrixStructure::PowerLaw,
+                                               MatrixStructure::Blocked};
+    size_t blockSize = 4;        // Размер блоков структуры blocked
+    size_t warmup = 2;
+    size_t repeats = 11;
+    double maxWork = 1e8;        // Операции с большей оценкой работы пропускаются
+    size_t spmvRows = 200000;    // Размер матрицы для сравнения ядер умножения на вектор
+    double spmvRowLength = 12;   // Среднее число ненулевых элементов в строке
+    size_t batchSize = 100000;   // Число матриц в пакетных операциях
+    size_t threads = defaultThreadCount();
+    unsigned long long seed = 42;
+    ReportFormat format = ReportFormat::Text;
+    std::string output;          // Пусто — стандартный вывод
+};
+
+void printUsage() {
+    std::cout << "Usage: compare [options]\n"
+                 "  --sizes N,N,...          vector length / matrix order (default 256,1024,4096)\n"
+                 "  --densities D,D,...      fraction of nonzeros (default 0.001,0.01,0.05)\n"
+                 "  --types double,float     element types\n"
+                 "  --structures random,banded,powerlaw,blocked\n"
+                 "  --block-size B           dense block size of the blocked structure (default 4)\n"
+                 "  --warmup N               untimed runs before measuring (default 2)\n"
+                 "  --repeats N              timed runs (default 11)\n"
+                 "  --max-work W             skip runs estimated above W operations (default 1e8)\n"
+                 "  --spmv-rows N            order of the SpMV kernel matrix, 0 to skip (default 200000)\n"
+                 "  --spmv-row-length L      average nonzeros per row of that matrix (default 12)\n"
+                 "  --batch-size N           matrices per batch in small-matrix batches, 0 to skip (default 100000)\n"
+                 "  --threads N              threads for parallel kernels\n"
+                 "  --seed S                 random seed\n"
+                 "  --format text|csv|json   report format (default text)\n"
+                 "  --output FILE            write the report to FILE\n";
+}
+
+Config parseArguments(int argc, char* argv[]) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--help") {
+            printUsage();
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + option);
+        }
+        std::string value = argv[++i];
+        if (option == "--sizes") {
+            config.sizes = parseList<size_t>(value);
+        } else if (option == "--densities") {
+            config.densities = parseList<double>(value);
+        } else if (option == "--types") {
+            config.types = parseList<std::string>(value);
+        } else if (option == "--structures") {
+            config.structures.clear();
+            for (const std::string& name : parseList<std::string>(value)) {
+                config.structures.push_back(parseStructure(name));
+            }
+        } else if (option == "--block-size") {
+            config.blockSize = std::stoul(value);
+        } else if (option == "--warmup") {
+            config.warmup = std::stoul(value);
+        } else if (option == "--repeats") {
+            config.repeats = std::stoul(value);
+        } else if (option == "--max-work") {
+            config.maxWork = std::stod(value);
+        } else if (option == "--spmv-rows") {
+            config.spmvRows = std::stoul(value);
+        } else if (option == "--spmv-row-length") {
+            config.spmvRowLength = std::stod(value);
+        } else if (option == "--batch-size") {
+            config.batchSize = std::stoul(value);
+        } else if (option == "--threads") {
+            config.threads = std::stoul(value);
+        } else if (option == "--seed") {
+            config.seed = std::stoull(value);
+        } else if (option == "--format") {
+            config.format = parseReportFormat(value);
+        } else if (option == "--output") {
+            config.output = value;
+        } else {
+            throw std::invalid_argument("Unknown option: " + option);
+        }
+    }
+    for (const std::string& type : config.types) {
+        if (type != "double" && type != "float") {
+            throw std::invalid_argument("Unsupported element type: " + type);
+        }
+    }
+    if (config.repeats == 0) {
+        throw std::invalid_argument("At least one timed run is required");
+    }
+    return config;
+}
+
+// Результаты записываются сюда, чтобы компилятор не выбросил вычисления
+volatile double sink = 0;
+
+// Запуск одной операции и запись результата; work — оценка числа операций для отсечения,
+// items — число обработанных объектов за запуск (для столбца items/s)
+class Recorder {
+private:
+    const Config& config;
+    std::vector<BenchmarkRecord>& records;
+    BenchmarkRecord base;
+
+public:
+    Recorder(const Config& config, std::vector<BenchmarkRecord>& records, BenchmarkRecord base)
+        : config(config), records(records), base(base) {}
 
-const int SIZE = 4; // Размер векторов и матриц
-const int SPARSE_THRESHOLD = 10; // Порог для разреженности
+    template <typename F>
+    void run(const std::string& operation, const std::string& implementation, double work, double flops, F f,
+             double bytes = 0, double items = 0) {
+        if (work > config.maxWork) {
+            return;
+        }
+        BenchmarkRecord record = base;
+        record.operation = operation;
+        record.implementation = implementation;
+        record.flops = flops;
+        record.bytes = bytes;
+        record.items = items;
+        record.stats = measure(f, config.warmup, config.repeats);
+        records.push_back(record);
+    }
+};
 
-// Функция для заполнения вектора случайными значениями
-void fillVector(std::vector<double>& vec) {
-    for (int i = 0; i < SIZE; ++i) {
-        vec[i] = (rand() % 100 < SPARSE_THRESHOLD) ? 0 : static_cast<double>(rand() % 100);
+// Плотные эталонные реализации: векторы — std::vector, матрицы — построчно в одном массиве n * n
+template <typename T>
+std::vector<T> denseMatrix(const CSRMatrix<T>& matrix) {
+    size_t n = matrix.getCols();
+    std::vector<T> dense(matrix.getRows() * n, T(0));
+    for (size_t i = 0; i < matrix.getRows(); ++i) {
+        for (size_t k = matrix.rowPtr()[i]; k < matrix.rowPtr()[i + 1]; ++k) {
+            dense[i * n + matrix.colIdx()[k]] = matrix.getValues()[k];
+        }
     }
+    return dense;
 }
 
-// Функция для заполнения разреженного вектора
-void fillSparseVector(std::unordered_map<int, double>& sparseVec) {
-    for (int i = 0; i < SIZE; ++i) {
-        double value = (rand() % 100 < SPARSE_THRESHOLD) ? 0 : static_cast<double>(rand() % 100);
-        if (value != 0) {
-            sparseVec[i] = value;
+template <typename T>
+void denseMultiply(const std::vector<T>& a, const std::vector<T>& b, std::vector<T>& c, size_t n) {
+    std::fill(c.begin(), c.end(), T(0));
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = 0; k < n; ++k) {
+            T aik = a[i * n + k];
+            for (size_t j = 0; j < n; ++j) {
+                c[i * n + j] += aik * b[k * n + j];
+            }
         }
     }
 }
 
-// Функция для сложения векторов
-void vectorAddition(const std::vector<double>& vec1, const std::vector<double>& vec2, std::vector<double>& result) {
-    for (int i = 0; i < SIZE; ++i) {
-        result[i] = vec1[i] + vec2[i];
+// Число умножений в произведении разреженных матриц
+template <typename T>
+double spgemmFlops(const CSRMatrix<T>& a, const CSRMatrix<T>& b) {
+    const std::vector<size_t>& aCol = a.colIdx();
+    const std::vector<size_t>& bPtr = b.rowPtr();
+    double products = 0;
+    for (size_t k = 0; k < aCol.size(); ++k) {
+        products += bPtr[aCol[k] + 1] - bPtr[aCol[k]];
     }
+    return 2 * products;
 }
 
-void sparseVectorAddition(const std::unordered_map<int, double>& sparseVec1, const std::unordered_map<int, double>& sparseVec2, std::unordered_map<int, double>& result) {
-    // Сложение элементов из первого разреженного вектора
-    for (const auto& [index, value] : sparseVec1) {
-        result[index] = value; // Сначала добавляем значение из первого вектора
+template <typename T>
+void benchmarkVectors(const Config& config, size_t n, double density, const std::string& typeName,
+                      std::mt19937_64& rng, std::vector<BenchmarkRecord>& records) {
+    CompressedVector<T> compressed1 = generateVector<T>(n, density, rng);
+    CompressedVector<T> compressed2 = generateVector<T>(n, density, rng);
+    SparseVector<T> hash1 = compressed1.toSparseVector(), hash2 = compressed2.toSparseVector();
+    std::vector<T> dense1 = compressed1.toDense(), dense2 = compressed2.toDense(), denseResult(n);
+    size_t nonZeros = compressed1.nonZeros() + compressed2.nonZeros();
+    T scalar = T(1.5);
+
+    BenchmarkRecord base;
+    base.type = typeName;
+    base.structure = "random";
+    base.size = n;
+    base.density = density;
+    base.nonZeros = nonZeros;
+    Recorder recorder(config, records, base);
+
+    recorder.run("vec_add", "dense", n, n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            denseResult[i] = dense1[i] + dense2[i];
+        }
+        sink = denseResult[0];
+    });
+    recorder.run("vec_add", "hash", nonZeros, nonZeros, [&] {
+        SparseVector<T> result = hash1 + hash2;
+        sink = result.nonZeros();
+    });
+    recorder.run("vec_add", "compressed", nonZeros, nonZeros, [&] {
+        CompressedVector<T> result = compressed1 + compressed2;
+        sink = result.nonZeros();
+    });
+    // y += a * x: выражение строит новый вектор, axpy меняет накопитель на месте.
+    // Знак чередуется, чтобы значения накопителя не росли между повторами
+    recorder.run("vec_axpy", "hash-expression", nonZeros, 2.0 * nonZeros, [&] {
+        SparseVector<T> result = hash1 + hash2 * scalar;
+        sink = result.nonZeros();
+    });
+    SparseVector<T> accumulator = hash1;
+    T sign = scalar;
+    recorder.run("vec_axpy", "hash-inplace", nonZeros, 2.0 * nonZeros, [&] {
+        accumulator.axpy(sign, hash2);
+        sign = -sign;
+        sink = accumulator.nonZeros();
+    });
+
+    recorder.run("vec_subtract", "dense", n, n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            denseResult[i] = dense1[i] - dense2[i];
+        }
+        sink = denseResult[0];
+    });
+    recorder.run("vec_subtract", "hash", nonZeros, nonZeros, [&] {
+        SparseVector<T> result = hash1 - hash2;
+        sink = result.nonZeros();
+    });
+    recorder.run("vec_subtract", "compressed", nonZeros, nonZeros, [&] {
+        CompressedVector<T> result = compressed1 - compressed2;
+        sink = result.nonZeros();
+    });
+
+    recorder.run("vec_scale", "dense", n, n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            denseResult[i] = dense1[i] * scalar;
+        }
+        sink = denseResult[0];
+    });
+    recorder.run("vec_scale", "hash", nonZeros, nonZeros, [&] {
+        SparseVector<T> result = hash1 * scalar;
+        sink = result.nonZeros();
+    });
+    recorder.run("vec_scale", "hash-elementwise", nonZeros, nonZeros, [&] {
+        SparseVector<T> result = hash1.elementWiseMultiply(scalar);
+        sink = result.nonZeros();
+    });
+    recorder.run("vec_scale", "compressed", nonZeros, nonZeros, [&] {
+        CompressedVector<T> result = compressed1 * scalar;
+        sink = result.nonZeros();
+    });
+
+    recorder.run("vec_power", "dense", n, n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            denseResult[i] = std::pow(dense1[i], T(2));
+        }
+        sink = denseResult[0];
+    });
+    recorder.run("vec_power", "hash", nonZeros, nonZeros, [&] {
+        SparseVector<T> result = hash1.power(T(2));
+        sink = result.nonZeros();
+    });
+
+    recorder.run("vec_dot", "dense", n, 2.0 * n, [&] {
+        T sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += dense1[i] * dense2[i];
+        }
+        sink = sum;
+    });
+    recorder.run("vec_dot", "hash", nonZeros, nonZeros, [&] { sink = hash1.dot(hash2); });
+    recorder.run("vec_dot", "compressed", nonZeros, nonZeros, [&] { sink = compressed1.dot(compressed2); });
+    recorder.run("vec_dot", "compressed-dense", compressed1.nonZeros(), 2.0 * compressed1.nonZeros(),
+                 [&] { sink = compressed1.dot(dense2); });
+
+    // Произвольный доступ к хеш-таблице вектора: вставка, чтение и удаление по случайным позициям
+    std::vector<size_t> positions(std::max<size_t>(nonZeros, 1));
+    for (size_t& position : positions) {
+        position = rng() % n;
     }
-    
-    // Сложение элементов из второго разреженного вектора
-    for (const auto& [index, value] : sparseVec2) {
-        result[index] += value; // Если индекс уже есть, добавляем значение, если нет - создаем новый элемент
+    SparseVector<T> table(n);
+    table.setStorageFormat(StorageFormat::Hash);
+    std::unordered_map<size_t, T> baseline;
+    for (size_t position : positions) {
+        table.set(position, T(1));
+        baseline[position] = T(1);
     }
+    double accesses = static_cast<double>(positions.size());
+    recorder.run("vec_set", "hash", accesses, 0, [&] {
+        SparseVector<T> result(n);
+        result.setStorageFormat(StorageFormat::Hash);
+        for (size_t position : positions) {
+            result.set(position, T(1));
+        }
+        for (size_t position : positions) {
+            result.set(position, T(0));
+        }
+        sink = result.nonZeros();
+    });
+    recorder.run("vec_set", "unordered_map", accesses, 0, [&] {
+        std::unordered_map<size_t, T> result;
+        for (size_t position : positions) {
+            result[position] = T(1);
+        }
+        for (size_t position : positions) {
+            result.erase(position);
+        }
+        sink = result.size();
+    });
+    recorder.run("vec_get", "hash", accesses, 0, [&] {
+        T sum = 0;
+        for (size_t position : positions) {
+            sum += table.get(position ^ 1);
+        }
+        sink = sum;
+    });
+    recorder.run("vec_get", "unordered_map", accesses, 0, [&] {
+        T sum = 0;
+        for (size_t position : positions) {
+            auto it = baseline.find(position ^ 1);
+            sum += it != baseline.end() ? it->second : T(0);
+        }
+        sink = sum;
+    });
 }
 
+template <typename T>
+void benchmarkMatrices(const Config& config, size_t n, double density, MatrixStructure structure,
+                       const std::string& typeName, std::mt19937_64& rng, std::vector<BenchmarkRecord>& records) {
+    CSRMatrix<T> csr1 = generateMatrix<T>(n, density, structure, rng, config.blockSize);
+    CSRMatrix<T> csr2 = generateMatrix<T>(n, density, structure, rng, config.blockSize);
+    CSCMatrix<T> csc1(csr1), csc2(csr2);
+    SparseMatrix<T> hash1 = csr1.toSparseMatrix(), hash2 = csr2.toSparseMatrix();
+    double dn = static_cast<double>(n);
+    double nnz = static_cast<double>(csr1.nonZeros());
+    double nnzBoth = nnz + csr2.nonZeros();
+    double dense2Work = dn * dn;
+    double dense3Work = 2 * dn * dn * dn;
+    T scalar = T(1.5);
+
+    // Плотные матрицы строятся только если на них хватит бюджета
+    std::vector<T> dense1, dense2, denseResult;
+    if (dense2Work <= config.maxWork) {
+        dense1 = denseMatrix(csr1);
+        dense2 = denseMatrix(csr2);
+        denseResult.resize(n * n);
+    }
+    std::vector<T> x(n), y(n, T(0));
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = randomValue<T>(rng);
+    }
+    SparseVector<T> sparseX = generateVector<T>(n, std::max(density, 0.01), rng).toSparseVector();
+    ParallelSpMV<T> parallel(csr1, config.threads);
+
+    BenchmarkRecord base;
+    base.type = typeName;
+    base.structure = structureName(structure);
+    base.size = n;
+    base.density = density;
+    base.nonZeros = csr1.nonZeros();
+    Recorder recorder(config, records, base);
 
+    recorder.run("mat_add", "dense", dense2Work, dense2Work, [&] {
+        for (size_t k = 0; k < n * n; ++k) {
+            denseResult[k] = dense1[k] + dense2[k];
+        }
+        sink = denseResult[0];
+    });
+    recorder.run("mat_add", "hash", nnzBoth, nnzBoth, [&] {
+        SparseMatrix<T> result = hash1 + hash2;
+        sink = result.nonZeros();
+    });
+    SparseMatrix<T> accumulator = hash1;
+    T sign = T(1);
+    recorder.run("mat_add", "hash-inplace", nnzBoth, nnzBoth, [&] {
+        accumulator.axpy(sign, hash2);
+        sign = -sign;
+        sink = accumulator.nonZeros();
+    });
+    recorder.run("mat_add", "csr", nnzBoth, nnzBoth, [&] { sink = (csr1 + csr2).nonZeros(); });
+    recorder.run("mat_add", "csc", nnzBoth, nnzBoth, [&] { sink = (csc1 + csc2).nonZeros(); });
+
+    recorder.run("mat_subtract", "dense", dense2Work, dense2Work, [&] {
+        for (size_t k = 0; k < n * n; ++k) {
+            denseResult[k] = dense1[k] - dense2[k];
+        }
+        sink = denseResult[0];
+    });
+    recorder.run("mat_subtract", "hash", nnzBoth, nnzBoth, [&] {
+        SparseMatrix<T> result = hash1 - hash2;
+        sink = result.nonZeros();
+    });
 
+    recorder.run("mat_scale", "dense", dense2Work, dense2Work, [&] {
+        for (size_t k = 0; k < n * n; ++k) {
+            denseResult[k] = dense1[k] * scalar;
+        }
+        sink = denseResult[0];
+    });
+    recorder.run("mat_scale", "hash", nnz, nnz, [&] {
+        SparseMatrix<T> result = hash1 * scalar;
+        sink = result.nonZeros();
+    });
+    recorder.run("mat_scale", "csr", nnz, nnz, [&] { sink = (csr1 * scalar).nonZeros(); });
+    recorder.run("mat_scale", "csc", nnz, nnz, [&] { sink = (csc1 * scalar).nonZeros(); });
 
+    recorder.run("transpose", "dense", dense2Work, 0, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                denseResult[j * n + i] = dense1[i * n + j];
+            }
+        }
+        sink = denseResult[0];
+    });
+    recorder.run("transpose", "hash", nnz, 0, [&] { sink = hash1.transpose().nonZeros(); });
+    recorder.run("transpose", "hash-insert", nnz, 0, [&] {
+        SparseMatrix<T> result(n, n);
+        hash1.forEach([&](size_t row, size_t col, T value) { result.set(col, row, value); });
+        sink = result.nonZeros();
+    });
+    recorder.run("transpose", "csr", nnz, 0, [&] { sink = csr1.transpose().nonZeros(); });
+    recorder.run("transpose", "csr-parallel", nnz, 0, [&] {
+        sink = transposeParallel(csr1, config.threads).nonZeros();
+    });
+    recorder.run("csr_to_csc", "csr-parallel", nnz, 0, [&] {
+        sink = toCSCParallel(csr1, config.threads).nonZeros();
+    });
 
-// Функция для умножения матриц
-void matrixMultiplication(const std::vector<std::vector<double>>& mat1, const std::vector<std::vector<double>>& mat2, std::vector<std::vector<double>>& result) {
-    for (int i = 0; i < SIZE; ++i) {
-        for (int j = 0; j < SIZE; ++j) {
-            result[i][j] = 0;
-            for (int k = 0; k < SIZE; ++k) {
-                result[i][j] += mat1[i][k] * mat2[k][j];
+    // Объём данных CSR за одно умножение: значения, индексы столбцов, row_ptr, x и y
+    double spmvBytes = nnz * (sizeof(T) + sizeof(size_t)) + (dn + 1) * sizeof(size_t) + 2 * dn * sizeof(T);
+    recorder.run("matvec", "dense", dense2Work, 2 * dense2Work, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            T sum = 0;
+            for (size_t j = 0; j < n; ++j) {
+                sum += dense1[i * n + j] * x[j];
             }
+            y[i] = sum;
         }
+        sink = y[0];
+    }, dn * dn * sizeof(T) + 2 * dn * sizeof(T));
+    recorder.run("matvec", "hash", nnz, 2 * nnz, [&] {
+        y = hash1 * x;
+        sink = y[0];
+    });
+    recorder.run("matvec", "csr", nnz, 2 * nnz, [&] {
+        y = csr1 * x;
+        sink = y[0];
+    }, spmvBytes);
+    recorder.run("matvec", "csc", nnz, 2 * nnz, [&] {
+        y = csc1 * x;
+        sink = y[0];
+    }, spmvBytes);
+    recorder.run("matvec", "csr-parallel", nnz, 2 * nnz, [&] {
+        parallel.multiply(x, y);
+        sink = y[0];
+    }, spmvBytes);
+    // 32-битные индексы; для float — векторы в double с накоплением в double
+    SparseMatrix<T, uint32_t> narrow(hash1);
+    recorder.run("matvec", "hash-u32", nnz, 2 * nnz, [&] {
+        y = narrow * x;
+        sink = y[0];
+    });
+    if constexpr (std::is_same_v<T, float>) {
+        std::vector<double> wideX(x.begin(), x.end());
+        recorder.run("matvec", "hash-u32-mixed", nnz, 2 * nnz, [&] { sink = narrow.multiply(wideX)[0]; });
+        recorder.run("matvec", "csr-mixed", nnz, 2 * nnz, [&] { sink = csr1.multiply(wideX)[0]; });
+    }
+
+    recorder.run("matvec_sparse", "hash", nnz, 2 * nnz, [&] { sink = (hash1 * sparseX).nonZeros(); });
+    recorder.run("matvec_sparse", "csr", nnz, 2 * nnz, [&] { sink = (csr1 * sparseX).nonZeros(); });
+
+    // A^T * x: через вид без копирования и через построенную транспонированную матрицу
+    recorder.run("matvec_transpose", "hash-materialize", nnz, 2 * nnz, [&] {
+        y = hash1.transpose() * x;
+        sink = y[0];
+    });
+    recorder.run("matvec_transpose", "hash-view", nnz, 2 * nnz, [&] {
+        y = transposed(hash1) * x;
+        sink = y[0];
+    });
+    recorder.run("matvec_transpose", "csr-view", nnz, 2 * nnz, [&] {
+        y = transposed(csr1) * x;
+        sink = y[0];
+    }, spmvBytes);
+    recorder.run("matvec_transpose", "csr-parallel-view", nnz, 2 * nnz, [&] {
+        y = transposed(csr1, config.threads) * x;
+        sink = y[0];
+    }, spmvBytes);
+    recorder.run("matvec_transpose", "csc-view", nnz, 2 * nnz, [&] {
+        y = transposed(csc1) * x;
+        sink = y[0];
+    }, spmvBytes);
+
+    double spgemm = spgemmFlops(csr1, csr2);
+    recorder.run("matmul", "dense", dense3Work, dense3Work, [&] {
+        denseMultiply(dense1, dense2, denseResult, n);
+        sink = denseResult[0];
+    });
+    recorder.run("matmul", "hash", spgemm, spgemm, [&] { sink = (hash1 * hash2).nonZeros(); });
+    recorder.run("matmul", "csr", spgemm, spgemm, [&] { sink = (csr1 * csr2).nonZeros(); });
+    recorder.run("matmul", "csc", spgemm, spgemm, [&] { sink = (csc1 * csc2).nonZeros(); });
+
+    // Блочный формат с найденным автоматически размером блока (1, если блочной структуры нет)
+    withDetectedBlockSize(csr1, [&](const auto& bsr1) {
+        using Blocked = std::decay_t<decltype(bsr1)>;
+        Blocked bsr2(csr2);
+        std::string name = "bsr-" + std::to_string(Blocked::blockSize());
+        double bsrBytes = bsr1.storedEntries() * sizeof(T) + bsr1.blockCount() * sizeof(size_t) + 2 * dn * sizeof(T);
+        recorder.run("transpose", name, nnz, 0, [&] { sink = bsr1.transpose().blockCount(); });
+        recorder.run("matvec", name, nnz, 2 * nnz, [&] {
+            bsr1.multiply(x, y);
+            sink = y[0];
+        }, bsrBytes);
+        recorder.run("matmul", name, spgemm, spgemm, [&] { sink = (bsr1 * bsr2).blockCount(); });
+    });
+
+    // A^3: два умножения; вторая оценка учитывает заполнение A^2
+    if (spgemm <= config.maxWork) {
+        CSRMatrix<T> square = csr1 * csr1;
+        double cube = spgemmFlops(csr1, csr1) + spgemmFlops(square, csr1);
+        std::vector<T> denseSquare(dense1.size());
+        recorder.run("power3", "dense", 2 * dense3Work, 2 * dense3Work, [&] {
+            denseMultiply(dense1, dense1, denseSquare, n);
+            denseMultiply(denseSquare, dense1, denseResult, n);
+            sink = denseResult[0];
+        });
+        recorder.run("power3", "hash", cube, cube, [&] { sink = hash1.power(3).nonZeros(); });
+        // Те же вычисления с промежуточными результатами в пуле потока и в арене
+        // (в арену матрица копируется при каждом запуске, арена освобождается целиком)
+        SparseMatrix<T> pooled(hash1, threadPoolResource());
+        recorder.run("power3", "hash-pool", cube, cube, [&] { sink = pooled.power(3).nonZeros(); });
+        recorder.run("power3", "hash-arena", cube, cube, [&] {
+            ArenaResource arena;
+            SparseMatrix<T> local(hash1, &arena);
+            sink = local.power(3).nonZeros();
+        });
+        recorder.run("power3", "csr", cube, cube, [&] { sink = csr1.power(3).nonZeros(); });
+    }
+
+    // Цепочка C = A^T + B, D = B^T * A, y = C x + D x: последовательно и графом задач,
+    // где ветви C и D выполняются параллельно, а произведения делятся на подзадачи
+    if (spgemm <= config.maxWork) {
+        double pipeline = 3 * nnzBoth + spgemm;
+        WorkStealingPool pool(config.threads > 1 ? config.threads - 1 : 0);
+        recorder.run("pipeline", "hash", pipeline, pipeline, [&] {
+            SparseMatrix<T> c = hash1.transpose() + hash2;
+            SparseMatrix<T> d = hash2.transpose() * hash1;
+            std::vector<T> cx = c * x, dx = d * x;
+            sink = cx[0] + dx[0];
+        });
+        recorder.run("pipeline", "hash-graph", pipeline, pipeline, [&] {
+            TaskGraph graph(std::max<size_t>(1024, csr1.nonZeros() / (4 * std::max<size_t>(config.threads, 1))));
+            auto a = graph.input(hash1), b = graph.input(hash2);
+            auto vx = graph.input(x);
+            auto c = graph.add(graph.transpose(a), b);
+            auto d = graph.multiply(graph.transpose(b), a);
+            auto cx = graph.multiply(c, vx), dx = graph.multiply(d, vx);
+            graph.run(pool);
+            sink = cx.get()[0] + dx.get()[0];
+        });
+    }
+
+    // Обходы графа со смежностью csr1 из вершины 0: повторные полные произведения A^T x
+    // против шагов по фронту с маской (graph_algorithms.hpp). Работа полных вариантов —
+    // число уровней (раундов) на nnz + n
+    {
+        std::vector<size_t> levels = breadthFirstSearch(csr1, 0, config.threads);
+        size_t depth = 0;
+        for (size_t level : levels) {
+            if (level != unreachableLevel) {
+                depth = std::max(depth, level);
+            }
+        }
+        // A^T строится один раз для всех запусков в обоих вариантах
+        SparseMatrix<T> incoming = hash1.transpose();
+        CSRMatrix<T> incomingCsr = transposeParallel(csr1, config.threads);
+        recorder.run("bfs", "hash-matvec", (depth + 1) * (nnz + dn), 0, [&] {
+            std::vector<T> frontier(n, T(0));
+            std::vector<size_t> result(n, unreachableLevel);
+            frontier[0] = T(1);
+            result[0] = 0;
+            for (size_t level = 1, found = 1; found > 0; ++level) {
+                std::vector<T> reached = incoming * frontier;
+                found = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    frontier[i] = T(0);
+                    if (reached[i] != T(0) && result[i] == unreachableLevel) {
+                        result[i] = level;
+                        frontier[i] = T(1);
+                        ++found;
+                    }
+                }
+            }
+            sink = static_cast<T>(result[n - 1]);
+        });
+        recorder.run("bfs", "masked", nnz + dn, 0, [&] {
+            sink = static_cast<T>(breadthFirstSearch(csr1, &incomingCsr, 0, config.threads)[n - 1]);
+        });
+
+        // Полный Беллман-Форд: каждый раунд — min-plus произведение по всем рёбрам; число
+        // раундов оценивается глубиной BFS
+        recorder.run("sssp", "csr-matvec", (depth + 1) * (nnz + dn), 0, [&] {
+            std::vector<T> distances(n, MinPlus<T>::zero()), next;
+            distances[0] = T(0);
+            const std::vector<size_t>& ptr = csr1.rowPtr();
+            const std::vector<size_t>& idx = csr1.colIdx();
+            const std::vector<T>& val = csr1.getValues();
+            for (bool changed = true; changed; distances.swap(next)) {
+                next = distances;
+                changed = false;
+                for (size_t u = 0; u < n; ++u) {
+                    for (size_t k = ptr[u]; k < ptr[u + 1]; ++k) {
+                        T distance = MinPlus<T>::multiply(distances[u], val[k]);
+                        if (distance < next[idx[k]]) {
+                            next[idx[k]] = distance;
+                            changed = true;
+                        }
+                    }
+                }
+            }
+            sink = distances[n - 1];
+        });
+        recorder.run("sssp", "masked", nnz + dn, 0, [&] { sink = shortestPaths(csr1, 0)[n - 1]; });
+
+        // 20 итераций без останова по точности: одинаковая работа в обоих вариантах
+        const size_t iterations = 20;
+        recorder.run("pagerank", "hash-matvec", iterations * (nnz + dn), iterations * 2 * nnz, [&] {
+            std::vector<T> outWeight(n, T(0));
+            hash1.forEach([&](size_t row, size_t, T value) { outWeight[row] += value; });
+            std::vector<T> rank(n, T(1) / T(n)), share(n);
+            for (size_t iteration = 0; iteration < iterations; ++iteration) {
+                T dangling = 0;
+                for (size_t u = 0; u < n; ++u) {
+                    share[u] = outWeight[u] > 0 ? rank[u] / outWeight[u] : T(0);
+                    dangling += outWeight[u] > 0 ? T(0) : rank[u];
+                }
+                std::vector<T> spread = incoming * share;
+                for (size_t v = 0; v < n; ++v) {
+                    rank[v] = (T(0.15) + T(0.85) * dangling) / T(n) + T(0.85) * spread[v];
+                }
+            }
+            sink = rank[0];
+        });
+        recorder.run("pagerank", "semiring", iterations * (nnz + dn), iterations * 2 * nnz, [&] {
+            sink = static_cast<T>(pageRank(csr1, &incomingCsr, 0.85, 0.0, iterations, config.threads)[0]);
+        });
     }
 }
 
-// Функция для умножения разреженных матриц
-void sparseMatrixMultiplication(const std::unordered_map<int, std::unordered_map<int, double>>& sparseMat1, const std::unordered_map<int, std::unordered_map<int, double>>& sparseMat2, std::unordered_map<int, std::unordered_map<int, double>>& result) {
-    for (const auto& [row, cols] : sparseMat1) {
-        for (const auto& [col, value] : cols) {
-            for (const auto& [k, val] : sparseMat2.at(col)) {
-                result[row][k] += value * val;
+// Малые плотные матрицы N x N: обращение и умножение в хеш-таблицах (обращение — только 2x2),
+// в FixedMatrix с развёрнутыми при компиляции циклами и в обычных массивах
+template <typename T, size_t N>
+void benchmarkSmallMatrices(const Config& config, const std::string& typeName, std::mt19937_64& rng,
+                            std::vector<BenchmarkRecord>& records) {
+    // Диагональное преобладание гарантирует обратимость
+    T dense[N * N], other[N * N], result[N * N];
+    SparseMatrix<T> hash(N, N), hashOther(N, N);
+    FixedMatrix<T, N, N> fixed, fixedOther;
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            dense[i * N + j] = randomValue<T>(rng) + (i == j ? T(10 * N) : T(0));
+            other[i * N + j] = randomValue<T>(rng);
+            hash.set(i, j, dense[i * N + j]);
+            hashOther.set(i, j, other[i * N + j]);
+            fixed.set(i, j, dense[i * N + j]);
+            fixedOther.set(i, j, other[i * N + j]);
+        }
+    }
+
+    BenchmarkRecord base;
+    base.type = typeName;
+    base.structure = "dense";
+    base.size = N;
+    base.density = 1;
+    base.nonZeros = N * N;
+    Recorder recorder(config, records, base);
+
+    double cube = static_cast<double>(N * N * N);
+    recorder.run("inverse", "dense", N * N, cube, [&] {
+        // Гаусс — Жордан без выбора ведущего элемента
+        T work[N * N];
+        std::copy(dense, dense + N * N, work);
+        for (size_t k = 0; k < N * N; ++k) {
+            result[k] = k / N == k % N ? T(1) : T(0);
+        }
+        for (size_t k = 0; k < N; ++k) {
+            T pivot = work[k * N + k];
+            for (size_t j = 0; j < N; ++j) {
+                work[k * N + j] /= pivot;
+                result[k * N + j] /= pivot;
+            }
+            for (size_t i = 0; i < N; ++i) {
+                T factor = i == k ? T(0) : work[i * N + k];
+                for (size_t j = 0; j < N; ++j) {
+                    work[i * N + j] -= factor * work[k * N + j];
+                    result[i * N + j] -= factor * result[k * N + j];
+                }
             }
         }
+        sink = result[0];
+    });
+    if constexpr (N == 2) {
+        recorder.run("inverse", "hash", N * N, cube, [&] { sink = hash.inverse().get(0, 0); });
     }
+    recorder.run("inverse", "fixed", N * N, cube, [&] { sink = fixed.inverse().get(0, 0); });
+
+    recorder.run("small_matmul", "dense", cube, 2 * cube, [&] {
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = 0; j < N; ++j) {
+                T sum = 0;
+                for (size_t k = 0; k < N; ++k) {
+                    sum += dense[i * N + k] * other[k * N + j];
+                }
+                result[i * N + j] = sum;
+            }
+        }
+        sink = result[0];
+    });
+    recorder.run("small_matmul", "hash", cube, 2 * cube, [&] { sink = (hash * hashOther).get(0, 0); });
+    recorder.run("small_matmul", "fixed", cube, 2 * cube, [&] { sink = (fixed * fixedOther).get(0, 0); });
 }
 
-int main() {
-    // Инициализация генератора случайных чисел
-    srand(static_cast<unsigned int>(time(0)));
-
-    // Обычные векторы
-    std::vector<double> vec1(SIZE), vec2(SIZE), vecResult(SIZE);
-    fillVector(vec1);
-    fillVector(vec2);
-
-    // Разреженные векторы
-    std::unordered_map<int, double> sparseVec1, sparseVec2, sparseVecResult;
-    fillSparseVector(sparseVec1);
-    fillSparseVector(sparseVec2);
-
-    // Сравнение времени сложения векторов
-    auto start = std::chrono::high_resolution_clock::now();
-    vectorAddition(vec1, vec2, vecResult);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> vectorDuration = end - start;
-    std::cout << "Vector addition time: " << vectorDuration.count() << " seconds\n";
-
-    start = std::chrono::high_resolution_clock::now();
-    sparseVectorAddition(sparseVec1, sparseVec2, sparseVecResult);
-    end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> sparseVectorDuration = end - start;
-    std::cout << "Sparse vector addition time: " << sparseVectorDuration.count() << " seconds\n";
-
-    // Обычные матрицы
-    std::vector<std::vector<double>> mat1(SIZE, std::vector<double>(SIZE)), mat2(SIZE, std::vector<double>(SIZE)), matResult(SIZE, std::vector<double>(SIZE));
-    for (int i = 0; i < SIZE; ++i) {
-        fillVector(mat1[i]);
-        fillVector(mat2[i]);
-    }
-
-    // Разреженные матрицы
-    std::unordered_map<int, std::unordered_map<int, double>> sparseMat1, sparseMat2, sparseMatResult;
-    for (int i = 0; i < SIZE; ++i) {
-        fillSparseVector(sparseMat1[i]);
-        fillSparseVector(sparseMat2[i]);
-    }
-
-    // Сравнение времени умножения матриц
-    start = std::chrono::high_resolution_clock::now();
-    matrixMultiplication(mat1, mat2, matResult);
-    end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> matrixDuration = end - start;
-    std::cout << "Matrix multiplication time: " << matrixDuration.count() << " seconds\n";
-
-    start = std::chrono::high_resolution_clock::now();
-    sparseMatrixMultiplication(sparseMat1, sparseMat2, sparseMatResult);
-    end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> sparseMatrixDuration = end - start;
-    std::cout << "Sparse matrix multiplication time: " << sparseMatrixDuration.count() << " seconds\n";
+// Пакеты малых матриц N x N: по одной (хеш-таблицы, FixedMatrix) и пакетом в формате
+// структуры массивов в одном и в нескольких потоках; пропускная способность — в items/s (матриц в секунду)
+template <typename T, size_t N>
+void benchmarkBatches(const Config& config, const std::string& typeName, std::mt19937_64& rng,
+                      std::vector<BenchmarkRecord>& records) {
+    size_t count = config.batchSize;
+    // Хеш-таблицы медленнее на порядок, поэтому для них берётся часть пакета
+    size_t hashCount = std::min<size_t>(count, 10000);
+    MatrixBatch<T, N, N> a(count), b(count);
+    VectorBatch<T, N> x(count);
+    for (size_t m = 0; m < count; ++m) {
+        for (size_t i = 0; i < N; ++i) {
+            x.set(m, i, randomValue<T>(rng));
+            for (size_t j = 0; j < N; ++j) {
+                a.set(m, i, j, randomValue<T>(rng) + (i == j ? T(10 * N) : T(0)));
+                b.set(m, i, j, randomValue<T>(rng));
+            }
+        }
+    }
+    MatrixBatch<T, N, N> batchResult(count);
+    VectorBatch<T, N> batchY(count);
+    std::vector<FixedMatrix<T, N, N>> fixedA(count), fixedB(count), fixedResult(count);
+    std::vector<FixedVector<T, N>> fixedX(count), fixedY(count);
+    std::vector<SparseMatrix<T>> hashA, hashB;
+    std::vector<std::vector<T>> hashX;
+    for (size_t m = 0; m < count; ++m) {
+        fixedA[m] = a.matrix(m);
+        fixedB[m] = b.matrix(m);
+        fixedX[m] = x.vector(m);
+        if (m < hashCount) {
+            hashA.push_back(fixedA[m].toSparseMatrix());
+            hashB.push_back(fixedB[m].toSparseMatrix());
+            hashX.emplace_back(N);
+            for (size_t i = 0; i < N; ++i) {
+                hashX.back()[i] = x.get(m, i);
+            }
+        }
+    }
 
-    return 0;
+    BenchmarkRecord base;
+    base.type = typeName;
+    base.structure = "dense";
+    base.size = N;
+    base.density = 1;
+    base.nonZeros = N * N;
+    Recorder recorder(config, records, base);
+
+    double items = static_cast<double>(count), hashItems = static_cast<double>(hashCount);
+    double cube = static_cast<double>(N * N * N), square = static_cast<double>(N * N);
+    double matrixBytes = sizeof(T) * square;
+    recorder.run("batch_matmul", "hash-loop", hashItems * cube, 2 * hashItems * cube, [&] {
+        for (size_t m = 0; m < hashCount; ++m) {
+            sink = (hashA[m] * hashB[m]).get(0, 0);
+        }
+    }, 3 * hashItems * matrixBytes, hashItems);
+    recorder.run("batch_matmul", "fixed-loop", items * cube, 2 * items * cube, [&] {
+        for (size_t m = 0; m < count; ++m) {
+            fixedResult[m] = fixedA[m] * fixedB[m];
+        }
+        sink = fixedResult[0].get(0, 0);
+    }, 3 * items * matrixBytes, items);
+    recorder.run("batch_matmul", "batch", items * cube, 2 * items * cube, [&] {
+        multiply(a, b, batchResult, 1);
+        sink = batchResult.get(0, 0, 0);
+    }, 3 * items * matrixBytes, items);
+    recorder.run("batch_matmul", "batch-parallel", items * cube, 2 * items * cube, [&] {
+        multiply(a, b, batchResult, config.threads);
+        sink = batchResult.get(0, 0, 0);
+    }, 3 * items * matrixBytes, items);
+
+    double vectorBytes = matrixBytes + 2 * sizeof(T) * N;
+    recorder.run("batch_matvec", "hash-loop", hashItems * square, 2 * hashItems * square, [&] {
+        for (size_t m = 0; m < hashCount; ++m) {
+            sink = (hashA[m] * hashX[m])[0];
+        }
+    }, hashItems * vectorBytes, hashItems);
+    recorder.run("batch_matvec", "fixed-loop", items * square, 2 * items * square, [&] {
+        for (size_t m = 0; m < count; ++m) {
+            fixedY[m] = fixedA[m] * fixedX[m];
+        }
+        sink = fixedY[0].get(0);
+    }, items * vectorBytes, items);
+    recorder.run("batch_matvec", "batch", items * square, 2 * items * square, [&] {
+        a.multiply(x, batchY, 1);
+        sink = batchY.get(0, 0);
+    }, items * vectorBytes, items);
+    recorder.run("batch_matvec", "batch-parallel", items * square, 2 * items * square, [&] {
+        a.multiply(x, batchY, config.threads);
+        sink = batchY.get(0, 0);
+    }, items * vectorBytes, items);
+
+    if constexpr (N == 2) {
+        recorder.run("batch_inverse", "hash-loop", hashItems * cube, hashItems * cube, [&] {
+            for (size_t m = 0; m < hashCount; ++m) {
+                sink = hashA[m].inverse().get(0, 0);
+            }
+        }, 2 * hashItems * matrixBytes, hashItems);
+    }
+    recorder.run("batch_inverse", "fixed-loop", items * cube, items * cube, [&] {
+        for (size_t m = 0; m < count; ++m) {
+            fixedResult[m] = fixedA[m].inverse();
+        }
+        sink = fixedResult[0].get(0, 0);
+    }, 2 * items * matrixBytes, items);
+    recorder.run("batch_inverse", "batch", items * cube, items * cube, [&] {
+        a.inverse(batchResult, 1);
+        sink = batchResult.get(0, 0, 0);
+    }, 2 * items * matrixBytes, items);
+    recorder.run("batch_inverse", "batch-parallel", items * cube, items * cube, [&] {
+        a.inverse(batchResult, config.threads);
+        sink = batchResult.get(0, 0, 0);
+    }, 2 * items * matrixBytes, items);
 }
 
+// Сравнение ядер умножения матрицы на вектор на большой матрице: хеш-таблицы, CSR и SELL-C-σ
+template <typename T>
+void benchmarkSpmvKernels(const Config& config, MatrixStructure structure, const std::string& typeName,
+                          std::mt19937_64& rng, std::vector<BenchmarkRecord>& records) {
+    size_t n = config.spmvRows;
+    double density = config.spmvRowLength / n;
+    CSRMatrix<T> csr = generateMatrix<T>(n, density, structure, rng, config.blockSize);
+    SparseMatrix<T> hash = csr.toSparseMatrix();
+    SellMatrix<T> sell(csr);
+    ParallelSpMV<T> parallel(csr, config.threads);
+    std::vector<T> x(n, T(1)), y(n);
+    double nnz = static_cast<double>(csr.nonZeros());
+    double csrBytes = nnz * (sizeof(T) + sizeof(size_t)) + (n + 1.0) * sizeof(size_t) + 2.0 * n * sizeof(T);
+    double sellBytes = sell.storedEntries() * (sizeof(T) + sizeof(int32_t)) + 2.0 * n * sizeof(T);
+
+    BenchmarkRecord base;
+    base.type = typeName;
+    base.structure = structureName(structure);
+    base.size = n;
+    base.density = density;
+    base.nonZeros = csr.nonZeros();
+    // Бюджет работы здесь не применяется: размер задан явно
+    Config unlimited = config;
+    unlimited.maxWork = INFINITY;
+    Recorder recorder(unlimited, records, base);
+
+    recorder.run("spmv_kernel", "hash", nnz, 2 * nnz, [&] {
+        y = hash * x;
+        sink = y[0];
+    });
+    recorder.run("spmv_kernel", "csr", nnz, 2 * nnz, [&] {
+        y = csr * x;
+        sink = y[0];
+    }, csrBytes);
+    recorder.run("spmv_kernel", "csr-parallel", nnz, 2 * nnz, [&] {
+        parallel.multiply(x, y);
+        sink = y[0];
+    }, csrBytes);
+    // Случайная перенумерация разрушает локальность обращений к x,
+    // обратный порядок Катхилла — Макки восстанавливает её
+    std::vector<size_t> shuffle(n);
+    std::iota(shuffle.begin(), shuffle.end(), 0);
+    std::shuffle(shuffle.begin(), shuffle.end(), rng);
+    CSRMatrix<T> shuffled = permute(csr, shuffle);
+    CSRMatrix<T> reordered = permute(shuffled, reverseCuthillMcKee(shuffled));
+    recorder.run("spmv_kernel", "csr-shuffled", nnz, 2 * nnz, [&] {
+        y = shuffled * x;
+        sink = y[0];
+    }, csrBytes);
+    recorder.run("spmv_kernel", "csr-shuffled-rcm", nnz, 2 * nnz, [&] {
+        y = reordered * x;
+        sink = y[0];
+    }, csrBytes);
+    // Динамическая матрица с неслитыми изменениями: база CSR плюс разности из буфера
+    DynamicMatrix<T> dynamic(csr);
+    std::uniform_int_distribution<size_t> position(0, n - 1);
+    for (size_t k = 0; k < 1000; ++k) {
+        dynamic.set(position(rng), position(rng), randomValue<T>(rng));
+    }
+    recorder.run("spmv_kernel", "dynamic-" + std::to_string(dynamic.pendingUpdates()), nnz, 2 * nnz, [&] {
+        y = dynamic * x;
+        sink = y[0];
+    }, csrBytes);
+    // Потоковое умножение с диска: блоки по 4 МБ, буферы не больше 8 МБ.
+    // GB/s считается по прочитанным байтам файла (повторные чтения обычно идут из кеша ОС)
+    const std::string streamPath = "compare_streaming.tmp";
+    writeStreamingMatrix(streamPath, csr, size_t(4) << 20);
+    {
+        StreamingMatrix<T> streaming(streamPath, size_t(8) << 20);
+        std::vector<T> streamed;
+        streaming.multiply(x);
+        double streamBytes = static_cast<double>(streaming.lastStats().bytesRead);
+        recorder.run("spmv_stream", "stream", nnz, 2 * nnz, [&] {
+            streamed = streaming * x;
+            sink = streamed[0];
+        }, streamBytes);
+        recorder.run("spmv_stream", "stream-transpose", nnz, 2 * nnz, [&] {
+            streamed = streaming.multiplyTransposed(x);
+            sink = streamed[0];
+        }, streamBytes);
+    }
+    std::remove(streamPath.c_str());
+    withDetectedBlockSize(csr, [&](const auto& bsr) {
+        double bsrBytes = bsr.storedEntries() * sizeof(T) + bsr.blockCount() * sizeof(size_t) + 2.0 * n * sizeof(T);
+        recorder.run("spmv_kernel", "bsr-" + std::to_string(bsr.blockSize()), nnz, 2 * nnz, [&] {
+            bsr.multiply(x, y);
+            sink = y[0];
+        }, bsrBytes);
+    });
+    for (SellKernel kernel : {SellKernel::Scalar, SellKernel::AVX2, SellKernel::AVX512}) {
+        if (sell.supports(kernel) && static_cast<int>(kernel) <= static_cast<int>(detectSellKernel())) {
+            recorder.run("spmv_kernel", std::string("sell-") + std::to_string(sell.sliceHeight()) + "-" +
+                         sellKernelName(kernel), nnz, 2 * nnz, [&] {
+                sell.multiply(x, y, kernel);
+                sink = y[0];
+            }, sellBytes);
+        }
+    }
+}
+
+template <typename T>
+void runAll(const Config& config, const std::string& typeName, std::mt19937_64& rng,
+            std::vector<BenchmarkRecord>& records) {
+    for (size_t n : config.sizes) {
+        for (double density : config.densities) {
+            std::cerr << typeName << ", n = " << n << ", density = " << density << "\n";
+            benchmarkVectors<T>(config, n, density, typeName, rng, records);
+            for (MatrixStructure structure : config.structures) {
+                benchmarkMatrices<T>(config, n, density, structure, typeName, rng, records);
+            }
+        }
+    }
+    benchmarkSmallMatrices<T, 2>(config, typeName, rng, records);
+    benchmarkSmallMatrices<T, 3>(config, typeName, rng, records);
+    benchmarkSmallMatrices<T, 4>(config, typeName, rng, records);
+    if (config.batchSize > 0) {
+        std::cerr << typeName << ", small-matrix batches\n";
+        benchmarkBatches<T, 2>(config, typeName, rng, records);
+        benchmarkBatches<T, 3>(config, typeName, rng, records);
+        benchmarkBatches<T, 4>(config, typeName, rng, records);
+    }
+    if (config.spmvRows > 0) {
+        for (MatrixStructure structure : config.structures) {
+            std::cerr << typeName << ", SpMV kernels, " << structureName(structure) << "\n";
+            benchmarkSpmvKernels<T>(config, structure, typeName, rng, records);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Config config = parseArguments(argc, argv);
+        std::mt19937_64 rng(config.seed);
+        std::vector<BenchmarkRecord> records;
+        for (const std::string& type : config.types) {
+            if (type == "double") {
+                runAll<double>(config, type, rng, records);
+            } else {
+                runAll<float>(config, type, rng, records);
+            }
+        }
+
+        if (config.output.empty()) {
+            writeReport(std::cout, records, config.format);
+        } else {
+            std::ofstream out(config.output);
+            if (!out) {
+                throw std::runtime_error("Cannot open output file: " + config.output);
+            }
+            writeReport(out, records, config.format);
+        }
+        // Сборка с -DSPARSE_INSTRUMENTATION: счётчики операций за весь запуск
+        if (instrumentationEnabled) {
+            std::cerr << "Instrumentation counters: ";
+            instrumentationSnapshot().writeJson(std::cerr);
+            std::cerr << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
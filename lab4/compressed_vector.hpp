@@ -0,0 +1,282 @@
+#ifndef COMPRESSED_VECTOR_HPP
+#define COMPRESSED_VECTOR_HPP
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "sparse_vector.hpp"
+#include "numeric_types.hpp"
+
+// Разреженный вектор в сжатом формате: отсортированные массивы индексов и значений.
+// Сложение, вычитание и скалярное произведение выполняются одним проходом слияния.
+template <typename T>
+class CompressedVector
+{
+private:
+    size_t size;
+    std::vector<size_t> indices;
+    std::vector<T> values;
+
+    // Слияние двух векторов: op применяется к парам значений (нуль для отсутствующих)
+    template <typename Op>
+    CompressedVector<T> merge(const CompressedVector<T> &other, Op op) const
+    {
+        if (size != other.size)
+            throw std::invalid_argument("Vector sizes do not match");
+        CompressedVector<T> result(size);
+        result.indices.reserve(indices.size() + other.indices.size());
+        result.values.reserve(indices.size() + other.indices.size());
+        auto push = [&](size_t index, T value)
+        {
+            if (value != 0)
+            {
+                result.indices.push_back(index);
+                result.values.push_back(value);
+            }
+        };
+        size_t a = 0, b = 0;
+        while (a < indices.size() && b < other.indices.size())
+        {
+            if (indices[a] < other.indices[b])
+            {
+                push(indices[a], op(values[a], T(0)));
+                ++a;
+            }
+            else if (other.indices[b] < indices[a])
+            {
+                push(other.indices[b], op(T(0), other.values[b]));
+                ++b;
+            }
+            else
+            {
+                push(indices[a], op(values[a], other.values[b]));
+                ++a;
+                ++b;
+            }
+        }
+        for (; a < indices.size(); ++a)
+            push(indices[a], op(values[a], T(0)));
+        for (; b < other.indices.size(); ++b)
+            push(other.indices[b], op(T(0), other.values[b]));
+        return result;
+    }
+
+public:
+    explicit CompressedVector(size_t size) : size(size) {}
+
+    CompressedVector(size_t size, std::vector<size_t> indices, std::vector<T> values)
+        : size(size), indices(std::move(indices)), values(std::move(values))
+    {
+        if (this->indices.size() != this->values.size())
+            throw std::invalid_argument("Index and value arrays differ in length");
+        for (size_t k = 0; k < this->indices.size(); ++k)
+        {
+            if (this->indices[k] >= size)
+                throw std::out_of_range("Index out of range");
+            if (k > 0 && this->indices[k - 1] >= this->indices[k])
+                throw std::invalid_argument("Indices must be sorted and unique");
+        }
+    }
+
+    explicit CompressedVector(const SparseVector<T> &vec) : size(vec.getSize())
+    {
+        std::vector<std::pair<size_t, T>> entries;
+        entries.reserve(vec.nonZeros());
+        vec.forEach([&](size_t index, T value)
+                    { entries.emplace_back(index, value); });
+        std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b)
+                  { return a.first < b.first; });
+        indices.reserve(entries.size());
+        values.reserve(entries.size());
+        for (const auto &[index, value] : entries)
+        {
+            indices.push_back(index);
+            values.push_back(value);
+        }
+    }
+
+    static CompressedVector<T> fromDense(const std::vector<T> &dense)
+    {
+        CompressedVector<T> result(dense.size());
+        for (size_t i = 0; i < dense.size(); ++i)
+        {
+            if (dense[i] != 0)
+            {
+                result.indices.push_back(i);
+                result.values.push_back(dense[i]);
+            }
+        }
+        return result;
+    }
+
+    // Сбор (gather): значения плотного вектора в заданных отсортированных позициях
+    static CompressedVector<T> gather(const std::vector<T> &dense, const std::vector<size_t> &positions)
+    {
+        CompressedVector<T> result(dense.size());
+        result.indices.reserve(positions.size());
+        result.values.reserve(positions.size());
+        for (size_t k = 0; k < positions.size(); ++k)
+        {
+            size_t index = positions[k];
+            if (index >= dense.size())
+                throw std::out_of_range("Index out of range");
+            if (k > 0 && positions[k - 1] >= index)
+                throw std::invalid_argument("Indices must be sorted and unique");
+            if (dense[index] != 0)
+            {
+                result.indices.push_back(index);
+                result.values.push_back(dense[index]);
+            }
+        }
+        return result;
+    }
+
+    // Разброс (scatter): запись ненулевых элементов в плотный вектор
+    void scatter(std::vector<T> &dense) const
+    {
+        if (dense.size() != size)
+            throw std::invalid_argument("Vector sizes do not match");
+        for (size_t k = 0; k < indices.size(); ++k)
+            dense[indices[k]] = values[k];
+    }
+
+    // dense += alpha * this
+    void scatterAdd(std::vector<T> &dense, T alpha = T(1)) const
+    {
+        if (dense.size() != size)
+            throw std::invalid_argument("Vector sizes do not match");
+        for (size_t k = 0; k < indices.size(); ++k)
+            dense[indices[k]] += alpha * values[k];
+    }
+
+    std::vector<T> toDense() const
+    {
+        std::vector<T> dense(size, T(0));
+        scatter(dense);
+        return dense;
+    }
+
+    SparseVector<T> toSparseVector() const
+    {
+        SparseVector<T> result(size);
+        for (size_t k = 0; k < indices.size(); ++k)
+            result.set(indices[k], values[k]);
+        return result;
+    }
+
+    T get(size_t index) const
+    {
+        auto it = std::lower_bound(indices.begin(), indices.end(), index);
+        if (it != indices.end() && *it == index)
+            return values[it - indices.begin()];
+        return 0;
+    }
+
+    // Вставка в середину сдвигает хвост массивов: O(nnz).
+    // Для заполнения по одному элементу удобнее SparseVector с последующим преобразованием.
+    void set(size_t index, T value)
+    {
+        if (index >= size)
+            throw std::out_of_range("Index out of range");
+        auto it = std::lower_bound(indices.begin(), indices.end(), index);
+        size_t pos = it - indices.begin();
+        if (it != indices.end() && *it == index)
+        {
+            if (value != 0)
+                values[pos] = value;
+            else
+            {
+                indices.erase(it);
+                values.erase(values.begin() + pos);
+            }
+        }
+        else if (value != 0)
+        {
+            indices.insert(it, index);
+            values.insert(values.begin() + pos, value);
+        }
+    }
+
+    size_t getSize() const { return size; }
+    size_t nonZeros() const { return values.size(); }
+
+    const std::vector<size_t> &getIndices() const { return indices; }
+    const std::vector<T> &getValues() const { return values; }
+
+    // Обход ненулевых элементов по возрастанию индекса: f(index, value)
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (size_t k = 0; k < indices.size(); ++k)
+            f(indices[k], values[k]);
+    }
+
+    CompressedVector<T> operator+(const CompressedVector<T> &other) const
+    {
+        return merge(other, [](T a, T b)
+                     { return a + b; });
+    }
+
+    CompressedVector<T> operator-(const CompressedVector<T> &other) const
+    {
+        return merge(other, [](T a, T b)
+                     { return a - b; });
+    }
+
+    CompressedVector<T> operator*(T scalar) const
+    {
+        if (scalar == 0)
+            return CompressedVector<T>(size);
+        CompressedVector<T> result = *this;
+        for (T &value : result.values)
+            value *= scalar;
+        return result;
+    }
+
+    // Скалярное произведение: пересечение отсортированных индексов
+    T dot(const CompressedVector<T> &other) const
+    {
+        if (size != other.size)
+            throw std::invalid_argument("Vector sizes do not match");
+        Accumulator<T> result = 0;
+        size_t a = 0, b = 0;
+        while (a < indices.size() && b < other.indices.size())
+        {
+            if (indices[a] < other.indices[b])
+                ++a;
+            else if (other.indices[b] < indices[a])
+                ++b;
+            else
+                result += static_cast<Accumulator<T>>(values[a++]) * other.values[b++];
+        }
+        return static_cast<T>(result);
+    }
+
+    T dot(const std::vector<T> &dense) const
+    {
+        if (dense.size() != size)
+            throw std::invalid_argument("Vector sizes do not match");
+        Accumulator<T> result = 0;
+        for (size_t k = 0; k < indices.size(); ++k)
+            result += static_cast<Accumulator<T>>(values[k]) * dense[indices[k]];
+        return static_cast<T>(result);
+    }
+
+    void print() const
+    {
+        size_t k = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (k < indices.size() && indices[k] == i)
+                std::cout << values[k++] << " ";
+            else
+                std::cout << T(0) << " ";
+        }
+        std::cout << "\n";
+    }
+};
+
+#endif // COMPRESSED_VECTOR_HPP
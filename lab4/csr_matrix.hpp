@@ -0,0 +1,602 @@
+#ifndef CSR_MATRIX_HPP
+#define CSR_MATRIX_HPP
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+#include "numeric_types.hpp"
+
+// Разреженная матрица в сжатом строчном формате (Compressed Sparse Row).
+// Строка i занимает диапазон [row_ptr[i], row_ptr[i + 1]) массивов col_idx и values,
+// столбцы внутри строки отсортированы по возрастанию, нули не хранятся.
+// Index — тип номеров столбцов в col_idx (как у SparseMatrix): с uint32_t элемент матрицы
+// из float занимает 8 байт вместо 12. Смещения row_ptr остаются size_t, потому что
+// ненулевых элементов бывает больше, чем помещается в Index.
+template <typename T, typename Index = size_t>
+class CSRMatrix
+{
+private:
+    size_t rows, cols;
+    std::vector<size_t> row_ptr;
+    std::vector<Index> col_idx;
+    std::vector<T> values;
+
+public:
+    using value_type = T;
+    using index_type = Index;
+
+    // Проверка согласованности массивов CSR (для CSC — с переставленными rows и cols)
+    static void checkArrays(size_t rows, size_t cols, const std::vector<size_t> &ptr, const std::vector<Index> &idx,
+                            const std::vector<T> &val)
+    {
+        checkIndexRange<Index>(cols);
+        if (ptr.size() != rows + 1 || ptr.front() != 0 || ptr.back() != idx.size() || idx.size() != val.size())
+            throw std::invalid_argument("Inconsistent CSR arrays");
+        for (size_t i = 0; i < rows; ++i)
+        {
+            if (ptr[i] > ptr[i + 1])
+                throw std::invalid_argument("Inconsistent CSR arrays");
+            for (size_t k = ptr[i]; k < ptr[i + 1]; ++k)
+            {
+                if (idx[k] >= cols)
+                    throw std::out_of_range("Index out of range");
+                if (k > ptr[i] && idx[k - 1] >= idx[k])
+                    throw std::invalid_argument("CSR columns must be sorted and unique");
+            }
+        }
+    }
+
+    CSRMatrix(size_t rows, size_t cols) : rows(rows), cols(cols), row_ptr(rows + 1, 0)
+    {
+        checkIndexRange<Index>(cols);
+    }
+
+    CSRMatrix(size_t rows, size_t cols, std::vector<size_t> row_ptr, std::vector<Index> col_idx, std::vector<T> values)
+        : rows(rows), cols(cols), row_ptr(std::move(row_ptr)), col_idx(std::move(col_idx)), values(std::move(values))
+    {
+        checkArrays(rows, cols, this->row_ptr, this->col_idx, this->values);
+    }
+
+    // Преобразование из формата на хеш-таблицах
+    template <typename SourceIndex>
+    explicit CSRMatrix(const SparseMatrix<T, SourceIndex> &matrix)
+        : rows(matrix.getRows()), cols(matrix.getCols()), row_ptr(matrix.getRows() + 1, 0)
+    {
+        checkIndexRange<Index>(cols);
+        matrix.forEach([&](size_t row, size_t, T)
+                       { ++row_ptr[row + 1]; });
+        for (size_t i = 0; i < rows; ++i)
+            row_ptr[i + 1] += row_ptr[i];
+
+        std::vector<std::pair<Index, T>> entries(row_ptr[rows]);
+        std::vector<size_t> next(row_ptr.begin(), row_ptr.end() - 1);
+        matrix.forEach([&](size_t row, size_t col, T value)
+                       { entries[next[row]++] = {static_cast<Index>(col), value}; });
+
+        col_idx.resize(entries.size());
+        values.resize(entries.size());
+        for (size_t i = 0; i < rows; ++i)
+        {
+            auto first = entries.begin() + row_ptr[i];
+            auto last = entries.begin() + row_ptr[i + 1];
+            std::sort(first, last, [](const auto &a, const auto &b)
+                      { return a.first < b.first; });
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+            {
+                col_idx[k] = entries[k].first;
+                values[k] = entries[k].second;
+            }
+        }
+    }
+
+    static CSRMatrix identity(size_t n)
+    {
+        std::vector<size_t> ptr(n + 1);
+        std::vector<Index> idx(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            ptr[i + 1] = i + 1;
+            idx[i] = static_cast<Index>(i);
+        }
+        return CSRMatrix(n, n, std::move(ptr), std::move(idx), std::vector<T>(n, T(1)));
+    }
+
+    SparseMatrix<T, Index> toSparseMatrix() const
+    {
+        return SparseMatrix<T, Index>::fromCompressedRows(rows, cols, row_ptr, col_idx, values);
+    }
+
+    size_t getRows() const { return rows; }
+    size_t getCols() const { return cols; }
+    size_t nonZeros() const { return values.size(); }
+
+    const std::vector<size_t> &rowPtr() const { return row_ptr; }
+    const std::vector<Index> &colIdx() const { return col_idx; }
+    const std::vector<T> &getValues() const { return values; }
+
+    T get(size_t row, size_t col) const
+    {
+        if (row >= rows || col >= cols)
+            throw std::out_of_range("Index out of range");
+        auto first = col_idx.begin() + row_ptr[row];
+        auto last = col_idx.begin() + row_ptr[row + 1];
+        auto it = std::lower_bound(first, last, static_cast<Index>(col));
+        if (it != last && *it == col)
+            return values[it - col_idx.begin()];
+        return 0;
+    }
+
+    // Транспонирование сортировкой подсчётом: O(nnz + rows + cols)
+    CSRMatrix transpose() const
+    {
+        checkIndexRange<Index>(rows);
+        std::vector<size_t> ptr(cols + 1, 0);
+        for (size_t col : col_idx)
+            ++ptr[col + 1];
+        for (size_t j = 0; j < cols; ++j)
+            ptr[j + 1] += ptr[j];
+
+        std::vector<Index> idx(values.size());
+        std::vector<T> val(values.size());
+        std::vector<size_t> next(ptr.begin(), ptr.end() - 1);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+            {
+                size_t dest = next[col_idx[k]]++;
+                idx[dest] = static_cast<Index>(i);
+                val[dest] = values[k];
+            }
+        }
+        return CSRMatrix(cols, rows, std::move(ptr), std::move(idx), std::move(val));
+    }
+
+    // Сложение слиянием отсортированных строк
+    CSRMatrix operator+(const CSRMatrix &other) const
+    {
+        if (rows != other.rows || cols != other.cols)
+            throw std::invalid_argument("Matrix sizes do not match");
+        std::vector<size_t> ptr(rows + 1, 0);
+        std::vector<Index> idx;
+        std::vector<T> val;
+        idx.reserve(values.size() + other.values.size());
+        val.reserve(values.size() + other.values.size());
+        auto push = [&](Index col, T value)
+        {
+            if (value != 0)
+            {
+                idx.push_back(col);
+                val.push_back(value);
+            }
+        };
+        for (size_t i = 0; i < rows; ++i)
+        {
+            size_t a = row_ptr[i], aEnd = row_ptr[i + 1];
+            size_t b = other.row_ptr[i], bEnd = other.row_ptr[i + 1];
+            while (a < aEnd && b < bEnd)
+            {
+                if (col_idx[a] < other.col_idx[b])
+                {
+                    push(col_idx[a], values[a]);
+                    ++a;
+                }
+                else if (other.col_idx[b] < col_idx[a])
+                {
+                    push(other.col_idx[b], other.values[b]);
+                    ++b;
+                }
+                else
+                {
+                    push(col_idx[a], values[a] + other.values[b]);
+                    ++a;
+                    ++b;
+                }
+            }
+            for (; a < aEnd; ++a)
+                push(col_idx[a], values[a]);
+            for (; b < bEnd; ++b)
+                push(other.col_idx[b], other.values[b]);
+            ptr[i + 1] = idx.size();
+        }
+        return CSRMatrix(rows, cols, std::move(ptr), std::move(idx), std::move(val));
+    }
+
+    CSRMatrix operator*(T scalar) const
+    {
+        if (scalar == 0)
+            return CSRMatrix(rows, cols);
+        CSRMatrix result = *this;
+        for (T &value : result.values)
+            value *= scalar;
+        return result;
+    }
+
+    // Умножение на плотный вектор
+    std::vector<T> operator*(const std::vector<T> &vec) const { return multiply(vec); }
+
+    // Умножение на вектор другой точности (матрица во float, векторы в double и т. п.);
+    // суммы строк накапливаются в Accumulator от более широкого типа
+    template <typename V>
+    std::vector<V> multiply(const std::vector<V> &vec) const
+    {
+        using Sum = Accumulator<std::common_type_t<T, V>>;
+        if (cols != vec.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<V> result(rows, V(0));
+        for (size_t i = 0; i < rows; ++i)
+        {
+            Sum sum = 0;
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                sum += static_cast<Sum>(values[k]) * vec[col_idx[k]];
+            result[i] = static_cast<V>(sum);
+        }
+        return result;
+    }
+
+    SparseVector<T> operator*(const SparseVector<T> &vec) const
+    {
+        if (cols != vec.getSize())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        SparseVector<T> result(rows);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            Accumulator<T> sum = 0;
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                sum += static_cast<Accumulator<T>>(values[k]) * vec.get(col_idx[k]);
+            result.set(i, static_cast<T>(sum));
+        }
+        return result;
+    }
+
+    // Умножение транспонированной матрицы на вектор без построения A^T:
+    // строка i разбрасывается в sums[col] с весом vec[i]
+    std::vector<T> multiplyTransposed(const std::vector<T> &vec) const
+    {
+        if (rows != vec.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<Accumulator<T>> sums(cols, Accumulator<T>(0));
+        for (size_t i = 0; i < rows; ++i)
+        {
+            T x = vec[i];
+            if (x == 0)
+                continue;
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                sums[col_idx[k]] += static_cast<Accumulator<T>>(values[k]) * x;
+        }
+        return std::vector<T>(sums.begin(), sums.end());
+    }
+
+    // Просматриваются только строки, соответствующие ненулевым элементам vec
+    SparseVector<T> multiplyTransposed(const SparseVector<T> &vec) const
+    {
+        if (rows != vec.getSize())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<Accumulator<T>> accumulator(cols, Accumulator<T>(0));
+        std::vector<bool> used(cols, false);
+        std::vector<size_t> touched;
+        vec.forEach([&](size_t i, T x)
+                    {
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+            {
+                size_t col = col_idx[k];
+                if (!used[col])
+                {
+                    used[col] = true;
+                    touched.push_back(col);
+                }
+                accumulator[col] += static_cast<Accumulator<T>>(values[k]) * x;
+            } });
+        std::sort(touched.begin(), touched.end());
+        std::vector<T> resultValues(touched.size());
+        for (size_t k = 0; k < touched.size(); ++k)
+            resultValues[k] = static_cast<T>(accumulator[touched[k]]);
+        return SparseVector<T>(cols, touched, resultValues);
+    }
+
+    // Символическая фаза умножения (алгоритм Густавсона): число ненулевых
+    // элементов в каждой строке произведения без вычисления значений.
+    // Возвращает row_ptr результата, по которому память выделяется заранее.
+    std::vector<size_t> multiplySymbolic(const CSRMatrix &other) const
+    {
+        if (cols != other.rows)
+            throw std::invalid_argument("Matrix dimensions do not allow multiplication");
+        std::vector<size_t> ptr(rows + 1, 0);
+        std::vector<size_t> marker(other.cols, rows);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            size_t count = 0;
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+            {
+                size_t mid = col_idx[k];
+                for (size_t m = other.row_ptr[mid]; m < other.row_ptr[mid + 1]; ++m)
+                {
+                    size_t col = other.col_idx[m];
+                    if (marker[col] != i)
+                    {
+                        marker[col] = i;
+                        ++count;
+                    }
+                }
+            }
+            ptr[i + 1] = ptr[i] + count;
+        }
+        return ptr;
+    }
+
+    // Численная фаза: строка i результата собирается в плотном аккумуляторе
+    // из строк other, соответствующих ненулевым элементам строки i.
+    // Затрагиваются только ненулевые элементы, стоимость не зависит от other.cols.
+    CSRMatrix operator*(const CSRMatrix &other) const
+    {
+        std::vector<size_t> ptr = multiplySymbolic(other);
+        std::vector<Index> idx(ptr[rows]);
+        std::vector<T> val(ptr[rows]);
+        std::vector<Accumulator<T>> accumulator(other.cols, Accumulator<T>(0));
+        std::vector<size_t> marker(other.cols, rows);
+        bool cancelled = false;
+        for (size_t i = 0; i < rows; ++i)
+        {
+            size_t next = ptr[i];
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+            {
+                size_t mid = col_idx[k];
+                Accumulator<T> value = values[k];
+                for (size_t m = other.row_ptr[mid]; m < other.row_ptr[mid + 1]; ++m)
+                {
+                    Index col = other.col_idx[m];
+                    if (marker[col] != i)
+                    {
+                        marker[col] = i;
+                        idx[next++] = col;
+                    }
+                    accumulator[col] += value * other.values[m];
+                }
+            }
+            std::sort(idx.begin() + ptr[i], idx.begin() + ptr[i + 1]);
+            for (size_t k = ptr[i]; k < ptr[i + 1]; ++k)
+            {
+                val[k] = static_cast<T>(accumulator[idx[k]]);
+                accumulator[idx[k]] = 0;
+                cancelled = cancelled || val[k] == 0;
+            }
+        }
+
+        // Взаимное уничтожение слагаемых даёт нули, которые не должны храниться
+        if (cancelled)
+        {
+            size_t write = 0, start = 0;
+            for (size_t i = 0; i < rows; ++i)
+            {
+                for (size_t k = start; k < ptr[i + 1]; ++k)
+                {
+                    if (val[k] != 0)
+                    {
+                        idx[write] = idx[k];
+                        val[write] = val[k];
+                        ++write;
+                    }
+                }
+                start = ptr[i + 1];
+                ptr[i + 1] = write;
+            }
+            idx.resize(write);
+            val.resize(write);
+        }
+        return CSRMatrix(rows, other.cols, std::move(ptr), std::move(idx), std::move(val));
+    }
+
+    CSRMatrix power(int exponent) const
+    {
+        if (rows != cols)
+            throw std::invalid_argument("Matrix must be square");
+        if (exponent < 0)
+            throw std::invalid_argument("Exponent must be non-negative");
+
+        CSRMatrix result = identity(rows);
+        CSRMatrix base = *this;
+        while (exponent > 0)
+        {
+            if (exponent % 2 == 1)
+                result = result * base;
+            exponent /= 2;
+            if (exponent > 0)
+                base = base * base;
+        }
+        return result;
+    }
+
+    void print() const
+    {
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t j = 0; j < cols; ++j)
+                std::cout << get(i, j) << " ";
+            std::cout << "\n";
+        }
+    }
+};
+
+// Разреженная матрица в сжатом столбцовом формате (Compressed Sparse Column).
+// Столбец j занимает диапазон [col_ptr[j], col_ptr[j + 1]) массивов row_idx и values.
+// Хранение совпадает с CSR-представлением транспонированной матрицы; Index — тип номеров строк.
+template <typename T, typename Index = size_t>
+class CSCMatrix
+{
+private:
+    size_t rows, cols;
+    std::vector<size_t> col_ptr;
+    std::vector<Index> row_idx;
+    std::vector<T> values;
+
+public:
+    using value_type = T;
+    using index_type = Index;
+
+    CSCMatrix(size_t rows, size_t cols) : rows(rows), cols(cols), col_ptr(cols + 1, 0)
+    {
+        checkIndexRange<Index>(rows);
+    }
+
+    CSCMatrix(size_t rows, size_t cols, std::vector<size_t> col_ptr, std::vector<Index> row_idx, std::vector<T> values)
+        : rows(rows), cols(cols), col_ptr(std::move(col_ptr)), row_idx(std::move(row_idx)), values(std::move(values))
+    {
+        CSRMatrix<T, Index>::checkArrays(cols, rows, this->col_ptr, this->row_idx, this->values);
+    }
+
+    explicit CSCMatrix(const CSRMatrix<T, Index> &matrix) : rows(matrix.getRows()), cols(matrix.getCols())
+    {
+        CSRMatrix<T, Index> transposed = matrix.transpose();
+        col_ptr = transposed.rowPtr();
+        row_idx = transposed.colIdx();
+        values = transposed.getValues();
+    }
+
+    template <typename SourceIndex>
+    explicit CSCMatrix(const SparseMatrix<T, SourceIndex> &matrix)
+        : CSCMatrix(CSRMatrix<T, Index>(matrix)) {}
+
+    CSRMatrix<T, Index> toCSR() const
+    {
+        return CSRMatrix<T, Index>(cols, rows, col_ptr, row_idx, values).transpose();
+    }
+
+    SparseMatrix<T, Index> toSparseMatrix() const { return toCSR().toSparseMatrix(); }
+
+    size_t getRows() const { return rows; }
+    size_t getCols() const { return cols; }
+    size_t nonZeros() const { return values.size(); }
+
+    const std::vector<size_t> &colPtr() const { return col_ptr; }
+    const std::vector<Index> &rowIdx() const { return row_idx; }
+    const std::vector<T> &getValues() const { return values; }
+
+    T get(size_t row, size_t col) const
+    {
+        if (row >= rows || col >= cols)
+            throw std::out_of_range("Index out of range");
+        auto first = row_idx.begin() + col_ptr[col];
+        auto last = row_idx.begin() + col_ptr[col + 1];
+        auto it = std::lower_bound(first, last, static_cast<Index>(row));
+        if (it != last && *it == row)
+            return values[it - row_idx.begin()];
+        return 0;
+    }
+
+    // Массивы CSC исходной матрицы — это CSR-представление транспонированной
+    CSCMatrix transpose() const
+    {
+        return CSCMatrix(CSRMatrix<T, Index>(cols, rows, col_ptr, row_idx, values));
+    }
+
+    CSCMatrix operator+(const CSCMatrix &other) const
+    {
+        return CSCMatrix(toCSR() + other.toCSR());
+    }
+
+    CSCMatrix operator*(T scalar) const
+    {
+        if (scalar == 0)
+            return CSCMatrix(rows, cols);
+        CSCMatrix result = *this;
+        for (T &value : result.values)
+            value *= scalar;
+        return result;
+    }
+
+    // Умножение на плотный вектор разбрасыванием столбцов
+    std::vector<T> operator*(const std::vector<T> &vec) const
+    {
+        if (cols != vec.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<Accumulator<T>> sums(rows, Accumulator<T>(0));
+        for (size_t j = 0; j < cols; ++j)
+        {
+            T x = vec[j];
+            if (x == 0)
+                continue;
+            for (size_t k = col_ptr[j]; k < col_ptr[j + 1]; ++k)
+                sums[row_idx[k]] += static_cast<Accumulator<T>>(values[k]) * x;
+        }
+        return std::vector<T>(sums.begin(), sums.end());
+    }
+
+    // Для разреженного вектора просматриваются только столбцы его ненулевых элементов
+    SparseVector<T> operator*(const SparseVector<T> &vec) const
+    {
+        if (cols != vec.getSize())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<Accumulator<T>> dense(rows, Accumulator<T>(0));
+        vec.forEach([&](size_t j, T x)
+                    {
+            for (size_t k = col_ptr[j]; k < col_ptr[j + 1]; ++k)
+                dense[row_idx[k]] += static_cast<Accumulator<T>>(values[k]) * x; });
+        SparseVector<T> result(rows);
+        for (size_t i = 0; i < rows; ++i)
+            result.set(i, static_cast<T>(dense[i]));
+        return result;
+    }
+
+    // Столбцы CSC — строки A^T, поэтому A^T * vec считается сбором без записи в общие ячейки
+    std::vector<T> multiplyTransposed(const std::vector<T> &vec) const
+    {
+        if (rows != vec.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<T> result(cols);
+        for (size_t j = 0; j < cols; ++j)
+        {
+            Accumulator<T> sum = 0;
+            for (size_t k = col_ptr[j]; k < col_ptr[j + 1]; ++k)
+                sum += static_cast<Accumulator<T>>(values[k]) * vec[row_idx[k]];
+            result[j] = static_cast<T>(sum);
+        }
+        return result;
+    }
+
+    SparseVector<T> multiplyTransposed(const SparseVector<T> &vec) const
+    {
+        if (rows != vec.getSize())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<size_t> resultIndices;
+        std::vector<T> resultValues;
+        for (size_t j = 0; j < cols; ++j)
+        {
+            Accumulator<T> sum = 0;
+            for (size_t k = col_ptr[j]; k < col_ptr[j + 1]; ++k)
+                sum += static_cast<Accumulator<T>>(values[k]) * vec.get(row_idx[k]);
+            if (static_cast<T>(sum) != 0)
+            {
+                resultIndices.push_back(j);
+                resultValues.push_back(static_cast<T>(sum));
+            }
+        }
+        return SparseVector<T>(cols, resultIndices, resultValues);
+    }
+
+    CSCMatrix operator*(const CSCMatrix &other) const
+    {
+        return CSCMatrix(toCSR() * other.toCSR());
+    }
+
+    CSCMatrix power(int exponent) const
+    {
+        return CSCMatrix(toCSR().power(exponent));
+    }
+
+    void print() const
+    {
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t j = 0; j < cols; ++j)
+                std::cout << get(i, j) << " ";
+            std::cout << "\n";
+        }
+    }
+};
+
+#endif // CSR_MATRIX_HPP
@@ -0,0 +1,738 @@
+#ifndef DIRECT_SOLVER_HPP
+#define DIRECT_SOLVER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "csr_matrix.hpp"
+
+// Прямые методы: разреженные разложения Холецкого (L L^T) и LU.
+// Разложение делится на символическую фазу (упорядочение, дерево исключения, портрет
+// множителей), которая зависит только от портрета матрицы и переиспользуется для матриц
+// с тем же портретом, и численную фазу. Готовый множитель решает систему для любого
+// числа правых частей.
+
+enum class Ordering
+{
+    Natural,      // без перестановки
+    MinimumDegree // минимальная степень на графе A + A^T, уменьшает заполнение
+};
+
+// Упорядочение приближённой минимальной степени (в духе AMD) на факторграфе: исключённая вершина
+// не связывает соседей в явную клику, а становится «элементом» со списком своих соседей.
+// Вершина хранит соседей-вершины и смежные элементы, элементы, целиком вошедшие в новый,
+// поглощаются, поэтому память не превышает исходного портрета плюс списков элементов.
+// Степень заменяется верхней оценкой |A_i| + |L_p \ {i}| + sum |L_e \ L_p|, которая
+// считается за время, пропорциональное размеру списков. Возвращает perm: новый номер -> старый.
+template <typename T>
+std::vector<size_t> minimumDegreeOrdering(const CSRMatrix<T> &matrix)
+{
+    size_t n = matrix.getRows();
+    if (n != matrix.getCols())
+        throw std::invalid_argument("Matrix must be square");
+
+    // Симметризованный граф без петель
+    std::vector<std::vector<size_t>> adjacency(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (size_t k = matrix.rowPtr()[i]; k < matrix.rowPtr()[i + 1]; ++k)
+        {
+            size_t j = matrix.colIdx()[k];
+            if (i != j)
+            {
+                adjacency[i].push_back(j);
+                adjacency[j].push_back(i);
+            }
+        }
+    }
+    std::vector<size_t> degree(n);
+    std::set<std::pair<size_t, size_t>> queue; // (оценка степени, вершина)
+    for (size_t i = 0; i < n; ++i)
+    {
+        std::sort(adjacency[i].begin(), adjacency[i].end());
+        adjacency[i].erase(std::unique(adjacency[i].begin(), adjacency[i].end()), adjacency[i].end());
+        degree[i] = adjacency[i].size();
+        queue.emplace(degree[i], i);
+    }
+
+    std::vector<std::vector<size_t>> elementsOf(n); // смежные элементы вершины
+    std::vector<std::vector<size_t>> members(n);    // вершины элемента
+    std::vector<char> absorbed(n, 0);
+    std::vector<size_t> mark(n, 0);                 // mark[v] == stamp: v входит в текущий L_p
+    const size_t unset = std::numeric_limits<size_t>::max();
+    std::vector<size_t> external(n, unset);         // |L_e \ L_p| для элементов, смежных с L_p
+    std::vector<size_t> touched;
+
+    std::vector<size_t> perm;
+    perm.reserve(n);
+    while (!queue.empty())
+    {
+        size_t p = queue.begin()->second;
+        queue.erase(queue.begin());
+        perm.push_back(p);
+        size_t stamp = perm.size();
+
+        // L_p = соседи p и вершины смежных с p элементов; эти элементы поглощаются элементом p
+        std::vector<size_t> &front = members[p];
+        for (size_t j : adjacency[p])
+        {
+            if (mark[j] != stamp)
+            {
+                mark[j] = stamp;
+                front.push_back(j);
+            }
+        }
+        for (size_t e : elementsOf[p])
+        {
+            for (size_t j : members[e])
+            {
+                if (j != p && mark[j] != stamp)
+                {
+                    mark[j] = stamp;
+                    front.push_back(j);
+                }
+            }
+            absorbed[e] = 1;
+            std::vector<size_t>().swap(members[e]);
+        }
+        std::vector<size_t>().swap(adjacency[p]);
+        std::vector<size_t>().swap(elementsOf[p]);
+
+        // Рёбра внутри L_p теперь представлены элементом p
+        for (size_t i : front)
+        {
+            std::vector<size_t> &elements = elementsOf[i];
+            elements.erase(std::remove_if(elements.begin(), elements.end(), [&](size_t e)
+                                          { return absorbed[e]; }),
+                           elements.end());
+            elements.push_back(p);
+            std::vector<size_t> &neighbours = adjacency[i];
+            neighbours.erase(std::remove_if(neighbours.begin(), neighbours.end(), [&](size_t j)
+                                            { return j == p || mark[j] == stamp; }),
+                             neighbours.end());
+        }
+
+        for (size_t i : front)
+        {
+            for (size_t e : elementsOf[i])
+            {
+                if (e == p)
+                    continue;
+                if (external[e] == unset)
+                {
+                    external[e] = members[e].size();
+                    touched.push_back(e);
+                }
+                --external[e];
+            }
+        }
+
+        size_t remaining = n - perm.size();
+        for (size_t i : front)
+        {
+            // Элемент, все вершины которого попали в L_p, поглощается (агрессивное поглощение)
+            size_t outside = 0;
+            std::vector<size_t> &elements = elementsOf[i];
+            elements.erase(std::remove_if(elements.begin(), elements.end(), [&](size_t e)
+                                          {
+                                              if (e == p)
+                                                  return false;
+                                              if (external[e] == 0)
+                                                  absorbed[e] = 1;
+                                              else
+                                                  outside += external[e];
+                                              return absorbed[e] != 0;
+                                          }),
+                           elements.end());
+            size_t estimate = adjacency[i].size() + front.size() - 1 + outside;
+            estimate = std::min({estimate, degree[i] + front.size() - 1, remaining - 1});
+            queue.erase({degree[i], i});
+            degree[i] = estimate;
+            queue.emplace(degree[i], i);
+        }
+        for (size_t e : touched)
+        {
+            if (absorbed[e])
+                std::vector<size_t>().swap(members[e]);
+            external[e] = unset;
+        }
+        touched.clear();
+    }
+    return perm;
+}
+
+template <typename T>
+std::vector<size_t> computeOrdering(const CSRMatrix<T> &matrix, Ordering ordering)
+{
+    if (ordering == Ordering::MinimumDegree)
+        return minimumDegreeOrdering(matrix);
+    std::vector<size_t> perm(matrix.getRows());
+    for (size_t i = 0; i < perm.size(); ++i)
+        perm[i] = i;
+    return perm;
+}
+
+// Символический анализ для Холецкого: перестановка, дерево исключения, портрет L
+// и разбиение столбцов L на суперузлы (соседние столбцы с вложенным портретом).
+struct CholeskySymbolic
+{
+    size_t n = 0;
+    std::vector<size_t> perm, pinv;        // новый -> старый, старый -> новый
+    std::vector<size_t> parent;            // дерево исключения (n — корень)
+    std::vector<size_t> super_start;       // суперузел s: столбцы [super_start[s], super_start[s + 1])
+    std::vector<size_t> super_of;          // столбец -> суперузел
+    std::vector<size_t> super_row_ptr;     // строки суперузла s: super_rows[super_row_ptr[s]...]
+    std::vector<size_t> super_rows;
+    std::vector<size_t> value_ptr;         // начало плотного блока суперузла в массиве значений
+    // Сборка: элементы нижнего треугольника P A P^T по столбцам
+    std::vector<size_t> assembly_ptr, assembly_row, assembly_source;
+    // Портрет исходной матрицы для проверки при повторной факторизации
+    std::vector<size_t> source_row_ptr, source_col_idx;
+
+    size_t factorNonZeros() const
+    {
+        size_t count = 0;
+        for (size_t s = 0; s + 1 < super_start.size(); ++s)
+        {
+            size_t width = super_start[s + 1] - super_start[s];
+            size_t height = super_row_ptr[s + 1] - super_row_ptr[s];
+            count += width * height - width * (width - 1) / 2;
+        }
+        return count;
+    }
+
+    size_t supernodeCount() const { return super_start.size() - 1; }
+
+    template <typename T>
+    bool matches(const CSRMatrix<T> &matrix) const
+    {
+        return matrix.rowPtr() == source_row_ptr && matrix.colIdx() == source_col_idx;
+    }
+};
+
+template <typename T>
+CholeskySymbolic analyzeCholesky(const CSRMatrix<T> &matrix, Ordering ordering = Ordering::MinimumDegree)
+{
+    const size_t none = std::numeric_limits<size_t>::max();
+    CholeskySymbolic symbolic;
+    size_t n = symbolic.n = matrix.getRows();
+    if (n != matrix.getCols())
+        throw std::invalid_argument("Matrix must be square");
+    symbolic.source_row_ptr = matrix.rowPtr();
+    symbolic.source_col_idx = matrix.colIdx();
+    symbolic.perm = computeOrdering(matrix, ordering);
+    symbolic.pinv.resize(n);
+    for (size_t k = 0; k < n; ++k)
+        symbolic.pinv[symbolic.perm[k]] = k;
+
+    // Нижний треугольник P A P^T по столбцам; элемент берётся из любого треугольника A,
+    // поэтому подходит как полное, так и треугольное хранение симметричной матрицы
+    std::vector<std::vector<std::pair<size_t, size_t>>> lowerColumns(n);
+    std::vector<std::vector<size_t>> lowerRows(n);
+    for (size_t oi = 0; oi < n; ++oi)
+    {
+        for (size_t k = matrix.rowPtr()[oi]; k < matrix.rowPtr()[oi + 1]; ++k)
+        {
+            size_t i = symbolic.pinv[oi], j = symbolic.pinv[matrix.colIdx()[k]];
+            if (i < j)
+                std::swap(i, j);
+            lowerColumns[j].emplace_back(i, k);
+        }
+    }
+    symbolic.assembly_ptr.assign(n + 1, 0);
+    for (size_t j = 0; j < n; ++j)
+    {
+        auto &column = lowerColumns[j];
+        std::sort(column.begin(), column.end());
+        column.erase(std::unique(column.begin(), column.end(), [](const auto &a, const auto &b)
+                                 { return a.first == b.first; }),
+                     column.end());
+        for (const auto &[i, source] : column)
+        {
+            symbolic.assembly_row.push_back(i);
+            symbolic.assembly_source.push_back(source);
+            if (i != j)
+                lowerRows[i].push_back(j);
+        }
+        symbolic.assembly_ptr[j + 1] = symbolic.assembly_row.size();
+    }
+
+    // Дерево исключения (алгоритм Лю со сжатием путей)
+    symbolic.parent.assign(n, none);
+    std::vector<size_t> ancestor(n, none);
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (size_t k : lowerRows[i])
+        {
+            size_t r = k;
+            while (ancestor[r] != none && ancestor[r] != i)
+            {
+                size_t next = ancestor[r];
+                ancestor[r] = i;
+                r = next;
+            }
+            if (ancestor[r] == none)
+            {
+                ancestor[r] = i;
+                symbolic.parent[r] = i;
+            }
+        }
+    }
+
+    // Портрет L по поддеревьям строк: строка i содержит вершины путей от k до i
+    std::vector<std::vector<size_t>> columnRows(n);
+    std::vector<size_t> mark(n, none);
+    for (size_t i = 0; i < n; ++i)
+    {
+        columnRows[i].push_back(i);
+        mark[i] = i;
+        for (size_t k : lowerRows[i])
+        {
+            for (size_t r = k; r != none && mark[r] != i; r = symbolic.parent[r])
+            {
+                columnRows[r].push_back(i);
+                mark[r] = i;
+            }
+        }
+    }
+
+    // Суперузлы: j + 1 продолжает суперузел j, если это родитель j и портреты вложены
+    symbolic.super_of.resize(n);
+    symbolic.super_start.push_back(0);
+    for (size_t j = 0; j < n; ++j)
+    {
+        if (j > 0 && !(symbolic.parent[j - 1] == j && columnRows[j - 1].size() == columnRows[j].size() + 1))
+            symbolic.super_start.push_back(j);
+        symbolic.super_of[j] = symbolic.super_start.size() - 1;
+    }
+    symbolic.super_start.push_back(n);
+
+    size_t supernodes = symbolic.super_start.size() - 1;
+    symbolic.super_row_ptr.assign(supernodes + 1, 0);
+    symbolic.value_ptr.assign(supernodes + 1, 0);
+    for (size_t s = 0; s < supernodes; ++s)
+    {
+        const std::vector<size_t> &rows = columnRows[symbolic.super_start[s]];
+        symbolic.super_rows.insert(symbolic.super_rows.end(), rows.begin(), rows.end());
+        symbolic.super_row_ptr[s + 1] = symbolic.super_rows.size();
+        size_t width = symbolic.super_start[s + 1] - symbolic.super_start[s];
+        symbolic.value_ptr[s + 1] = symbolic.value_ptr[s] + rows.size() * width;
+    }
+    return symbolic;
+}
+
+// Численное разложение Холецкого P A P^T = L L^T по суперузлам (левостороннее).
+// Каждый суперузел хранится плотным блоком по столбцам: обновления от потомков
+// и разложение диагонального блока выполняются плотными циклами.
+template <typename T>
+class CholeskyFactor
+{
+private:
+    std::shared_ptr<const CholeskySymbolic> symbolic;
+    std::vector<T> values;
+
+public:
+    // Анализ хранится общим указателем: несколько множителей с одним портретом разделяют его,
+    // а множитель, построенный из временного результата analyzeCholesky, владеет своей копией
+    CholeskyFactor(std::shared_ptr<const CholeskySymbolic> symbolic, const CSRMatrix<T> &matrix)
+        : symbolic(std::move(symbolic))
+    {
+        if (!this->symbolic)
+            throw std::invalid_argument("Symbolic analysis is missing");
+        refactor(matrix);
+    }
+
+    CholeskyFactor(CholeskySymbolic symbolic, const CSRMatrix<T> &matrix)
+        : CholeskyFactor(std::make_shared<const CholeskySymbolic>(std::move(symbolic)), matrix)
+    {
+    }
+
+    const std::shared_ptr<const CholeskySymbolic> &analysis() const { return symbolic; }
+
+    // Повторная численная факторизация матрицы с тем же портретом
+    void refactor(const CSRMatrix<T> &matrix)
+    {
+        if (!symbolic->matches(matrix))
+            throw std::invalid_argument("Matrix pattern differs from the analyzed one");
+        const size_t none = std::numeric_limits<size_t>::max();
+        size_t n = symbolic->n;
+        size_t supernodes = symbolic->supernodeCount();
+        values.assign(symbolic->value_ptr[supernodes], T(0));
+
+        // Списки потомков, ожидающих применения к суперузлу, и их текущая строка
+        std::vector<size_t> head(supernodes, none), next(supernodes, none), cursor(supernodes, 0);
+        std::vector<size_t> position(n, 0);
+        std::vector<T> update;
+        auto link = [&](size_t s)
+        {
+            size_t height = symbolic->super_row_ptr[s + 1] - symbolic->super_row_ptr[s];
+            if (cursor[s] < height)
+            {
+                size_t target = symbolic->super_of[symbolic->super_rows[symbolic->super_row_ptr[s] + cursor[s]]];
+                next[s] = head[target];
+                head[target] = s;
+            }
+        };
+
+        for (size_t s = 0; s < supernodes; ++s)
+        {
+            size_t first = symbolic->super_start[s], last = symbolic->super_start[s + 1];
+            size_t width = last - first;
+            const size_t *rows = symbolic->super_rows.data() + symbolic->super_row_ptr[s];
+            size_t height = symbolic->super_row_ptr[s + 1] - symbolic->super_row_ptr[s];
+            T *block = values.data() + symbolic->value_ptr[s];
+            for (size_t r = 0; r < height; ++r)
+                position[rows[r]] = r;
+
+            // Сборка столбцов матрицы
+            for (size_t j = first; j < last; ++j)
+                for (size_t p = symbolic->assembly_ptr[j]; p < symbolic->assembly_ptr[j + 1]; ++p)
+                    block[(j - first) * height + position[symbolic->assembly_row[p]]] +=
+                        matrix.getValues()[symbolic->assembly_source[p]];
+
+            // Обновления от потомков: block -= L_D[rows >= first] * L_D[rows in first..last]^T
+            size_t d = head[s];
+            while (d != none)
+            {
+                size_t nextD = next[d];
+                size_t dWidth = symbolic->super_start[d + 1] - symbolic->super_start[d];
+                size_t dHeight = symbolic->super_row_ptr[d + 1] - symbolic->super_row_ptr[d];
+                const size_t *dRows = symbolic->super_rows.data() + symbolic->super_row_ptr[d];
+                const T *dBlock = values.data() + symbolic->value_ptr[d];
+                size_t begin = cursor[d], inside = begin;
+                while (inside < dHeight && dRows[inside] < last)
+                    ++inside;
+                size_t m = dHeight - begin, k = inside - begin;
+                update.assign(m * k, T(0));
+                for (size_t c = 0; c < dWidth; ++c)
+                {
+                    const T *column = dBlock + c * dHeight + begin;
+                    for (size_t b = 0; b < k; ++b)
+                    {
+                        T factor = column[b];
+                        for (size_t a = b; a < m; ++a)
+                            update[b * m + a] += column[a] * factor;
+                    }
+                }
+                for (size_t b = 0; b < k; ++b)
+                {
+                    T *target = block + (dRows[begin + b] - first) * height;
+                    for (size_t a = b; a < m; ++a)
+                        target[position[dRows[begin + a]]] -= update[b * m + a];
+                }
+                cursor[d] = inside;
+                link(d);
+                d = nextD;
+            }
+
+            // Плотное разложение блока: диагональная часть и решение для строк ниже
+            for (size_t c = 0; c < width; ++c)
+            {
+                T *column = block + c * height;
+                for (size_t p = 0; p < c; ++p)
+                {
+                    const T *previous = block + p * height;
+                    T factor = previous[c];
+                    for (size_t r = c; r < height; ++r)
+                        column[r] -= previous[r] * factor;
+                }
+                if (!(column[c] > 0))
+                    throw std::invalid_argument("Matrix is not positive definite");
+                T diagonal = std::sqrt(column[c]);
+                column[c] = diagonal;
+                for (size_t r = c + 1; r < height; ++r)
+                    column[r] /= diagonal;
+            }
+            cursor[s] = width;
+            link(s);
+        }
+    }
+
+    size_t nonZeros() const { return symbolic->factorNonZeros(); }
+
+    std::vector<T> solve(const std::vector<T> &b) const
+    {
+        size_t n = symbolic->n;
+        if (b.size() != n)
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<T> y(n);
+        for (size_t i = 0; i < n; ++i)
+            y[symbolic->pinv[i]] = b[i];
+
+        size_t supernodes = symbolic->supernodeCount();
+        for (size_t s = 0; s < supernodes; ++s)
+        {
+            size_t first = symbolic->super_start[s], width = symbolic->super_start[s + 1] - first;
+            const size_t *rows = symbolic->super_rows.data() + symbolic->super_row_ptr[s];
+            size_t height = symbolic->super_row_ptr[s + 1] - symbolic->super_row_ptr[s];
+            const T *block = values.data() + symbolic->value_ptr[s];
+            for (size_t c = 0; c < width; ++c)
+            {
+                const T *column = block + c * height;
+                T value = y[first + c] /= column[c];
+                for (size_t r = c + 1; r < height; ++r)
+                    y[rows[r]] -= column[r] * value;
+            }
+        }
+        for (size_t s = supernodes; s-- > 0;)
+        {
+            size_t first = symbolic->super_start[s], width = symbolic->super_start[s + 1] - first;
+            const size_t *rows = symbolic->super_rows.data() + symbolic->super_row_ptr[s];
+            size_t height = symbolic->super_row_ptr[s + 1] - symbolic->super_row_ptr[s];
+            const T *block = values.data() + symbolic->value_ptr[s];
+            for (size_t c = width; c-- > 0;)
+            {
+                const T *column = block + c * height;
+                T sum = y[first + c];
+                for (size_t r = c + 1; r < height; ++r)
+                    sum -= column[r] * y[rows[r]];
+                y[first + c] = sum / column[c];
+            }
+        }
+
+        std::vector<T> x(n);
+        for (size_t i = 0; i < n; ++i)
+            x[i] = y[symbolic->pinv[i]];
+        return x;
+    }
+
+    std::vector<std::vector<T>> solve(const std::vector<std::vector<T>> &rightHandSides) const
+    {
+        std::vector<std::vector<T>> result;
+        result.reserve(rightHandSides.size());
+        for (const std::vector<T> &b : rightHandSides)
+            result.push_back(solve(b));
+        return result;
+    }
+};
+
+// Символический анализ для LU: упорядочение столбцов и оценка размера множителей.
+// Строки переставляются при численной факторизации (частичный выбор ведущего элемента).
+struct LUSymbolic
+{
+    size_t n = 0;
+    std::vector<size_t> q; // новый столбец -> старый
+    size_t estimatedNonZeros = 0;
+    std::vector<size_t> source_row_ptr, source_col_idx;
+
+    template <typename T>
+    bool matches(const CSRMatrix<T> &matrix) const
+    {
+        return matrix.rowPtr() == source_row_ptr && matrix.colIdx() == source_col_idx;
+    }
+};
+
+template <typename T>
+LUSymbolic analyzeLU(const CSRMatrix<T> &matrix, Ordering ordering = Ordering::MinimumDegree)
+{
+    LUSymbolic symbolic;
+    symbolic.n = matrix.getRows();
+    if (symbolic.n != matrix.getCols())
+        throw std::invalid_argument("Matrix must be square");
+    symbolic.q = computeOrdering(matrix, ordering);
+    symbolic.estimatedNonZeros = 4 * matrix.nonZeros() + symbolic.n;
+    symbolic.source_row_ptr = matrix.rowPtr();
+    symbolic.source_col_idx = matrix.colIdx();
+    return symbolic;
+}
+
+// Левостороннее LU-разложение Гилберта–Пирлса: P A Q = L U.
+// Для каждого столбца решается разреженная треугольная система с L; её портрет
+// находится обходом в глубину по графу L, поэтому работа пропорциональна числу операций.
+// Ведущий элемент — диагональный, если он не меньше pivotThreshold от максимального
+// в столбце (сохраняет упорядочение), иначе максимальный по модулю.
+template <typename T>
+class LUFactor
+{
+private:
+    std::shared_ptr<const LUSymbolic> symbolic;
+    std::vector<size_t> pinv; // старая строка -> номер ведущей строки
+    std::vector<size_t> l_ptr, l_idx, u_ptr, u_idx;
+    std::vector<T> l_val, u_val;
+    double pivotThreshold;
+
+public:
+    LUFactor(std::shared_ptr<const LUSymbolic> symbolic, const CSRMatrix<T> &matrix, double pivotThreshold = 0.1)
+        : symbolic(std::move(symbolic)), pivotThreshold(pivotThreshold)
+    {
+        if (!this->symbolic)
+            throw std::invalid_argument("Symbolic analysis is missing");
+        refactor(matrix);
+    }
+
+    LUFactor(LUSymbolic symbolic, const CSRMatrix<T> &matrix, double pivotThreshold = 0.1)
+        : LUFactor(std::make_shared<const LUSymbolic>(std::move(symbolic)), matrix, pivotThreshold)
+    {
+    }
+
+    const std::shared_ptr<const LUSymbolic> &analysis() const { return symbolic; }
+
+    void refactor(const CSRMatrix<T> &matrix)
+    {
+        if (!symbolic->matches(matrix))
+            throw std::invalid_argument("Matrix pattern differs from the analyzed one");
+        const size_t none = std::numeric_limits<size_t>::max();
+        size_t n = symbolic->n;
+        CSCMatrix<T> columns(matrix);
+
+        pinv.assign(n, none);
+        l_ptr.assign(1, 0);
+        u_ptr.assign(1, 0);
+        l_idx.clear();
+        u_idx.clear();
+        l_val.clear();
+        u_val.clear();
+        l_idx.reserve(symbolic->estimatedNonZeros);
+        l_val.reserve(symbolic->estimatedNonZeros);
+        u_idx.reserve(symbolic->estimatedNonZeros);
+        u_val.reserve(symbolic->estimatedNonZeros);
+
+        std::vector<T> x(n, T(0));
+        std::vector<size_t> mark(n, none), reach, stack, childPos;
+        for (size_t k = 0; k < n; ++k)
+        {
+            size_t col = symbolic->q[k];
+            size_t colBegin = columns.colPtr()[col], colEnd = columns.colPtr()[col + 1];
+
+            // Обход в глубину: reach в обратном топологическом порядке
+            reach.clear();
+            for (size_t p = colBegin; p < colEnd; ++p)
+            {
+                size_t start = columns.rowIdx()[p];
+                if (mark[start] == k)
+                    continue;
+                mark[start] = k;
+                stack.assign(1, start);
+                childPos.assign(1, 0);
+                while (!stack.empty())
+                {
+                    size_t node = stack.back();
+                    size_t j = pinv[node];
+                    bool descended = false;
+                    if (j != none)
+                    {
+                        for (size_t &c = childPos.back(); l_ptr[j] + 1 + c < l_ptr[j + 1]; ++c)
+                        {
+                            size_t child = l_idx[l_ptr[j] + 1 + c];
+                            if (mark[child] != k)
+                            {
+                                mark[child] = k;
+                                ++c;
+                                stack.push_back(child);
+                                childPos.push_back(0);
+                                descended = true;
+                                break;
+                            }
+                        }
+                    }
+                    if (!descended)
+                    {
+                        reach.push_back(node);
+                        stack.pop_back();
+                        childPos.pop_back();
+                    }
+                }
+            }
+
+            // Численная треугольная система L x = A(:, col)
+            for (size_t p = colBegin; p < colEnd; ++p)
+                x[columns.rowIdx()[p]] = columns.getValues()[p];
+            for (size_t r = reach.size(); r-- > 0;)
+            {
+                size_t i = reach[r];
+                size_t j = pinv[i];
+                if (j == none)
+                    continue;
+                for (size_t p = l_ptr[j] + 1; p < l_ptr[j + 1]; ++p)
+                    x[l_idx[p]] -= l_val[p] * x[i];
+            }
+
+            // Выбор ведущего элемента среди ещё не выбранных строк
+            size_t pivotRow = none;
+            double best = 0;
+            for (size_t i : reach)
+            {
+                if (pinv[i] == none && std::abs(static_cast<double>(x[i])) > best)
+                {
+                    best = std::abs(static_cast<double>(x[i]));
+                    pivotRow = i;
+                }
+            }
+            if (pivotRow == none || best == 0)
+                throw std::invalid_argument("Matrix is singular");
+            if (pinv[col] == none && mark[col] == k && std::abs(static_cast<double>(x[col])) >= pivotThreshold * best)
+                pivotRow = col;
+            T pivot = x[pivotRow];
+
+            for (size_t i : reach)
+            {
+                if (pinv[i] != none)
+                {
+                    u_idx.push_back(pinv[i]);
+                    u_val.push_back(x[i]);
+                }
+            }
+            u_idx.push_back(k); // диагональ U — последний элемент столбца
+            u_val.push_back(pivot);
+            u_ptr.push_back(u_idx.size());
+
+            pinv[pivotRow] = k;
+            l_idx.push_back(pivotRow); // единичная диагональ L — первый элемент столбца
+            l_val.push_back(T(1));
+            for (size_t i : reach)
+            {
+                if (pinv[i] == none)
+                {
+                    l_idx.push_back(i);
+                    l_val.push_back(x[i] / pivot);
+                }
+                x[i] = 0;
+            }
+            l_ptr.push_back(l_idx.size());
+        }
+        for (size_t &row : l_idx)
+            row = pinv[row];
+    }
+
+    size_t nonZeros() const { return l_val.size() + u_val.size(); }
+
+    std::vector<T> solve(const std::vector<T> &b) const
+    {
+        size_t n = symbolic->n;
+        if (b.size() != n)
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<T> y(n);
+        for (size_t i = 0; i < n; ++i)
+            y[pinv[i]] = b[i];
+        for (size_t j = 0; j < n; ++j)
+            for (size_t p = l_ptr[j] + 1; p < l_ptr[j + 1]; ++p)
+                y[l_idx[p]] -= l_val[p] * y[j];
+        for (size_t j = n; j-- > 0;)
+        {
+            y[j] /= u_val[u_ptr[j + 1] - 1];
+            for (size_t p = u_ptr[j]; p + 1 < u_ptr[j + 1]; ++p)
+                y[u_idx[p]] -= u_val[p] * y[j];
+        }
+        std::vector<T> x(n);
+        for (size_t k = 0; k < n; ++k)
+            x[symbolic->q[k]] = y[k];
+        return x;
+    }
+
+    std::vector<std::vector<T>> solve(const std::vector<std::vector<T>> &rightHandSides) const
+    {
+        std::vector<std::vector<T>> result;
+        result.reserve(rightHandSides.size());
+        for (const std::vector<T> &b : rightHandSides)
+            result.push_back(solve(b));
+        return result;
+    }
+};
+
+#endif // DIRECT_SOLVER_HPP
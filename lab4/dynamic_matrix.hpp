@@ -0,0 +1,325 @@
+#ifndef DYNAMIC_MATRIX_HPP
+#define DYNAMIC_MATRIX_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "csr_matrix.hpp"
+#include "flat_hash_map.hpp"
+#include "numeric_types.hpp"
+
+// Изменяемая матрица для одновременных обновлений и запросов.
+// Состоит из неизменяемой базы в формате CSR и небольшого буфера изменений:
+// set() дописывает в буфер запись (строка, столбец, новое значение, разность с прежним),
+// а умножение на вектор считает base * x и добавляет разности буфера на лету.
+//
+// Когда в буфере набирается threshold записей, он замораживается и передаётся фоновому
+// потоку, а новые записи идут в свежий буфер. Фоновый поток сливает замороженный буфер
+// с базой в новую CSR-матрицу и атомарно подменяет состояние (база, замороженный буфер,
+// текущий буфер). Читатели берут снимок состояния через std::atomic_load и не ждут
+// ни писателей, ни слияния; старая база освобождается, когда её отпустит последний читатель.
+//
+// Писатели упорядочены мьютексом. Писатель ждёт только если текущий буфер заполнен
+// (2 * threshold записей), а предыдущее слияние ещё не закончилось.
+template <typename T>
+class DynamicMatrix
+{
+private:
+    // Изменение элемента; delta — разность с прежним значением, её добавляет умножение
+    struct Update
+    {
+        size_t row = 0, col = 0;
+        T value = 0, delta = 0;
+    };
+
+    // Буфер фиксированной ёмкости: писатель заполняет запись и затем публикует новый размер,
+    // поэтому читатель видит только полностью записанные записи.
+    // latest — последнее значение по ключу row * cols + col; его читают только писатели
+    // и фоновый поток (после заморозки буфер не меняется).
+    struct DeltaBuffer
+    {
+        std::vector<Update> updates;
+        std::atomic<size_t> published{0};
+        FlatHashMap<T, size_t> latest;
+
+        explicit DeltaBuffer(size_t capacity) : updates(capacity) {}
+
+        size_t size() const { return published.load(std::memory_order_acquire); }
+    };
+
+    struct State
+    {
+        std::shared_ptr<const CSRMatrix<T>> base;
+        std::shared_ptr<const DeltaBuffer> frozen; // сливается с базой фоновым потоком
+        std::shared_ptr<DeltaBuffer> delta;        // сюда пишет set()
+    };
+
+    size_t rows, cols;
+    size_t threshold;
+    std::shared_ptr<const State> state; // доступ только через std::atomic_load / std::atomic_store
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> compactions{0};
+
+    std::mutex writer;
+    std::condition_variable changed;
+    bool stopping = false;
+    std::thread compactor;
+
+    std::shared_ptr<const State> snapshot() const { return std::atomic_load(&state); }
+
+    void publish(std::shared_ptr<const CSRMatrix<T>> base, std::shared_ptr<const DeltaBuffer> frozen,
+                 std::shared_ptr<DeltaBuffer> delta)
+    {
+        std::atomic_store(&state, std::shared_ptr<const State>(
+                                      new State{std::move(base), std::move(frozen), std::move(delta)}));
+        changed.notify_all();
+    }
+
+    // Текущее значение элемента; вызывается под мьютексом писателей
+    T currentValue(const State &current, size_t row, size_t col) const
+    {
+        size_t key = row * cols + col;
+        auto it = current.delta->latest.find(key);
+        if (it != current.delta->latest.end())
+            return it->second;
+        if (current.frozen)
+        {
+            auto frozenIt = current.frozen->latest.find(key);
+            if (frozenIt != current.frozen->latest.end())
+                return frozenIt->second;
+        }
+        return current.base->get(row, col);
+    }
+
+    // Передача текущего буфера фоновому потоку; вызывается под мьютексом писателей
+    void freeze(const State &current)
+    {
+        publish(current.base, current.delta, std::make_shared<DeltaBuffer>(2 * threshold));
+    }
+
+    // Новая база: строки base, в которых элементы из updates (ключ row * cols + col ->
+    // итоговое значение) заменены, добавлены или удалены (нулевое значение)
+    static CSRMatrix<T> applyUpdates(const CSRMatrix<T> &base, const FlatHashMap<T, size_t> &updates)
+    {
+        size_t rows = base.getRows(), cols = base.getCols();
+        std::vector<std::pair<size_t, T>> sorted(updates.begin(), updates.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b)
+                  { return a.first < b.first; });
+        const std::vector<size_t> &ptr = base.rowPtr();
+        const std::vector<size_t> &idx = base.colIdx();
+        const std::vector<T> &val = base.getValues();
+        std::vector<size_t> row_ptr(rows + 1, 0), col_idx;
+        std::vector<T> values;
+        col_idx.reserve(idx.size() + sorted.size());
+        values.reserve(idx.size() + sorted.size());
+        size_t u = 0;
+        for (size_t i = 0; i < rows; ++i)
+        {
+            size_t k = ptr[i];
+            for (; u < sorted.size() && sorted[u].first / cols == i; ++u)
+            {
+                size_t col = sorted[u].first % cols;
+                for (; k < ptr[i + 1] && idx[k] < col; ++k)
+                {
+                    col_idx.push_back(idx[k]);
+                    values.push_back(val[k]);
+                }
+                if (k < ptr[i + 1] && idx[k] == col)
+                    ++k;
+                if (sorted[u].second != 0)
+                {
+                    col_idx.push_back(col);
+                    values.push_back(sorted[u].second);
+                }
+            }
+            for (; k < ptr[i + 1]; ++k)
+            {
+                col_idx.push_back(idx[k]);
+                values.push_back(val[k]);
+            }
+            row_ptr[i + 1] = col_idx.size();
+        }
+        return CSRMatrix<T>(rows, cols, std::move(row_ptr), std::move(col_idx), std::move(values));
+    }
+
+    void compactLoop()
+    {
+        std::unique_lock<std::mutex> lock(writer);
+        while (true)
+        {
+            changed.wait(lock, [&]
+                         { return stopping || snapshot()->frozen; });
+            std::shared_ptr<const State> current = snapshot();
+            if (!current->frozen)
+                return;
+            // Слияние идёт без мьютекса: писатели продолжают заполнять новый буфер
+            lock.unlock();
+            auto base = std::make_shared<const CSRMatrix<T>>(applyUpdates(*current->base, current->frozen->latest));
+            lock.lock();
+            publish(std::move(base), nullptr, snapshot()->delta);
+            compactions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Добавление разностей буфера к результату умножения
+    template <typename V>
+    static void addUpdates(const DeltaBuffer &buffer, const std::vector<V> &vec, std::vector<V> &result)
+    {
+        size_t size = buffer.size();
+        for (size_t k = 0; k < size; ++k)
+        {
+            const Update &update = buffer.updates[k];
+            result[update.row] += static_cast<V>(update.delta) * vec[update.col];
+        }
+    }
+
+    // Последнее значение (row, col) в буфере; false, если элемент в буфере не менялся
+    static bool findUpdate(const DeltaBuffer &buffer, size_t row, size_t col, T &value)
+    {
+        for (size_t k = buffer.size(); k-- > 0;)
+            if (buffer.updates[k].row == row && buffer.updates[k].col == col)
+            {
+                value = buffer.updates[k].value;
+                return true;
+            }
+        return false;
+    }
+
+public:
+    using value_type = T;
+
+    // threshold — число записей буфера, после которого он сливается с базой
+    explicit DynamicMatrix(CSRMatrix<T> base, size_t threshold = 4096)
+        : rows(base.getRows()), cols(base.getCols()), threshold(std::max<size_t>(threshold, 1)), count(base.nonZeros())
+    {
+        publish(std::make_shared<const CSRMatrix<T>>(std::move(base)), nullptr,
+                std::make_shared<DeltaBuffer>(2 * this->threshold));
+        compactor = std::thread([this]
+                                { compactLoop(); });
+    }
+
+    DynamicMatrix(size_t rows, size_t cols, size_t threshold = 4096)
+        : DynamicMatrix(CSRMatrix<T>(rows, cols), threshold) {}
+
+    DynamicMatrix(const DynamicMatrix &) = delete;
+    DynamicMatrix &operator=(const DynamicMatrix &) = delete;
+
+    // Фоновый поток перед завершением сливает уже замороженный буфер
+    ~DynamicMatrix()
+    {
+        {
+            std::lock_guard<std::mutex> lock(writer);
+            stopping = true;
+        }
+        changed.notify_all();
+        compactor.join();
+    }
+
+    size_t getRows() const { return rows; }
+    size_t getCols() const { return cols; }
+    size_t nonZeros() const { return count.load(std::memory_order_relaxed); }
+
+    // Записи, ещё не слитые с базой
+    size_t pendingUpdates() const
+    {
+        std::shared_ptr<const State> current = snapshot();
+        return current->delta->size() + (current->frozen ? current->frozen->size() : 0);
+    }
+
+    // Число завершённых слияний
+    size_t compactionCount() const { return compactions.load(std::memory_order_relaxed); }
+
+    void set(size_t row, size_t col, T value)
+    {
+        if (row >= rows || col >= cols)
+            throw std::out_of_range("Index out of range");
+        if (value == 0)
+            value = 0; // -0 хранится как 0
+        std::unique_lock<std::mutex> lock(writer);
+        std::shared_ptr<const State> current = snapshot();
+        T previous = currentValue(*current, row, col);
+        if (previous == value)
+            return;
+        if (current->delta->size() == current->delta->updates.size())
+        {
+            changed.wait(lock, [&]
+                         { return !snapshot()->frozen; });
+            freeze(*snapshot());
+            current = snapshot();
+        }
+        DeltaBuffer &delta = *current->delta;
+        size_t size = delta.published.load(std::memory_order_relaxed);
+        delta.updates[size] = Update{row, col, value, value - previous};
+        delta.latest[row * cols + col] = value;
+        delta.published.store(size + 1, std::memory_order_release);
+        count.fetch_add(static_cast<size_t>(value != 0) - static_cast<size_t>(previous != 0), std::memory_order_relaxed);
+        if (size + 1 >= threshold && !current->frozen)
+            freeze(*current);
+    }
+
+    // Поиск идёт от последних записей буферов к базе: O(размер буфера + log(длина строки))
+    T get(size_t row, size_t col) const
+    {
+        if (row >= rows || col >= cols)
+            throw std::out_of_range("Index out of range");
+        std::shared_ptr<const State> current = snapshot();
+        T value;
+        if (findUpdate(*current->delta, row, col, value))
+            return value;
+        if (current->frozen && findUpdate(*current->frozen, row, col, value))
+            return value;
+        return current->base->get(row, col);
+    }
+
+    // Умножение на вектор по снимку состояния: base * x плюс разности из буферов
+    template <typename V>
+    std::vector<V> multiply(const std::vector<V> &vec) const
+    {
+        if (cols != vec.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::shared_ptr<const State> current = snapshot();
+        std::vector<V> result = current->base->multiply(vec);
+        if (current->frozen)
+            addUpdates(*current->frozen, vec, result);
+        addUpdates(*current->delta, vec, result);
+        return result;
+    }
+
+    std::vector<T> operator*(const std::vector<T> &vec) const { return multiply(vec); }
+
+    // Слияние всех накопленных записей с базой; возвращается после подмены базы
+    void compact()
+    {
+        std::unique_lock<std::mutex> lock(writer);
+        changed.wait(lock, [&]
+                     { return !snapshot()->frozen; });
+        std::shared_ptr<const State> current = snapshot();
+        if (current->delta->size() == 0)
+            return;
+        freeze(*current);
+        changed.wait(lock, [&]
+                     { return !snapshot()->frozen; });
+    }
+
+    // Копия текущего состояния в формате CSR
+    CSRMatrix<T> toCSR() const
+    {
+        std::shared_ptr<const State> current = snapshot();
+        FlatHashMap<T, size_t> updates;
+        for (const DeltaBuffer *buffer : {current->frozen.get(), static_cast<const DeltaBuffer *>(current->delta.get())})
+            if (buffer)
+                for (size_t k = 0, size = buffer->size(); k < size; ++k)
+                    updates[buffer->updates[k].row * cols + buffer->updates[k].col] = buffer->updates[k].value;
+        return applyUpdates(*current->base, updates);
+    }
+};
+
+#endif // DYNAMIC_MATRIX_HPP
@@ -0,0 +1,233 @@
+#ifndef EXPRESSION_HPP
+#define EXPRESSION_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
+
+// Шаблоны выражений: операторы +, - и умножение на скаляр не вычисляют результат сразу,
+// а возвращают лёгкий объект-описание. Выражение вычисляется одним проходом при
+// присваивании в SparseVector/SparseMatrix или явным вызовом eval(), поэтому
+// в выражении вида a + b * 5 не создаются промежуточные контейнеры.
+//
+// Каждое выражение предоставляет:
+//   get(...)            — значение элемента;
+//   forEachIndex(f)     — обход позиций, где значение может быть ненулевым (возможны повторы);
+//   nonZerosBound()     — верхняя оценка числа ненулевых элементов;
+//   index_type, resource() — тип индексов и источник памяти левого операнда, с которыми
+//                         выражение вычисляется в контейнер.
+// Контейнеры в узлах хранятся по ссылке, поэтому выражение не должно переживать операнды.
+
+// Index — тип хранимых индексов (по умолчанию size_t, см. sparse_vector.hpp)
+template <typename T, typename Index = size_t>
+class SparseVector;
+
+template <typename T, typename Index = size_t>
+class SparseMatrix;
+
+// Листья (контейнеры) хранятся по ссылке, промежуточные узлы — по значению
+template <typename E>
+using ExpressionOperand = typename std::conditional<E::is_leaf, const E &, const E>::type;
+
+// Базовый класс выражений над векторами (CRTP)
+template <typename E>
+class VectorExpression
+{
+public:
+    const E &self() const { return static_cast<const E &>(*this); }
+
+    auto eval() const
+    {
+        return SparseVector<typename E::value_type, typename E::index_type>(self(), self().resource());
+    }
+};
+
+template <typename L, typename R, typename Op>
+class VectorBinary : public VectorExpression<VectorBinary<L, R, Op>>
+{
+private:
+    ExpressionOperand<L> left;
+    ExpressionOperand<R> right;
+
+public:
+    using value_type = typename L::value_type;
+    using index_type = typename L::index_type;
+    static constexpr bool is_leaf = false;
+
+    VectorBinary(const L &left, const R &right) : left(left), right(right)
+    {
+        if (left.getSize() != right.getSize())
+            throw std::invalid_argument("Vector sizes do not match");
+    }
+
+    size_t getSize() const { return left.getSize(); }
+    std::pmr::memory_resource *resource() const { return left.resource(); }
+    value_type get(size_t index) const { return Op::apply(left.get(index), right.get(index)); }
+    size_t nonZerosBound() const { return left.nonZerosBound() + right.nonZerosBound(); }
+
+    template <typename F>
+    void forEachIndex(F f) const
+    {
+        left.forEachIndex(f);
+        right.forEachIndex(f);
+    }
+};
+
+template <typename E>
+class VectorScaled : public VectorExpression<VectorScaled<E>>
+{
+public:
+    using value_type = typename E::value_type;
+    using index_type = typename E::index_type;
+    static constexpr bool is_leaf = false;
+
+private:
+    ExpressionOperand<E> inner;
+    value_type scalar;
+
+public:
+    VectorScaled(const E &inner, value_type scalar) : inner(inner), scalar(scalar) {}
+
+    const E &operand() const { return inner; }
+    value_type factor() const { return scalar; }
+
+    size_t getSize() const { return inner.getSize(); }
+    std::pmr::memory_resource *resource() const { return inner.resource(); }
+    value_type get(size_t index) const { return inner.get(index) * scalar; }
+    size_t nonZerosBound() const { return scalar == 0 ? 0 : inner.nonZerosBound(); }
+
+    template <typename F>
+    void forEachIndex(F f) const
+    {
+        if (scalar != 0)
+            inner.forEachIndex(f);
+    }
+};
+
+// Базовый класс выражений над матрицами (CRTP)
+template <typename E>
+class MatrixExpression
+{
+public:
+    const E &self() const { return static_cast<const E &>(*this); }
+
+    auto eval() const
+    {
+        return SparseMatrix<typename E::value_type, typename E::index_type>(self(), self().resource());
+    }
+};
+
+template <typename L, typename R, typename Op>
+class MatrixBinary : public MatrixExpression<MatrixBinary<L, R, Op>>
+{
+private:
+    ExpressionOperand<L> left;
+    ExpressionOperand<R> right;
+
+public:
+    using value_type = typename L::value_type;
+    using index_type = typename L::index_type;
+    static constexpr bool is_leaf = false;
+
+    MatrixBinary(const L &left, const R &right) : left(left), right(right)
+    {
+        if (left.getRows() != right.getRows() || left.getCols() != right.getCols())
+            throw std::invalid_argument("Matrix sizes do not match");
+    }
+
+    size_t getRows() const { return left.getRows(); }
+    std::pmr::memory_resource *resource() const { return left.resource(); }
+    size_t getCols() const { return left.getCols(); }
+    value_type get(size_t row, size_t col) const { return Op::apply(left.get(row, col), right.get(row, col)); }
+    size_t nonZerosBound() const { return left.nonZerosBound() + right.nonZerosBound(); }
+
+    template <typename F>
+    void forEachIndex(F f) const
+    {
+        left.forEachIndex(f);
+        right.forEachIndex(f);
+    }
+};
+
+template <typename E>
+class MatrixScaled : public MatrixExpression<MatrixScaled<E>>
+{
+public:
+    using value_type = typename E::value_type;
+    using index_type = typename E::index_type;
+    static constexpr bool is_leaf = false;
+
+private:
+    ExpressionOperand<E> inner;
+    value_type scalar;
+
+public:
+    MatrixScaled(const E &inner, value_type scalar) : inner(inner), scalar(scalar) {}
+
+    const E &operand() const { return inner; }
+    value_type factor() const { return scalar; }
+
+    size_t getRows() const { return inner.getRows(); }
+    std::pmr::memory_resource *resource() const { return inner.resource(); }
+    size_t getCols() const { return inner.getCols(); }
+    value_type get(size_t row, size_t col) const { return inner.get(row, col) * scalar; }
+    size_t nonZerosBound() const { return scalar == 0 ? 0 : inner.nonZerosBound(); }
+
+    template <typename F>
+    void forEachIndex(F f) const
+    {
+        if (scalar != 0)
+            inner.forEachIndex(f);
+    }
+};
+
+struct AddOp
+{
+    template <typename T>
+    static T apply(T a, T b) { return a + b; }
+};
+
+struct SubtractOp
+{
+    template <typename T>
+    static T apply(T a, T b) { return a - b; }
+};
+
+template <typename L, typename R>
+VectorBinary<L, R, AddOp> operator+(const VectorExpression<L> &left, const VectorExpression<R> &right)
+{
+    return VectorBinary<L, R, AddOp>(left.self(), right.self());
+}
+
+template <typename L, typename R>
+VectorBinary<L, R, SubtractOp> operator-(const VectorExpression<L> &left, const VectorExpression<R> &right)
+{
+    return VectorBinary<L, R, SubtractOp>(left.self(), right.self());
+}
+
+template <typename E>
+VectorScaled<E> operator*(const VectorExpression<E> &expr, typename E::value_type scalar)
+{
+    return VectorScaled<E>(expr.self(), scalar);
+}
+
+template <typename L, typename R>
+MatrixBinary<L, R, AddOp> operator+(const MatrixExpression<L> &left, const MatrixExpression<R> &right)
+{
+    return MatrixBinary<L, R, AddOp>(left.self(), right.self());
+}
+
+template <typename L, typename R>
+MatrixBinary<L, R, SubtractOp> operator-(const MatrixExpression<L> &left, const MatrixExpression<R> &right)
+{
+    return MatrixBinary<L, R, SubtractOp>(left.self(), right.self());
+}
+
+template <typename E>
+MatrixScaled<E> operator*(const MatrixExpression<E> &expr, typename E::value_type scalar)
+{
+    return MatrixScaled<E>(expr.self(), scalar);
+}
+
+#endif // EXPRESSION_HPP
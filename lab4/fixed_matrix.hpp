@@ -0,0 +1,566 @@
+#ifndef FIXED_MATRIX_HPP
+#define FIXED_MATRIX_HPP
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "numeric_types.hpp"
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+
+// Малые матрицы и векторы с размерами, известными при компиляции: FixedMatrix<T, R, C, Pattern>
+// и FixedVector<T, N, Pattern>. Элементы хранятся в std::array внутри объекта (без кучи и
+// хеш-таблиц), все циклы разворачиваются при компиляции, операции — constexpr.
+//
+// Pattern — портрет: бит row * C + col (у вектора — бит index) отмечает позицию, которая
+// хранится явно; остальные позиции всегда нулевые и в вычислениях не участвуют. По умолчанию
+// хранятся все позиции. Портрет результата (сумма, произведение, транспонирование) тоже
+// вычисляется при компиляции. Позиций не больше 64 (матрицы до 8 x 8).
+//
+//   constexpr FixedMatrix<double, 2, 2> a{4, 7,
+//                                         2, 6};
+//   constexpr auto b = a.inverse();                  // вычисляется при компиляции
+//   FixedMatrix<double, 3, 3, diagonalPattern(3)> d; // хранит только 3 элемента
+
+// Формулы, которые пакеты малых матриц (matrix_batch.hpp) вызывают в цикле по пакету, должны
+// подставляться в цикл: иначе GCC с -O2 оставляет вызов формул 4x4, и цикл не векторизуется
+#if defined(__GNUC__) || defined(__clang__)
+#define FIXED_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define FIXED_ALWAYS_INLINE inline
+#endif
+
+// Все позиции матрицы rows x cols
+constexpr uint64_t fullPattern(size_t rows, size_t cols)
+{
+    return rows * cols >= 64 ? ~uint64_t(0) : (uint64_t(1) << (rows * cols)) - 1;
+}
+
+// Главная диагональ матрицы n x n
+constexpr uint64_t diagonalPattern(size_t n)
+{
+    uint64_t pattern = 0;
+    for (size_t i = 0; i < n; ++i)
+        pattern |= uint64_t(1) << (i * n + i);
+    return pattern;
+}
+
+// Позиция (row, col) матрицы с cols столбцами; портреты собираются через |
+constexpr uint64_t patternEntry(size_t row, size_t col, size_t cols)
+{
+    return uint64_t(1) << (row * cols + col);
+}
+
+namespace fixed_detail
+{
+    constexpr size_t countBits(uint64_t pattern)
+    {
+        size_t count = 0;
+        for (; pattern; pattern &= pattern - 1)
+            ++count;
+        return count;
+    }
+
+    constexpr bool hasBit(uint64_t pattern, size_t position)
+    {
+        return position < 64 && ((pattern >> position) & 1);
+    }
+
+    // Номер хранимого элемента для позиции: число отмеченных позиций перед ней
+    constexpr size_t slotOf(uint64_t pattern, size_t position)
+    {
+        return countBits(position == 0 ? 0 : pattern & (~uint64_t(0) >> (64 - position)));
+    }
+
+    constexpr uint64_t transposePattern(uint64_t pattern, size_t rows, size_t cols)
+    {
+        uint64_t result = 0;
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j)
+                if (hasBit(pattern, i * cols + j))
+                    result |= patternEntry(j, i, rows);
+        return result;
+    }
+
+    // Портрет A * B (A — rows x inner, B — inner x cols)
+    constexpr uint64_t productPattern(uint64_t a, uint64_t b, size_t rows, size_t inner, size_t cols)
+    {
+        uint64_t result = 0;
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j)
+                for (size_t k = 0; k < inner; ++k)
+                    if (hasBit(a, i * inner + k) && hasBit(b, k * cols + j))
+                        result |= patternEntry(i, j, cols);
+        return result;
+    }
+
+    // Присоединённая матрица n x n (по строкам, n <= 4) по явным формулам; возвращает определитель.
+    // Обратная матрица — adj / det; без ветвлений, поэтому формулы векторизуются по пакету матриц
+    template <typename T, size_t N>
+    FIXED_ALWAYS_INLINE constexpr T adjugate(const std::array<T, N * N> &m, std::array<T, N * N> &r)
+    {
+        if constexpr (N == 1)
+        {
+            r[0] = T(1);
+            return m[0];
+        }
+        else if constexpr (N == 2)
+        {
+            r = {m[3], -m[1], -m[2], m[0]};
+            return m[0] * m[3] - m[1] * m[2];
+        }
+        else if constexpr (N == 3)
+        {
+            T c0 = m[4] * m[8] - m[5] * m[7], c1 = m[5] * m[6] - m[3] * m[8], c2 = m[3] * m[7] - m[4] * m[6];
+            r = {c0, m[2] * m[7] - m[1] * m[8], m[1] * m[5] - m[2] * m[4],
+                 c1, m[0] * m[8] - m[2] * m[6], m[2] * m[3] - m[0] * m[5],
+                 c2, m[1] * m[6] - m[0] * m[7], m[0] * m[4] - m[1] * m[3]};
+            return m[0] * c0 + m[1] * c1 + m[2] * c2;
+        }
+        else
+        {
+            static_assert(N == 4, "Adjugate is implemented for matrices up to 4x4");
+            // Миноры 2x2 двух верхних (s) и двух нижних (c) строк
+            T s0 = m[0] * m[5] - m[4] * m[1], s1 = m[0] * m[6] - m[4] * m[2], s2 = m[0] * m[7] - m[4] * m[3];
+            T s3 = m[1] * m[6] - m[5] * m[2], s4 = m[1] * m[7] - m[5] * m[3], s5 = m[2] * m[7] - m[6] * m[3];
+            T c5 = m[10] * m[15] - m[14] * m[11], c4 = m[9] * m[15] - m[13] * m[11], c3 = m[9] * m[14] - m[13] * m[10];
+            T c2 = m[8] * m[15] - m[12] * m[11], c1 = m[8] * m[14] - m[12] * m[10], c0 = m[8] * m[13] - m[12] * m[9];
+            r = {m[5] * c5 - m[6] * c4 + m[7] * c3, -m[1] * c5 + m[2] * c4 - m[3] * c3,
+                 m[13] * s5 - m[14] * s4 + m[15] * s3, -m[9] * s5 + m[10] * s4 - m[11] * s3,
+                 -m[4] * c5 + m[6] * c2 - m[7] * c1, m[0] * c5 - m[2] * c2 + m[3] * c1,
+                 -m[12] * s5 + m[14] * s2 - m[15] * s1, m[8] * s5 - m[10] * s2 + m[11] * s1,
+                 m[4] * c4 - m[5] * c2 + m[7] * c0, -m[0] * c4 + m[1] * c2 - m[3] * c0,
+                 m[12] * s4 - m[13] * s2 + m[15] * s0, -m[8] * s4 + m[9] * s2 - m[11] * s0,
+                 -m[4] * c3 + m[5] * c1 - m[6] * c0, m[0] * c3 - m[1] * c1 + m[2] * c0,
+                 -m[12] * s3 + m[13] * s1 - m[14] * s0, m[8] * s3 - m[9] * s1 + m[10] * s0};
+            return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        }
+    }
+
+    // f(std::integral_constant<size_t, I>) для I = 0 .. N - 1 без цикла
+    template <typename F, size_t... I>
+    constexpr void unroll(F &&f, std::index_sequence<I...>)
+    {
+        (f(std::integral_constant<size_t, I>()), ...);
+    }
+
+    template <size_t N, typename F>
+    constexpr void unroll(F &&f)
+    {
+        unroll(f, std::make_index_sequence<N>());
+    }
+}
+
+template <typename T, size_t N, uint64_t Pattern = fullPattern(N, 1)>
+class FixedVector
+{
+private:
+    static_assert(N <= 64, "FixedVector supports at most 64 entries");
+
+    template <typename, size_t, uint64_t>
+    friend class FixedVector;
+    template <typename, size_t, size_t, uint64_t>
+    friend class FixedMatrix;
+
+    std::array<T, fixed_detail::countBits(Pattern)> values{};
+
+    static constexpr size_t slot(size_t index) { return fixed_detail::slotOf(Pattern, index); }
+
+    // Поэлементная операция с вектором другого портрета; портрет результата — объединение
+    template <uint64_t Other, typename F>
+    constexpr FixedVector<T, N, Pattern | Other> combine(const FixedVector<T, N, Other> &other, F f) const
+    {
+        FixedVector<T, N, Pattern | Other> result;
+        fixed_detail::unroll<N>([&](auto i)
+                                {
+            constexpr size_t I = decltype(i)::value;
+            if constexpr (stores(I) || FixedVector<T, N, Other>::stores(I))
+                result.values[result.slot(I)] = f(get(I), other.get(I)); });
+        return result;
+    }
+
+public:
+    using value_type = T;
+
+    static constexpr size_t getSize() { return N; }
+
+    // Число явно хранимых позиций
+    static constexpr size_t storedEntries() { return fixed_detail::countBits(Pattern); }
+
+    static constexpr bool stores(size_t index) { return fixed_detail::hasBit(Pattern, index); }
+
+    constexpr FixedVector() = default;
+
+    // Все N значений по порядку; ненулевое значение вне портрета — ошибка
+    constexpr FixedVector(std::initializer_list<T> dense)
+    {
+        if (dense.size() != N)
+            throw std::invalid_argument("Initializer size does not match the vector size");
+        size_t index = 0;
+        for (T value : dense)
+            set(index++, value);
+    }
+
+    constexpr T get(size_t index) const
+    {
+        if (index >= N)
+            throw std::out_of_range("Index out of range");
+        return stores(index) ? values[slot(index)] : T(0);
+    }
+
+    constexpr void set(size_t index, T value)
+    {
+        if (index >= N)
+            throw std::out_of_range("Index out of range");
+        if (stores(index))
+            values[slot(index)] = value;
+        else if (value != 0)
+            throw std::invalid_argument("Position is outside the sparsity pattern");
+    }
+
+    constexpr size_t nonZeros() const
+    {
+        size_t count = 0;
+        for (T value : values)
+            count += value != 0;
+        return count;
+    }
+
+    template <uint64_t Other>
+    constexpr FixedVector<T, N, Pattern | Other> operator+(const FixedVector<T, N, Other> &other) const
+    {
+        return combine(other, [](T a, T b)
+                       { return a + b; });
+    }
+
+    template <uint64_t Other>
+    constexpr FixedVector<T, N, Pattern | Other> operator-(const FixedVector<T, N, Other> &other) const
+    {
+        return combine(other, [](T a, T b)
+                       { return a - b; });
+    }
+
+    constexpr FixedVector operator*(T scalar) const
+    {
+        FixedVector result;
+        for (size_t k = 0; k < values.size(); ++k)
+            result.values[k] = values[k] * scalar;
+        return result;
+    }
+
+    // Скалярное произведение по общим позициям портретов
+    template <uint64_t Other>
+    constexpr T dot(const FixedVector<T, N, Other> &other) const
+    {
+        Accumulator<T> sum = 0;
+        fixed_detail::unroll<N>([&](auto i)
+                                {
+            constexpr size_t I = decltype(i)::value;
+            if constexpr (stores(I) && FixedVector<T, N, Other>::stores(I))
+                sum += static_cast<Accumulator<T>>(values[slot(I)]) * other.values[other.slot(I)]; });
+        return static_cast<T>(sum);
+    }
+
+    template <uint64_t Other>
+    constexpr bool operator==(const FixedVector<T, N, Other> &other) const
+    {
+        for (size_t i = 0; i < N; ++i)
+            if (get(i) != other.get(i))
+                return false;
+        return true;
+    }
+
+    template <uint64_t Other>
+    constexpr bool operator!=(const FixedVector<T, N, Other> &other) const { return !(*this == other); }
+
+    // f(index, value) для ненулевых элементов
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (size_t i = 0; i < N; ++i)
+            if (stores(i) && values[slot(i)] != 0)
+                f(i, values[slot(i)]);
+    }
+
+    SparseVector<T> toSparseVector() const
+    {
+        SparseVector<T> result(N);
+        forEach([&](size_t index, T value)
+                { result.set(index, value); });
+        return result;
+    }
+
+    template <typename Index>
+    static FixedVector fromSparseVector(const SparseVector<T, Index> &vec)
+    {
+        if (vec.getSize() != N)
+            throw std::invalid_argument("Vector sizes do not match");
+        FixedVector result;
+        vec.forEach([&](size_t index, T value)
+                    { result.set(index, value); });
+        return result;
+    }
+
+    void print() const
+    {
+        for (size_t i = 0; i < N; ++i)
+            std::cout << get(i) << " ";
+        std::cout << "\n";
+    }
+};
+
+template <typename T, size_t R, size_t C, uint64_t Pattern = fullPattern(R, C)>
+class FixedMatrix
+{
+private:
+    static_assert(R * C <= 64, "FixedMatrix supports at most 64 entries");
+
+    template <typename, size_t, size_t, uint64_t>
+    friend class FixedMatrix;
+
+    std::array<T, fixed_detail::countBits(Pattern)> values{};
+
+    static constexpr size_t slot(size_t row, size_t col) { return fixed_detail::slotOf(Pattern, row * C + col); }
+
+    template <uint64_t Other, typename F>
+    constexpr FixedMatrix<T, R, C, Pattern | Other> combine(const FixedMatrix<T, R, C, Other> &other, F f) const
+    {
+        FixedMatrix<T, R, C, Pattern | Other> result;
+        fixed_detail::unroll<R * C>([&](auto p)
+                                    {
+            constexpr size_t I = decltype(p)::value / C, J = decltype(p)::value % C;
+            if constexpr (stores(I, J) || FixedMatrix<T, R, C, Other>::stores(I, J))
+                result.values[result.slot(I, J)] = f(get(I, J), other.get(I, J)); });
+        return result;
+    }
+
+    // Элементы в виде плотного массива по строкам; позиции вне портрета — нулевые константы
+    constexpr std::array<T, R * C> dense() const
+    {
+        std::array<T, R * C> result{};
+        fixed_detail::unroll<R * C>([&](auto p)
+                                    {
+            constexpr size_t I = decltype(p)::value / C, J = decltype(p)::value % C;
+            if constexpr (stores(I, J))
+                result[I * C + J] = values[slot(I, J)]; });
+        return result;
+    }
+
+    static constexpr void checkDeterminant(T det)
+    {
+        if (det == 0)
+            throw std::invalid_argument("Matrix is singular and cannot be inverted");
+    }
+
+public:
+    using value_type = T;
+
+    static constexpr size_t getRows() { return R; }
+    static constexpr size_t getCols() { return C; }
+    static constexpr size_t storedEntries() { return fixed_detail::countBits(Pattern); }
+
+    static constexpr bool stores(size_t row, size_t col) { return fixed_detail::hasBit(Pattern, row * C + col); }
+
+    constexpr FixedMatrix() = default;
+
+    // Все R * C значений по строкам; ненулевое значение вне портрета — ошибка
+    constexpr FixedMatrix(std::initializer_list<T> dense)
+    {
+        if (dense.size() != R * C)
+            throw std::invalid_argument("Initializer size does not match the matrix size");
+        size_t position = 0;
+        for (T value : dense)
+        {
+            set(position / C, position % C, value);
+            ++position;
+        }
+    }
+
+    static constexpr FixedMatrix identity()
+    {
+        static_assert(R == C, "Identity matrix must be square");
+        FixedMatrix result;
+        for (size_t i = 0; i < R; ++i)
+            result.set(i, i, T(1));
+        return result;
+    }
+
+    constexpr T get(size_t row, size_t col) const
+    {
+        if (row >= R || col >= C)
+            throw std::out_of_range("Index out of range");
+        return stores(row, col) ? values[slot(row, col)] : T(0);
+    }
+
+    constexpr void set(size_t row, size_t col, T value)
+    {
+        if (row >= R || col >= C)
+            throw std::out_of_range("Index out of range");
+        if (stores(row, col))
+            values[slot(row, col)] = value;
+        else if (value != 0)
+            throw std::invalid_argument("Position is outside the sparsity pattern");
+    }
+
+    constexpr size_t nonZeros() const
+    {
+        size_t count = 0;
+        for (T value : values)
+            count += value != 0;
+        return count;
+    }
+
+    template <uint64_t Other>
+    constexpr FixedMatrix<T, R, C, Pattern | Other> operator+(const FixedMatrix<T, R, C, Other> &other) const
+    {
+        return combine(other, [](T a, T b)
+                       { return a + b; });
+    }
+
+    template <uint64_t Other>
+    constexpr FixedMatrix<T, R, C, Pattern | Other> operator-(const FixedMatrix<T, R, C, Other> &other) const
+    {
+        return combine(other, [](T a, T b)
+                       { return a - b; });
+    }
+
+    constexpr FixedMatrix operator*(T scalar) const
+    {
+        FixedMatrix result;
+        for (size_t k = 0; k < values.size(); ++k)
+            result.values[k] = values[k] * scalar;
+        return result;
+    }
+
+    constexpr FixedMatrix<T, C, R, fixed_detail::transposePattern(Pattern, R, C)> transpose() const
+    {
+        FixedMatrix<T, C, R, fixed_detail::transposePattern(Pattern, R, C)> result;
+        fixed_detail::unroll<R * C>([&](auto p)
+                                    {
+            constexpr size_t I = decltype(p)::value / C, J = decltype(p)::value % C;
+            if constexpr (stores(I, J))
+                result.values[result.slot(J, I)] = values[slot(I, J)]; });
+        return result;
+    }
+
+    // Произведение: суммируются только пары позиций, хранимые в обоих портретах
+    template <size_t K, uint64_t Other>
+    constexpr FixedMatrix<T, R, K, fixed_detail::productPattern(Pattern, Other, R, C, K)>
+    operator*(const FixedMatrix<T, C, K, Other> &other) const
+    {
+        using Right = FixedMatrix<T, C, K, Other>;
+        using Result = FixedMatrix<T, R, K, fixed_detail::productPattern(Pattern, Other, R, C, K)>;
+        Result result;
+        fixed_detail::unroll<R * K>([&](auto p)
+                                    {
+            constexpr size_t I = decltype(p)::value / K, J = decltype(p)::value % K;
+            if constexpr (Result::stores(I, J))
+            {
+                Accumulator<T> sum = 0;
+                fixed_detail::unroll<C>([&](auto k)
+                                        {
+                    constexpr size_t L = decltype(k)::value;
+                    if constexpr (stores(I, L) && Right::stores(L, J))
+                        sum += static_cast<Accumulator<T>>(values[slot(I, L)]) * other.values[Right::slot(L, J)]; });
+                result.values[result.slot(I, J)] = static_cast<T>(sum);
+            } });
+        return result;
+    }
+
+    template <uint64_t Other>
+    constexpr FixedVector<T, R> operator*(const FixedVector<T, C, Other> &vec) const
+    {
+        using Vector = FixedVector<T, C, Other>;
+        FixedVector<T, R> result;
+        fixed_detail::unroll<R>([&](auto i)
+                                {
+            constexpr size_t I = decltype(i)::value;
+            Accumulator<T> sum = 0;
+            fixed_detail::unroll<C>([&](auto k)
+                                    {
+                constexpr size_t L = decltype(k)::value;
+                if constexpr (stores(I, L) && Vector::stores(L))
+                    sum += static_cast<Accumulator<T>>(values[slot(I, L)]) * vec.values[Vector::slot(L)]; });
+            result.values[I] = static_cast<T>(sum); });
+        return result;
+    }
+
+    // Определитель 1x1 - 4x4 по явным формулам (вычисление дополнений компилятор отбрасывает)
+    constexpr T determinant() const
+    {
+        static_assert(R == C && R >= 1 && R <= 4, "Determinant is implemented for square matrices up to 4x4");
+        std::array<T, R * C> unused{};
+        return fixed_detail::adjugate<T, R>(dense(), unused);
+    }
+
+    // Обратная матрица 1x1 - 4x4 через присоединённую матрицу; портрет результата полный
+    constexpr FixedMatrix<T, R, C> inverse() const
+    {
+        static_assert(R == C && R >= 1 && R <= 4, "Inverse is implemented for square matrices up to 4x4");
+        FixedMatrix<T, R, C> inv;
+        T det = fixed_detail::adjugate<T, R>(dense(), inv.values);
+        checkDeterminant(det);
+        for (T &value : inv.values)
+            value /= det;
+        return inv;
+    }
+
+    template <uint64_t Other>
+    constexpr bool operator==(const FixedMatrix<T, R, C, Other> &other) const
+    {
+        for (size_t i = 0; i < R; ++i)
+            for (size_t j = 0; j < C; ++j)
+                if (get(i, j) != other.get(i, j))
+                    return false;
+        return true;
+    }
+
+    template <uint64_t Other>
+    constexpr bool operator!=(const FixedMatrix<T, R, C, Other> &other) const { return !(*this == other); }
+
+    // f(row, col, value) для ненулевых элементов
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (size_t i = 0; i < R; ++i)
+            for (size_t j = 0; j < C; ++j)
+                if (stores(i, j) && values[slot(i, j)] != 0)
+                    f(i, j, values[slot(i, j)]);
+    }
+
+    SparseMatrix<T> toSparseMatrix() const
+    {
+        SparseMatrix<T> result(R, C);
+        forEach([&](size_t row, size_t col, T value)
+                { result.set(row, col, value); });
+        return result;
+    }
+
+    template <typename Index>
+    static FixedMatrix fromSparseMatrix(const SparseMatrix<T, Index> &matrix)
+    {
+        if (matrix.getRows() != R || matrix.getCols() != C)
+            throw std::invalid_argument("Matrix dimensions do not match");
+        FixedMatrix result;
+        matrix.forEach([&](size_t row, size_t col, T value)
+                       { result.set(row, col, value); });
+        return result;
+    }
+
+    void print() const
+    {
+        for (size_t i = 0; i < R; ++i)
+        {
+            for (size_t j = 0; j < C; ++j)
+                std::cout << get(i, j) << " ";
+            std::cout << "\n";
+        }
+    }
+};
+
+#endif // FIXED_MATRIX_HPP
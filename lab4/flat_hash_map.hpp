@@ -0,0 +1,460 @@
+#ifndef FLAT_HASH_MAP_HPP
+#define FLAT_HASH_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory_resource>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#define FLAT_HASH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#include "instrumentation.hpp"
+
+// Хеш-таблица с открытой адресацией для целочисленных ключей (хранилище SparseVector
+// и строк SparseMatrix в формате StorageFormat::Hash).
+//
+// Пары ключ-значение лежат в одном массиве без узлов и указателей; рядом хранится массив
+// управляющих байтов: Empty или 7 бит хеша ключа. Пробирование линейное, байты сравниваются
+// группами по 16 одной SSE2-инструкцией, поэтому ключ сравнивается только в слотах с совпавшими
+// битами хеша. Удаление сдвигает следующие элементы цепочки назад (без надгробий), так что поиск
+// всегда останавливается на первом пустом слоте, а таблица не деградирует при частых set(i, 0).
+// Память выделяется одним блоком из std::pmr::memory_resource.
+template <typename T, typename Key = size_t>
+class FlatHashMap
+{
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = size_t;
+    using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+
+private:
+    static constexpr size_t Group = 16;     // слотов в группе управляющих байтов
+    static constexpr uint8_t Empty = 0x80;  // у занятых слотов старший бит сброшен
+    static constexpr size_t MinCapacity = Group;
+
+    allocator_type allocator;
+    value_type *slots = nullptr;
+    uint8_t *control = nullptr; // capacity + Group - 1 байтов; хвост повторяет первые Group - 1
+    size_t capacity = 0;        // 0 или степень двойки не меньше MinCapacity
+    size_t used = 0;
+    unsigned shift = 64;        // 64 - log2(capacity)
+
+    static uint64_t hash(Key key) { return static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull; }
+    size_t home(uint64_t h) const { return static_cast<size_t>(h >> shift); }
+    static uint8_t fingerprint(uint64_t h) { return static_cast<uint8_t>(h >> 32) & 0x7F; }
+
+    static size_t blockBytes(size_t slotCount)
+    {
+        return slotCount * sizeof(value_type) + slotCount + Group - 1;
+    }
+
+    void setControl(size_t slot, uint8_t value)
+    {
+        control[slot] = value;
+        if (slot < Group - 1)
+            control[capacity + slot] = value;
+    }
+
+    // Биты совпадений с fingerprint и пустых слотов в группе из 16 слотов, начиная с position
+    struct GroupMasks
+    {
+        uint32_t match;
+        uint32_t empty;
+    };
+
+    GroupMasks probeGroup(size_t position, uint8_t h2) const
+    {
+#ifdef FLAT_HASH_SSE2
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(control + position));
+        uint32_t match = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(h2)))));
+        uint32_t empty = static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+        return {match, empty};
+#else
+        GroupMasks masks{0, 0};
+        for (size_t k = 0; k < Group; ++k)
+        {
+            masks.match |= static_cast<uint32_t>(control[position + k] == h2) << k;
+            masks.empty |= static_cast<uint32_t>(control[position + k] == Empty) << k;
+        }
+        return masks;
+#endif
+    }
+
+    // Слот с ключом или, если ключа нет, первый пустой слот цепочки (found = false)
+    size_t locate(Key key, bool &found) const
+    {
+        uint64_t h = hash(key);
+        uint8_t h2 = fingerprint(h);
+        size_t mask = capacity - 1;
+        for (size_t position = home(h);; position = (position + Group) & mask)
+        {
+            GroupMasks masks = probeGroup(position, h2);
+            SPARSE_HASH_PROBE();
+            // Элементы после первого пустого слота принадлежат другим цепочкам
+            uint32_t candidates = masks.empty ? masks.match & ((masks.empty & (0u - masks.empty)) - 1) : masks.match;
+            while (candidates)
+            {
+                size_t slot = (position + __builtin_ctz(candidates)) & mask;
+                if (slots[slot].first == key)
+                {
+                    found = true;
+                    return slot;
+                }
+                candidates &= candidates - 1;
+            }
+            if (masks.empty)
+            {
+                found = false;
+                return (position + __builtin_ctz(masks.empty)) & mask;
+            }
+        }
+    }
+
+    void allocate(size_t slotCount)
+    {
+        capacity = slotCount;
+        shift = 64 - static_cast<unsigned>(__builtin_ctzll(slotCount));
+        void *block = allocator.resource()->allocate(blockBytes(slotCount), alignof(value_type));
+        slots = static_cast<value_type *>(block);
+        control = reinterpret_cast<uint8_t *>(slots + slotCount);
+        std::memset(control, Empty, slotCount + Group - 1);
+    }
+
+    void release()
+    {
+        if (!slots)
+            return;
+        for (size_t slot = 0; slot < capacity; ++slot)
+            if (control[slot] != Empty)
+                slots[slot].~value_type();
+        allocator.resource()->deallocate(slots, blockBytes(capacity), alignof(value_type));
+        slots = nullptr;
+        control = nullptr;
+        capacity = 0;
+        used = 0;
+        shift = 64;
+    }
+
+    // Перенос всех элементов в таблицу из slotCount слотов
+    void rehash(size_t slotCount)
+    {
+        SPARSE_HASH_REHASH();
+        value_type *oldSlots = slots;
+        uint8_t *oldControl = control;
+        size_t oldCapacity = capacity;
+        allocate(slotCount);
+        for (size_t slot = 0; slot < oldCapacity; ++slot)
+            if (oldControl[slot] != Empty)
+            {
+                uint64_t h = hash(oldSlots[slot].first);
+                size_t target = home(h);
+                while (control[target] != Empty)
+                    target = (target + 1) & (capacity - 1);
+                allocator.construct(slots + target, std::move(oldSlots[slot]));
+                oldSlots[slot].~value_type();
+                setControl(target, fingerprint(h));
+            }
+        if (oldSlots)
+            allocator.resource()->deallocate(oldSlots, blockBytes(oldCapacity), alignof(value_type));
+    }
+
+    // Загрузка не больше 7/8: в каждой цепочке остаётся пустой слот, и поиск конечен
+    static size_t capacityFor(size_t elements)
+    {
+        size_t slotCount = MinCapacity;
+        while (slotCount - slotCount / 8 < elements)
+            slotCount *= 2;
+        return slotCount;
+    }
+
+    void growFor(size_t elements)
+    {
+        if (elements > capacity - capacity / 8)
+            rehash(capacityFor(elements));
+    }
+
+    // Удаление элемента слота со сдвигом назад следующих элементов цепочки,
+    // которые могут стоять ближе к своему начальному слоту
+    void eraseSlot(size_t slot)
+    {
+        size_t mask = capacity - 1;
+        slots[slot].~value_type();
+        for (size_t next = (slot + 1) & mask; control[next] != Empty; next = (next + 1) & mask)
+        {
+            size_t start = home(hash(slots[next].first));
+            if (((next - start) & mask) >= ((next - slot) & mask))
+            {
+                allocator.construct(slots + slot, std::move(slots[next]));
+                slots[next].~value_type();
+                setControl(slot, control[next]);
+                slot = next;
+            }
+        }
+        setControl(slot, Empty);
+        --used;
+    }
+
+    template <typename... Args>
+    std::pair<size_t, bool> emplaceSlot(Key key, Args &&...args)
+    {
+        bool found = false;
+        size_t slot = capacity ? locate(key, found) : 0;
+        if (found)
+            return {slot, false};
+        if (used + 1 > capacity - capacity / 8)
+        {
+            growFor(used + 1);
+            slot = locate(key, found);
+        }
+        allocator.construct(slots + slot, std::piecewise_construct, std::forward_as_tuple(key),
+                            std::forward_as_tuple(std::forward<Args>(args)...));
+        setControl(slot, fingerprint(hash(key)));
+        ++used;
+        return {slot, true};
+    }
+
+    void copyFrom(const FlatHashMap &other)
+    {
+        if (other.used == 0)
+            return;
+        allocate(other.capacity);
+        for (size_t slot = 0; slot < capacity; ++slot)
+            if (other.control[slot] != Empty)
+                allocator.construct(slots + slot, other.slots[slot]);
+        std::memcpy(control, other.control, capacity + Group - 1);
+        used = other.used;
+    }
+
+    template <bool Const>
+    class BasicIterator
+    {
+    private:
+        friend class FlatHashMap;
+        friend class BasicIterator<!Const>;
+        using Map = std::conditional_t<Const, const FlatHashMap, FlatHashMap>;
+        Map *map;
+        size_t slot;
+
+        void skipEmpty()
+        {
+            while (slot < map->capacity && map->control[slot] == Empty)
+                ++slot;
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const value_type &, value_type &>;
+        using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+
+        BasicIterator(Map *map, size_t slot) : map(map), slot(slot) { skipEmpty(); }
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        BasicIterator(const BasicIterator<false> &other) : map(other.map), slot(other.slot) {}
+
+        reference operator*() const { return map->slots[slot]; }
+        pointer operator->() const { return map->slots + slot; }
+        BasicIterator &operator++()
+        {
+            ++slot;
+            skipEmpty();
+            return *this;
+        }
+        BasicIterator operator++(int)
+        {
+            BasicIterator copy = *this;
+            ++*this;
+            return copy;
+        }
+        bool operator==(const BasicIterator &other) const { return slot == other.slot; }
+        bool operator!=(const BasicIterator &other) const { return slot != other.slot; }
+    };
+
+public:
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    FlatHashMap() : FlatHashMap(allocator_type()) {}
+    explicit FlatHashMap(const allocator_type &allocator) : allocator(allocator) {}
+    explicit FlatHashMap(std::pmr::memory_resource *resource) : allocator(resource) {}
+
+    // Копия использует источник памяти оригинала
+    FlatHashMap(const FlatHashMap &other) : FlatHashMap(other, other.allocator) {}
+    FlatHashMap(const FlatHashMap &other, const allocator_type &allocator) : allocator(allocator) { copyFrom(other); }
+
+    FlatHashMap(FlatHashMap &&other) noexcept
+        : allocator(other.allocator), slots(other.slots), control(other.control), capacity(other.capacity),
+          used(other.used), shift(other.shift)
+    {
+        other.slots = nullptr;
+        other.control = nullptr;
+        other.capacity = 0;
+        other.used = 0;
+        other.shift = 64;
+    }
+
+    FlatHashMap(FlatHashMap &&other, const allocator_type &allocator) : allocator(allocator)
+    {
+        if (allocator == other.allocator)
+            swap(other);
+        else
+            copyFrom(other);
+    }
+
+    // Присваивание, как у контейнеров std::pmr, не меняет источник памяти
+    FlatHashMap &operator=(const FlatHashMap &other)
+    {
+        if (this != &other)
+        {
+            release();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    FlatHashMap &operator=(FlatHashMap &&other)
+    {
+        if (this == &other)
+            return *this;
+        release();
+        if (allocator == other.allocator)
+            swap(other);
+        else
+            copyFrom(other);
+        return *this;
+    }
+
+    ~FlatHashMap() { release(); }
+
+    void swap(FlatHashMap &other) noexcept
+    {
+        std::swap(slots, other.slots);
+        std::swap(control, other.control);
+        std::swap(capacity, other.capacity);
+        std::swap(used, other.used);
+        std::swap(shift, other.shift);
+    }
+
+    allocator_type get_allocator() const { return allocator; }
+
+    size_t size() const { return used; }
+    bool empty() const { return used == 0; }
+    size_t bucket_count() const { return capacity; }
+
+    // Байты, выделенные таблицей (без памяти, принадлежащей самим значениям)
+    size_t memoryUsage() const { return capacity ? blockBytes(capacity) : 0; }
+
+    void reserve(size_t elements)
+    {
+        if (elements)
+            growFor(elements);
+    }
+
+    // Удаление всех элементов; блок памяти сохраняется для повторного заполнения
+    void clear()
+    {
+        for (size_t slot = 0; slot < capacity; ++slot)
+            if (control[slot] != Empty)
+                slots[slot].~value_type();
+        if (control)
+            std::memset(control, Empty, capacity + Group - 1);
+        used = 0;
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, capacity); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, capacity); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    iterator find(Key key)
+    {
+        if (used == 0)
+            return end();
+        bool found;
+        size_t slot = locate(key, found);
+        return found ? iterator(this, slot) : end();
+    }
+
+    const_iterator find(Key key) const
+    {
+        if (used == 0)
+            return end();
+        bool found;
+        size_t slot = locate(key, found);
+        return found ? const_iterator(this, slot) : end();
+    }
+
+    size_t count(Key key) const { return find(key) != end(); }
+
+    // Вставка, если ключа нет; значение строится из args только при вставке
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Key key, Args &&...args)
+    {
+        auto [slot, inserted] = emplaceSlot(key, std::forward<Args>(args)...);
+        return {iterator(this, slot), inserted};
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(Key key, Args &&...args)
+    {
+        return emplace(key, std::forward<Args>(args)...);
+    }
+
+    T &operator[](Key key)
+    {
+        size_t slot = emplaceSlot(key).first; // вставка может перенести слоты
+        return slots[slot].second;
+    }
+
+    size_t erase(Key key)
+    {
+        if (used == 0)
+            return 0;
+        bool found;
+        size_t slot = locate(key, found);
+        if (!found)
+            return 0;
+        eraseSlot(slot);
+        return 1;
+    }
+
+    // Удаление элементов, для которых pred(элемент) истинно; pred может изменить значение.
+    // Обход начинается после пустого слота: сдвиг при удалении переносит в текущий слот только
+    // ещё не просмотренные элементы, и каждый элемент проверяется ровно один раз.
+    template <typename Pred>
+    size_t eraseIf(Pred pred)
+    {
+        if (used == 0)
+            return 0;
+        size_t mask = capacity - 1;
+        size_t start = 0;
+        while (control[start] != Empty)
+            ++start;
+        size_t erased = 0;
+        for (size_t step = 1; step <= capacity;)
+        {
+            size_t slot = (start + step) & mask;
+            if (control[slot] != Empty && pred(slots[slot]))
+            {
+                eraseSlot(slot);
+                ++erased;
+            }
+            else
+                ++step;
+        }
+        return erased;
+    }
+};
+
+#endif // FLAT_HASH_MAP_HPP
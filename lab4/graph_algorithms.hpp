@@ -0,0 +1,366 @@
+#ifndef GRAPH_ALGORITHMS_HPP
+#define GRAPH_ALGORITHMS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "semiring.hpp"
+
+// Алгоритмы на графах, заданных матрицей смежности: A_uv != 0 — ребро u -> v с весом A_uv.
+// Каждый шаг обхода — masked SpMV/SpMSpV из semiring.hpp, поэтому работа шага пропорциональна
+// фронту (вершинам, изменившимся на прошлом шаге), а не всему графу, как при повторных A * x.
+//
+//   CSRMatrix<double> graph(adjacency);
+//   std::vector<size_t> levels = breadthFirstSearch(graph, 0);
+//   std::vector<double> ranks = pageRank(graph);
+//   std::vector<double> distances = shortestPaths(graph, 0);
+
+// Уровень вершины, недостижимой из источника
+constexpr size_t unreachableLevel = std::numeric_limits<size_t>::max();
+
+namespace graph_detail
+{
+    // Пороги переключения направления BFS (Beamer et al.): «pull», когда рёбер фронта больше
+    // чем 1/pushToPull рёбер непосещённых вершин; обратно в «push», когда фронт меньше
+    // 1/pullToPush всех вершин
+    constexpr size_t pushToPull = 14;
+    constexpr size_t pullToPush = 24;
+
+    template <typename T>
+    void checkGraph(const CSRMatrix<T> &graph, size_t source)
+    {
+        if (graph.getRows() != graph.getCols())
+            throw std::invalid_argument("Adjacency matrix must be square");
+        if (source >= graph.getRows())
+            throw std::out_of_range("Index out of range");
+    }
+
+    // incoming — A^T, построенная заранее для нескольких обходов одного графа (или nullptr)
+    template <typename T>
+    void checkIncoming(const CSRMatrix<T> &graph, const CSRMatrix<T> *incoming)
+    {
+        if (incoming && (incoming->getRows() != graph.getCols() || incoming->getCols() != graph.getRows() ||
+                         incoming->nonZeros() != graph.nonZeros()))
+            throw std::invalid_argument("Incoming matrix must be the transpose of the adjacency matrix");
+    }
+}
+
+// Поиск в ширину с выбором направления на каждом уровне: «push» раздаёт фронт по исходящим
+// рёбрам (vxm над OrAnd с маской непосещённых), «pull» проверяет для каждой непосещённой
+// вершины входящие рёбра до первого попадания во фронт (mxv по A^T с ранним выходом).
+// Без готовой A^T (incoming) она строится при первом переходе в «pull».
+// Возвращает уровни вершин (источник — 0, недостижимые — unreachableLevel)
+template <typename T>
+std::vector<size_t> breadthFirstSearch(const CSRMatrix<T> &graph, const CSRMatrix<T> *incoming, size_t source,
+                                       size_t threads = defaultThreadCount())
+{
+    using namespace graph_detail;
+    checkGraph(graph, source);
+    checkIncoming(graph, incoming);
+    size_t n = graph.getRows();
+    const std::vector<size_t> &ptr = graph.rowPtr();
+    auto degree = [&](size_t v)
+    { return ptr[v + 1] - ptr[v]; };
+
+    std::vector<size_t> levels(n, unreachableLevel);
+    std::vector<bool> visited(n, false);
+    std::vector<size_t> frontier{source};
+    levels[source] = 0;
+    visited[source] = true;
+    size_t unexploredEdges = graph.nonZeros() - degree(source);
+
+    std::optional<CSRMatrix<T>> built;
+    std::vector<char> dense(incoming ? n : 0, 0), reached(dense);
+    SpMSpVWorkspace<char> workspace(n);
+    bool pull = false;
+    for (size_t level = 1; !frontier.empty(); ++level)
+    {
+        if (!pull)
+        {
+            size_t frontierEdges = 0;
+            for (size_t v : frontier)
+                frontierEdges += degree(v);
+            pull = frontierEdges > unexploredEdges / pushToPull;
+        }
+        else
+            pull = frontier.size() >= n / pullToPush;
+
+        if (pull)
+        {
+            if (!incoming)
+            {
+                built = transposeParallel(graph, threads);
+                incoming = &*built;
+                dense.assign(n, 0);
+                reached.assign(n, 0);
+            }
+            for (size_t v : frontier)
+                dense[v] = 1;
+            mxv<OrAnd>(*incoming, dense, reached, Mask::complementOf(visited), threads);
+            for (size_t v : frontier)
+                dense[v] = 0;
+            frontier.clear();
+            for (size_t v = 0; v < n; ++v)
+                if (!visited[v] && reached[v])
+                    frontier.push_back(v);
+        }
+        else
+        {
+            size_t size = frontier.size();
+            CompressedVector<char> current(n, std::move(frontier), std::vector<char>(size, 1));
+            frontier = vxm<OrAnd>(current, graph, Mask::complementOf(visited), workspace).getIndices();
+        }
+
+        for (size_t v : frontier)
+        {
+            visited[v] = true;
+            levels[v] = level;
+            unexploredEdges -= degree(v);
+        }
+    }
+    return levels;
+}
+
+template <typename T>
+std::vector<size_t> breadthFirstSearch(const CSRMatrix<T> &graph, size_t source, size_t threads = defaultThreadCount())
+{
+    return breadthFirstSearch(graph, static_cast<const CSRMatrix<T> *>(nullptr), source, threads);
+}
+
+// PageRank степенным методом: r = (1 - d) / n + d (A^T D^{-1} r + висячие / n), где D — суммы
+// весов исходящих рёбер, а ранг вершин без исходящих рёбер распределяется поровну между всеми.
+// Итерации останавливаются, когда норма изменения L1 меньше tolerance. Как и в BFS, A^T можно
+// передать готовой
+template <typename T>
+std::vector<double> pageRank(const CSRMatrix<T> &graph, const CSRMatrix<T> *incoming, double damping = 0.85,
+                             double tolerance = 1e-10, size_t maxIterations = 100,
+                             size_t threads = defaultThreadCount())
+{
+    if (graph.getRows() != graph.getCols())
+        throw std::invalid_argument("Adjacency matrix must be square");
+    graph_detail::checkIncoming(graph, incoming);
+    if (!(damping >= 0 && damping < 1))
+        throw std::invalid_argument("Damping factor must be in [0, 1)");
+    size_t n = graph.getRows();
+    if (n == 0)
+        return {};
+
+    std::vector<double> outWeight(n, 0.0);
+    const std::vector<size_t> &ptr = graph.rowPtr();
+    const std::vector<T> &val = graph.getValues();
+    for (size_t u = 0; u < n; ++u)
+        for (size_t k = ptr[u]; k < ptr[u + 1]; ++k)
+        {
+            if (val[k] < 0)
+                throw std::invalid_argument("PageRank requires nonnegative edge weights");
+            outWeight[u] += static_cast<double>(val[k]);
+        }
+
+    std::optional<CSRMatrix<T>> built;
+    if (!incoming)
+    {
+        built = transposeParallel(graph, threads);
+        incoming = &*built;
+    }
+    std::vector<double> rank(n, 1.0 / n), share(n), spread(n);
+    for (size_t iteration = 0; iteration < maxIterations; ++iteration)
+    {
+        double dangling = 0;
+        for (size_t u = 0; u < n; ++u)
+        {
+            share[u] = outWeight[u] > 0 ? rank[u] / outWeight[u] : 0.0;
+            if (outWeight[u] == 0)
+                dangling += rank[u];
+        }
+        mxv<PlusTimes<double>>(*incoming, share, spread, Mask(), threads);
+        double base = (1 - damping + damping * dangling) / n, change = 0;
+        for (size_t v = 0; v < n; ++v)
+        {
+            double next = base + damping * spread[v];
+            change += std::abs(next - rank[v]);
+            rank[v] = next;
+        }
+        if (change < tolerance)
+            break;
+    }
+    return rank;
+}
+
+template <typename T>
+std::vector<double> pageRank(const CSRMatrix<T> &graph, double damping = 0.85, double tolerance = 1e-10,
+                             size_t maxIterations = 100, size_t threads = defaultThreadCount())
+{
+    return pageRank(graph, static_cast<const CSRMatrix<T> *>(nullptr), damping, tolerance, maxIterations, threads);
+}
+
+namespace graph_detail
+{
+    // Релаксация рёбер edges из вершин vertices (по возрастанию номеров): improved(v) вызывается
+    // для каждой вершины, расстояние до которой уменьшилось
+    template <typename T, typename F>
+    void relax(const std::vector<size_t> &vertices, const CSRMatrix<T> &edges, std::vector<T> &distances,
+               SpMSpVWorkspace<T> &workspace, F improved)
+    {
+        std::vector<T> values(vertices.size());
+        for (size_t k = 0; k < vertices.size(); ++k)
+            values[k] = distances[vertices[k]];
+        CompressedVector<T> candidates = vxm<MinPlus<T>>(CompressedVector<T>(distances.size(), vertices, std::move(values)),
+                                                         edges, Mask(), workspace);
+        for (size_t k = 0; k < candidates.nonZeros(); ++k)
+        {
+            size_t v = candidates.getIndices()[k];
+            T distance = candidates.getValues()[k];
+            if (distance < distances[v])
+            {
+                distances[v] = distance;
+                improved(v);
+            }
+        }
+    }
+
+    // Беллман-Форд с фронтом: на каждом раунде релаксируются рёбра вершин, расстояние до которых
+    // уменьшилось на прошлом раунде. Если фронт не опустел за n раундов, из source достижим цикл
+    // отрицательного веса
+    template <typename T>
+    std::vector<T> bellmanFord(const CSRMatrix<T> &graph, size_t source)
+    {
+        size_t n = graph.getRows();
+        std::vector<T> distances(n, MinPlus<T>::zero());
+        distances[source] = T(0);
+        std::vector<size_t> frontier{source}, next;
+        SpMSpVWorkspace<T> workspace(n);
+        for (size_t round = 0; !frontier.empty(); ++round)
+        {
+            if (round == n)
+                throw std::runtime_error("Graph contains a negative cycle reachable from the source");
+            relax(frontier, graph, distances, workspace, [&](size_t v)
+                  { next.push_back(v); });
+            frontier.swap(next);
+            next.clear();
+        }
+        return distances;
+    }
+
+    // Δ-stepping (Meyer, Sanders) для неотрицательных весов: вершины раскладываются по корзинам
+    // шириной delta по расстоянию; корзины обрабатываются по возрастанию, внутри корзины до
+    // опустения повторяется релаксация лёгких рёбер (вес <= delta), после — один проход по
+    // тяжёлым рёбрам всех вершин корзины. Устаревшие записи корзин отбрасываются при извлечении
+    template <typename T>
+    std::vector<T> deltaStepping(const CSRMatrix<T> &graph, size_t source, T delta)
+    {
+        size_t n = graph.getRows();
+        const std::vector<size_t> &ptr = graph.rowPtr();
+        const std::vector<size_t> &idx = graph.colIdx();
+        const std::vector<T> &val = graph.getValues();
+        std::vector<size_t> lightPtr(n + 1, 0), heavyPtr(n + 1, 0), lightIdx, heavyIdx;
+        std::vector<T> lightVal, heavyVal;
+        for (size_t u = 0; u < n; ++u)
+        {
+            for (size_t k = ptr[u]; k < ptr[u + 1]; ++k)
+            {
+                bool light = val[k] <= delta;
+                (light ? lightIdx : heavyIdx).push_back(idx[k]);
+                (light ? lightVal : heavyVal).push_back(val[k]);
+            }
+            lightPtr[u + 1] = lightIdx.size();
+            heavyPtr[u + 1] = heavyIdx.size();
+        }
+        CSRMatrix<T> light(n, n, std::move(lightPtr), std::move(lightIdx), std::move(lightVal));
+        CSRMatrix<T> heavy(n, n, std::move(heavyPtr), std::move(heavyIdx), std::move(heavyVal));
+
+        std::vector<T> distances(n, MinPlus<T>::zero());
+        distances[source] = T(0);
+        auto bucketOf = [&](T distance)
+        { return static_cast<size_t>(distance / delta); };
+        std::map<size_t, std::vector<size_t>> buckets{{0, {source}}};
+        auto enqueue = [&](size_t v)
+        { buckets[bucketOf(distances[v])].push_back(v); };
+        std::vector<bool> inFrontier(n, false), settled(n, false);
+        SpMSpVWorkspace<T> workspace(n);
+        while (!buckets.empty())
+        {
+            size_t bucket = buckets.begin()->first;
+            std::vector<size_t> reached;
+            for (auto it = buckets.begin(); it != buckets.end() && it->first == bucket; it = buckets.begin())
+            {
+                std::vector<size_t> entries = std::move(it->second), frontier;
+                buckets.erase(it);
+                for (size_t v : entries)
+                    if (!inFrontier[v] && bucketOf(distances[v]) == bucket)
+                    {
+                        inFrontier[v] = true;
+                        frontier.push_back(v);
+                    }
+                for (size_t v : frontier)
+                {
+                    inFrontier[v] = false;
+                    if (!settled[v])
+                    {
+                        settled[v] = true;
+                        reached.push_back(v);
+                    }
+                }
+                std::sort(frontier.begin(), frontier.end());
+                relax(frontier, light, distances, workspace, enqueue);
+            }
+            std::sort(reached.begin(), reached.end());
+            relax(reached, heavy, distances, workspace, enqueue);
+        }
+        return distances;
+    }
+}
+
+// Кратчайшие пути из source над полукольцом MinPlus, каждый шаг — vxm по фронту.
+// При неотрицательных весах — Δ-stepping; delta = 0 выбирает ширину корзины как
+// максимальный вес, делённый на среднюю степень вершины. При отрицательных весах —
+// Беллман-Форд с фронтом (исключение при достижимом цикле отрицательного веса).
+// Рёбра нулевого веса CSR не хранит. Недостижимые — MinPlus<T>::zero()
+template <typename T>
+std::vector<T> shortestPaths(const CSRMatrix<T> &graph, size_t source, T delta = T(0))
+{
+    graph_detail::checkGraph(graph, source);
+    const std::vector<T> &val = graph.getValues();
+    if (val.empty())
+    {
+        std::vector<T> distances(graph.getRows(), MinPlus<T>::zero());
+        distances[source] = T(0);
+        return distances;
+    }
+    auto [lightest, heaviest] = std::minmax_element(val.begin(), val.end());
+    if (*lightest < 0)
+        return graph_detail::bellmanFord(graph, source);
+    if (delta < 0)
+        throw std::invalid_argument("Bucket width must be nonnegative");
+    if (delta == 0)
+        delta = std::max(*lightest, *heaviest / static_cast<T>(std::max<size_t>(1, val.size() / graph.getRows())));
+    if (delta == 0)
+        delta = T(1); // Все хранимые веса нулевые
+    return graph_detail::deltaStepping(graph, source, delta);
+}
+
+template <typename T, typename Index>
+std::vector<size_t> breadthFirstSearch(const SparseMatrix<T, Index> &graph, size_t source,
+                                       size_t threads = defaultThreadCount())
+{
+    return breadthFirstSearch(CSRMatrix<T>(graph), source, threads);
+}
+
+template <typename T, typename Index>
+std::vector<double> pageRank(const SparseMatrix<T, Index> &graph, double damping = 0.85, double tolerance = 1e-10,
+                             size_t maxIterations = 100, size_t threads = defaultThreadCount())
+{
+    return pageRank(CSRMatrix<T>(graph), damping, tolerance, maxIterations, threads);
+}
+
+template <typename T, typename Index>
+std::vector<T> shortestPaths(const SparseMatrix<T, Index> &graph, size_t source, T delta = T(0))
+{
+    return shortestPaths(CSRMatrix<T>(graph), source, delta);
+}
+
+#endif // GRAPH_ALGORITHMS_HPP
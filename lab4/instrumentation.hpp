@@ -0,0 +1,338 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Счётчики операций SparseVector/SparseMatrix. Включаются при компиляции макросом
+// SPARSE_INSTRUMENTATION (-DSPARSE_INSTRUMENTATION); без него макросы SPARSE_* ниже пусты,
+// а instrumentationSnapshot() возвращает нули.
+//
+// Для каждого типа операции считаются вызовы, время (включая вложенные операции,
+// например умножения внутри power()), затронутые ненулевые элементы и флопы, группы слотов,
+// просмотренные при поиске в FlatHashMap, перестроения таблиц, а также число и объём
+// выделений памяти. Пробы и выделения относятся к самой внутренней выполняемой операции
+// (вне операций — к Operation::Other). Выделения считаются через источник памяти по умолчанию
+// std::pmr, который при включённых счётчиках заменяется считающей обёрткой.
+//
+// Счётчики свои у каждого потока: поток-владелец обновляет их без блокировок и без
+// атомарных read-modify-write; instrumentationSnapshot() суммирует потоки (в том числе
+// завершившиеся). Разность двух снимков — счётчики за интервал между ними.
+
+enum class Operation
+{
+    Other,
+    VectorEvaluate,        // вычисление выражения в SparseVector
+    VectorAxpy,            // axpy, +=, -=
+    VectorScale,           // *=, умножение на скаляр временного вектора
+    VectorDot,
+    MatrixEvaluate,        // вычисление выражения в SparseMatrix
+    MatrixAxpy,
+    MatrixScale,
+    MatrixVector,          // умножение на вектор
+    MatrixTransposeVector, // A^T x
+    MatrixMultiply,
+    MatrixPower,
+    MatrixTranspose,
+    FormatConversion,      // переход между форматами хранения
+    Count
+};
+
+inline const char *operationName(Operation operation)
+{
+    static const char *const names[] = {"other", "vector_evaluate", "vector_axpy", "vector_scale", "vector_dot",
+                                        "matrix_evaluate", "matrix_axpy", "matrix_scale", "matrix_vector",
+                                        "matrix_transpose_vector", "matrix_multiply", "matrix_power",
+                                        "matrix_transpose", "format_conversion"};
+    return names[static_cast<size_t>(operation)];
+}
+
+struct OperationCounters
+{
+    uint64_t calls = 0;
+    uint64_t nanoseconds = 0;
+    uint64_t nonZeros = 0;
+    uint64_t flops = 0;
+    uint64_t hashProbes = 0;
+    uint64_t rehashes = 0;
+    uint64_t allocations = 0;
+    uint64_t bytesAllocated = 0;
+
+    static constexpr size_t fieldCount = 8;
+
+    uint64_t *fields() { return &calls; }
+    const uint64_t *fields() const { return &calls; }
+
+    OperationCounters &operator+=(const OperationCounters &other)
+    {
+        for (size_t f = 0; f < fieldCount; ++f)
+            fields()[f] += other.fields()[f];
+        return *this;
+    }
+
+    OperationCounters &operator-=(const OperationCounters &other)
+    {
+        for (size_t f = 0; f < fieldCount; ++f)
+            fields()[f] -= other.fields()[f];
+        return *this;
+    }
+};
+
+constexpr size_t operationCount = static_cast<size_t>(Operation::Count);
+
+struct InstrumentationSnapshot
+{
+    std::array<OperationCounters, operationCount> operations{};
+
+    const OperationCounters &operator[](Operation operation) const { return operations[static_cast<size_t>(operation)]; }
+
+    OperationCounters total() const
+    {
+        OperationCounters sum;
+        for (const OperationCounters &counters : operations)
+            sum += counters;
+        return sum;
+    }
+
+    InstrumentationSnapshot operator-(const InstrumentationSnapshot &earlier) const
+    {
+        InstrumentationSnapshot result = *this;
+        for (size_t op = 0; op < operationCount; ++op)
+            result.operations[op] -= earlier.operations[op];
+        return result;
+    }
+
+    // {"operation": {"calls": ..., "seconds": ..., ...}, ...}; операции без вызовов и событий пропускаются
+    void writeJson(std::ostream &out) const
+    {
+        static const char *const fieldNames[] = {"calls", "seconds", "non_zeros", "flops", "hash_probes",
+                                                 "rehashes", "allocations", "bytes_allocated"};
+        out << "{";
+        bool first = true;
+        for (size_t op = 0; op < operationCount; ++op)
+        {
+            const OperationCounters &counters = operations[op];
+            bool empty = true;
+            for (size_t f = 0; f < OperationCounters::fieldCount; ++f)
+                empty = empty && counters.fields()[f] == 0;
+            if (empty)
+                continue;
+            out << (first ? "\n" : ",\n") << "  \"" << operationName(static_cast<Operation>(op)) << "\": {";
+            first = false;
+            for (size_t f = 0; f < OperationCounters::fieldCount; ++f)
+            {
+                out << (f ? ", " : "") << "\"" << fieldNames[f] << "\": ";
+                if (f == 1)
+                    out << counters.nanoseconds * 1e-9;
+                else
+                    out << counters.fields()[f];
+            }
+            out << "}";
+        }
+        out << (first ? "}" : "\n}");
+    }
+
+    std::string toJson() const
+    {
+        std::ostringstream out;
+        writeJson(out);
+        return out.str();
+    }
+};
+
+#ifdef SPARSE_INSTRUMENTATION
+
+namespace instrumentation_detail
+{
+    // Счётчики одного потока. Пишет только поток-владелец (load + store без RMW),
+    // читает instrumentationSnapshot() из любого потока.
+    struct ThreadCounters
+    {
+        std::atomic<uint64_t> values[operationCount][OperationCounters::fieldCount] = {};
+        Operation current = Operation::Other;
+
+        void add(Operation operation, size_t field, uint64_t amount)
+        {
+            std::atomic<uint64_t> &value = values[static_cast<size_t>(operation)][field];
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        void addTo(InstrumentationSnapshot &snapshot) const
+        {
+            for (size_t op = 0; op < operationCount; ++op)
+                for (size_t f = 0; f < OperationCounters::fieldCount; ++f)
+                    snapshot.operations[op].fields()[f] += values[op][f].load(std::memory_order_relaxed);
+        }
+    };
+
+    // Список счётчиков живых потоков и сумма завершившихся; мьютекс берётся только
+    // при создании и завершении потока и при снятии снимка
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<const ThreadCounters *> threads;
+        InstrumentationSnapshot retired;
+    };
+
+    inline Registry &registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+    struct ThreadSlot
+    {
+        ThreadCounters counters;
+
+        ThreadSlot()
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.threads.push_back(&counters);
+        }
+
+        ~ThreadSlot()
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            counters.addTo(r.retired);
+            r.threads.erase(std::find(r.threads.begin(), r.threads.end(), &counters));
+        }
+    };
+
+    inline ThreadCounters &threadCounters()
+    {
+        thread_local ThreadSlot slot;
+        return slot.counters;
+    }
+
+    enum Field : size_t
+    {
+        Calls,
+        Nanoseconds,
+        NonZeros,
+        Flops,
+        HashProbes,
+        Rehashes,
+        Allocations,
+        BytesAllocated
+    };
+
+    inline void addToCurrent(size_t field, uint64_t amount)
+    {
+        ThreadCounters &counters = threadCounters();
+        counters.add(counters.current, field, amount);
+    }
+
+    // Время и вызов операции; операция становится текущей до выхода из области
+    class OperationScope
+    {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        ThreadCounters &counters;
+        Operation operation, previous;
+        Clock::time_point start;
+
+    public:
+        explicit OperationScope(Operation operation)
+            : counters(threadCounters()), operation(operation), previous(counters.current), start(Clock::now())
+        {
+            counters.current = operation;
+            counters.add(operation, Calls, 1);
+        }
+
+        OperationScope(const OperationScope &) = delete;
+        OperationScope &operator=(const OperationScope &) = delete;
+
+        ~OperationScope()
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            counters.add(operation, Nanoseconds, static_cast<uint64_t>(elapsed));
+            counters.current = previous;
+        }
+    };
+
+    // Источник памяти по умолчанию: передаёт запросы прежнему и считает выделения
+    class CountingDefaultResource : public std::pmr::memory_resource
+    {
+    private:
+        std::pmr::memory_resource *upstream;
+
+    protected:
+        void *do_allocate(size_t bytes, size_t alignment) override
+        {
+            addToCurrent(Allocations, 1);
+            addToCurrent(BytesAllocated, bytes);
+            return upstream->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *pointer, size_t bytes, size_t alignment) override
+        {
+            upstream->deallocate(pointer, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    public:
+        explicit CountingDefaultResource(std::pmr::memory_resource *upstream) : upstream(upstream) {}
+    };
+
+    // Обёртка не уничтожается: контейнеры со статическим временем жизни
+    // могут освобождать память через неё до самого завершения программы
+    inline bool installCountingResource()
+    {
+        std::pmr::set_default_resource(new CountingDefaultResource(std::pmr::get_default_resource()));
+        return true;
+    }
+
+    inline const bool countingResourceInstalled = installCountingResource();
+}
+
+constexpr bool instrumentationEnabled = true;
+
+inline InstrumentationSnapshot instrumentationSnapshot()
+{
+    using namespace instrumentation_detail;
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    InstrumentationSnapshot snapshot = r.retired;
+    for (const ThreadCounters *counters : r.threads)
+        counters->addTo(snapshot);
+    return snapshot;
+}
+
+#define SPARSE_OPERATION(operation) \
+    instrumentation_detail::OperationScope sparseOperationScope(Operation::operation)
+#define SPARSE_WORK(nonZeros, flops)                                                                  \
+    do                                                                                                \
+    {                                                                                                 \
+        instrumentation_detail::addToCurrent(instrumentation_detail::NonZeros, uint64_t(nonZeros));   \
+        instrumentation_detail::addToCurrent(instrumentation_detail::Flops, uint64_t(flops));         \
+    } while (false)
+#define SPARSE_HASH_PROBE() instrumentation_detail::addToCurrent(instrumentation_detail::HashProbes, 1)
+#define SPARSE_HASH_REHASH() instrumentation_detail::addToCurrent(instrumentation_detail::Rehashes, 1)
+
+#else
+
+constexpr bool instrumentationEnabled = false;
+
+inline InstrumentationSnapshot instrumentationSnapshot() { return InstrumentationSnapshot(); }
+
+#define SPARSE_OPERATION(operation) ((void)0)
+#define SPARSE_WORK(nonZeros, flops) ((void)0)
+#define SPARSE_HASH_PROBE() ((void)0)
+#define SPARSE_HASH_REHASH() ((void)0)
+
+#endif // SPARSE_INSTRUMENTATION
+
+#endif // INSTRUMENTATION_HPP
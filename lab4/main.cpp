@@ -1,287 +1,17 @@
 #include <iostream>
-#include <unordered_map>
-#include <stdexcept>
-#include <cmath>
-#include <iterator>
 #include <vector>
-#include <chrono>
 
-// Шаблонный класс для разреженного вектора
-template <typename T>
-class SparseVector
-{
-private:
-    std::unordered_map<size_t, T> data;
-    size_t size;
-
-public:
-    explicit SparseVector(size_t size) : size(size) {}
-
-    T get(size_t index) const
-    {
-        if (data.count(index))
-            return data.at(index);
-        return 0;
-    }
-
-    void set(size_t index, T value)
-    {
-        if (index >= size)
-            throw std::out_of_range("Index out of range");
-        if (value != 0)
-            data[index] = value;
-        else
-            data.erase(index);
-    }
-
-    size_t getSize() const { return size; }
-
-    SparseVector<T> operator+(const SparseVector<T> &other) const
-    {
-        if (size != other.size)
-            throw std::invalid_argument("Vector sizes do not match");
-        SparseVector<T> result(size);
-        for (const auto &[index, value] : data)
-            result.set(index, value + other.get(index));
-        for (const auto &[index, value] : other.data)
-            if (!result.data.count(index))
-                result.set(index, value);
-        return result;
-    }
-
-    SparseVector<T> operator-(const SparseVector<T> &other) const
-    {
-        if (size != other.size)
-            throw std::invalid_argument("Vector sizes do not match");
-        SparseVector<T> result(size);
-        for (const auto &[index, value] : data)
-            result.set(index, value - other.get(index));
-        return result;
-    }
-
-    SparseVector<T> operator*(T scalar) const
-    {
-        SparseVector<T> result(size);
-        for (const auto &[index, value] : data)
-            result.set(index, value * scalar);
-        return result;
-    }
-
-    T dot(const SparseVector<T> &other) const
-    {
-        if (size != other.size)
-            throw std::invalid_argument("Vector sizes do not match");
-        T result = 0;
-        for (const auto &[index, value] : data)
-            result += value * other.get(index);
-        return result;
-    }
-
-    // Итератор для разреженного вектора
-    class Iterator
-    {
-    private:
-        typename std::unordered_map<size_t, T>::iterator it;
-
-    public:
-        Iterator(typename std::unordered_map<size_t, T>::iterator iterator) : it(iterator) {}
-
-        std::pair<size_t, T> operator*() { return *it; }
-        Iterator &operator++()
-        {
-            ++it;
-            return *this;
-        }
-        bool operator!=(const Iterator &other) const { return it != other.it; }
-    };
-
-    Iterator begin() { return Iterator(data.begin()); }
-    Iterator end() { return Iterator(data.end()); }
-
-    // Поэлементное умножение на скаляр
-    SparseVector<T> elementWiseMultiply(T scalar) const
-    {
-        SparseVector<T> result(size);
-        for (const auto &[index, value] : data)
-            result.set(index, value * scalar);
-        return result;
-    }
-
-    // Поэлементное возведение в степень
-    SparseVector<T> power(T exponent) const
-    {
-        SparseVector<T> result(size);
-        for (const auto &[index, value] : data)
-            result.set(index, std::pow(value, exponent));
-        return result;
-    }
-    void print() const
-    {
-        for (size_t i = 0; i < size; ++i)
-            std::cout << get(i) << " ";
-        std::cout << "\n";
-    }
-};
-
-// Шаблонный класс для разреженной матрицы
-template <typename T>
-class SparseMatrix
-{
-private:
-    std::unordered_map<size_t, std::unordered_map<size_t, T>> data;
-    size_t rows, cols;
-
-public:
-    SparseMatrix(size_t rows, size_t cols) : rows(rows), cols(cols) {}
-
-    T get(size_t row, size_t col) const
-    {
-        if (data.count(row) && data.at(row).count(col))
-            return data.at(row).at(col);
-        return 0;
-    }
-
-    void set(size_t row, size_t col, T value)
-    {
-        if (row >= rows || col >= cols)
-            throw std::out_of_range("Index out of range");
-        if (value != 0)
-            data[row][col] = value;
-        else if (data.count(row))
-            data[row].erase(col);
-    }
-
-    SparseMatrix<T> transpose() const
-    {
-        SparseMatrix<T> result(cols, rows);
-        for (const auto &[row, cols] : data)
-            for (const auto &[col, value] : cols)
-                result.set(col, row, value);
-        return result;
-    }
-
-    SparseMatrix<T> operator+(const SparseMatrix<T> &other) const
-    {
-        if (rows != other.rows || cols != other.cols)
-            throw std::invalid_argument("Matrix sizes do not match");
-        SparseMatrix<T> result(rows, cols);
-        for (const auto &[row, cols] : data)
-            for (const auto &[col, value] : cols)
-                result.set(row, col, value + other.get(row, col));
-        for (const auto &[row, cols] : other.data)
-            for (const auto &[col, value] : cols)
-                if (!result.data[row].count(col))
-                    result.set(row, col, value);
-        return result;
-    }
-
-    SparseMatrix<T> operator*(T scalar) const
-    {
-        SparseMatrix<T> result(rows, cols);
-        for (const auto &[row, cols] : data)
-            for (const auto &[col, value] : cols)
-                result.set(row, col, value * scalar);
-        return result;
-    }
-
-    SparseMatrix<T> operator*(const SparseMatrix<T> &other) const
-    {
-        if (cols != other.rows)
-            throw std::invalid_argument("Matrix dimensions do not allow multiplication");
-        SparseMatrix<T> result(rows, other.cols);
-        for (const auto &[row, cols] : data)
-        {
-            for (const auto &[col, value] : cols)
-            {
-                for (size_t k = 0; k < other.cols; ++k)
-                    result.set(row, k, result.get(row, k) + value * other.get(col, k));
-            }
-        }
-        return result;
-    }
-
-    SparseVector<T> operator*(const SparseVector<T> &vec) const
-    {
-        if (cols != vec.getSize())
-            throw std::invalid_argument("Matrix and vector dimensions do not match");
-        SparseVector<T> result(vec.getSize());
-        for (const auto &[row, cols] : data)
-        {
-            for (const auto &[col, value] : cols)
-            {
-                result.set(row, result.get(row) + value * vec.get(col));
-            }
-        }
-        return result;
-    }
-
-    SparseMatrix<T> inverse() const
-    {
-        if (rows != cols)
-            throw std::invalid_argument("Matrix must be square");
-
-        // Для матриц размером больше 2x2 можно использовать метод Гаусса или другие методы
-        // Здесь мы оставим только пример для 2x2
-        if (rows == 2)
-        {
-            T a = get(0, 0);
-            T b = get(0, 1);
-            T c = get(1, 0);
-            T d = get(1, 1);
-            T det = a * d - b * c;
-            if (det == 0)
-                throw std::invalid_argument("Matrix is singular and cannot be inverted");
-            SparseMatrix<T> inv(2, 2);
-            inv.set(0, 0, d / det);
-            inv.set(0, 1, -b / det);
-            inv.set(1, 0, -c / det);
-            inv.set(1, 1, a / det);
-            return inv;
-        }
-
-        // Для матриц размером больше 2x2, можно использовать метод Гаусса или другие методы
-        // Здесь можно добавить реализацию для больших матриц, если это необходимо
-        throw std::invalid_argument("Inverse not implemented for matrices larger than 2x2");
-    }
-
-    SparseMatrix<T> power(int exponent) const
-    {
-        if (rows != cols)
-            throw std::invalid_argument("Matrix must be square");
-        if (exponent < 0)
-            throw std::invalid_argument("Exponent must be non-negative");
-
-        SparseMatrix<T> result(rows, cols);
-        for (size_t i = 0; i < rows; ++i)
-        {
-            for (size_t j = 0; j < cols; ++j)
-            {
-                result.set(i, j, (i == j) ? 1 : 0); // Инициализация единичной матрицы
-            }
-        }
-        SparseMatrix<T> base = *this;
-        while (exponent > 0)
-        {
-            if (exponent % 2 == 1)
-            {
-                result = result * base;
-            }
-            base = base * base;
-            exponent /= 2;
-        }
-        return result;
-    }
-
-    void print() const
-    {
-        for (size_t i = 0; i < rows; ++i)
-        {
-            for (size_t j = 0; j < cols; ++j)
-                std::cout << get(i, j) << " ";
-            std::cout << "\n";
-        }
-    }
-};
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+#include "csr_matrix.hpp"
+#include "compressed_vector.hpp"
+#include "parallel_spmv.hpp"
+#include "solvers.hpp"
+#include "direct_solver.hpp"
+#include "bsr_matrix.hpp"
+#include "transpose_view.hpp"
+#include "fixed_matrix.hpp"
+#include "graph_algorithms.hpp"
 
 int main()
 {
@@ -310,9 +40,21 @@ int main()
     std::cout << "Vector 1 Product with Scalar 5: ";
     vecProd.print();
 
+    // Выражение вычисляется одним проходом без промежуточных векторов
+    SparseVector<double> vecAxpy = vec1 + vec2 * 5;
+    std::cout << "Vector 1 + Vector 2 * 5: ";
+    vecAxpy.print();
+
     double vec3 = vec1.dot(vec2);
     std::cout << "Vector 1 Product with Vector 2: " << vec3 << "\n";
 
+    // Сжатые векторы: операции выполняются слиянием отсортированных индексов
+    CompressedVector<double> cvec1(vec1);
+    CompressedVector<double> cvec2(vec2);
+    std::cout << "Compressed Vector Minus: ";
+    (cvec1 - cvec2).print();
+    std::cout << "Compressed Vector 1 Product with Vector 2: " << cvec1.dot(cvec2) << "\n";
+
     // Пример использования разреженной матрицы
     SparseMatrix<double> mat1(3, 3);
     mat1.set(0, 0, 1.0);
@@ -366,5 +108,98 @@ int main()
     std::cout << "Inverse of Matrix 3:\n";
     matInv.print();
 
+    // Малая матрица с размером в параметрах шаблона: хранение в самом объекте,
+    // обращение вычисляется при компиляции
+    constexpr FixedMatrix<double, 3, 3> fixed{2.0, 1.0, 0.0,
+                                              1.0, 1.0, 0.0,
+                                              0.0, 0.0, 4.0};
+    constexpr FixedMatrix<double, 3, 3> fixedInv = fixed.inverse();
+    std::cout << "Inverse of Fixed 3x3 Matrix:\n";
+    fixedInv.print();
+
+    // Те же операции в сжатом строчном формате
+    CSRMatrix<double> csr1(mat1);
+    CSRMatrix<double> csr2(mat2);
+    std::cout << "CSR Matrix 1 * Matrix 2:\n";
+    (csr1 * csr2).print();
+    std::cout << "CSR Matrix 1 to the power of 2:\n";
+    csr1.power(2).print();
+
+    // Параллельное умножение на вектор с разбиением строк по числу ненулевых элементов
+    ParallelSpMV<double> spmv(csr1, 2);
+    std::vector<double> parallelResult = spmv * std::vector<double>{1.0, 0.0, 2.0};
+    std::cout << "Parallel CSR Matrix 1 * Vector 1: ";
+    for (double value : parallelResult)
+        std::cout << value << " ";
+    std::cout << "\n";
+
+    CSCMatrix<double> csc1(mat1);
+    std::vector<double> dense = {1.0, 0.0, 2.0};
+    std::vector<double> cscResult = csc1 * dense;
+    std::cout << "CSC Matrix 1 * Vector 1: ";
+    for (double value : cscResult)
+        std::cout << value << " ";
+    std::cout << "\n";
+
+    // Решение системы Matrix 3 * x = (1, 4) вместо обращения матрицы
+    SolverOptions options;
+    options.method = SolverMethod::GMRES;
+    options.preconditioner = PreconditionerType::Jacobi;
+    SolveResult<double> solution = solve(CSRMatrix<double>(mat3), std::vector<double>{1.0, 4.0}, options);
+    std::cout << "Solution of Matrix 3 * x = (1, 4): " << solution.x[0] << " " << solution.x[1]
+              << " (" << solution.stats.iterations << " iterations)\n";
+
+    // Прямой метод: символический анализ и разложение выполняются один раз,
+    // после чего множитель решает систему для нескольких правых частей
+    CSRMatrix<double> csr3(mat3);
+    CholeskySymbolic symbolic = analyzeCholesky(csr3);
+    CholeskyFactor<double> cholesky(symbolic, csr3);
+    for (const std::vector<double> &rhs : cholesky.solve({{1.0, 4.0}, {2.0, 2.0}}))
+        std::cout << "Cholesky solution: " << rhs[0] << " " << rhs[1] << "\n";
+
+    // Матрица из двух плотных блоков 2x2: размер блока определяется автоматически
+    SparseMatrix<double> blocked(4, 4);
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = i / 2 * 2; j < i / 2 * 2 + 2; ++j)
+            blocked.set(i, j, static_cast<double>(i + j + 1));
+    withDetectedBlockSize(blocked, [](const auto &bsr)
+                          {
+        std::vector<double> blockResult = bsr * std::vector<double>{1.0, 1.0, 1.0, 1.0};
+        std::cout << "BSR (block " << bsr.blockSize() << ") Matrix * (1, 1, 1, 1): ";
+        for (double value : blockResult)
+            std::cout << value << " ";
+        std::cout << "\n"; });
+
+    // Транспонированная матрица без копирования
+    std::vector<double> transposedResult = transposed(blocked) * std::vector<double>{1.0, 1.0, 1.0, 1.0};
+    std::cout << "Blocked matrix^T * (1, 1, 1, 1): ";
+    for (double value : transposedResult)
+        std::cout << value << " ";
+    std::cout << "\n";
+
+    // Граф 0 -> 1 -> 2 -> 3 с «короткой» дорогой 0 -> 2: матрица смежности с весами рёбер
+    SparseMatrix<double> roads(4, 4);
+    roads.set(0, 1, 1.0);
+    roads.set(1, 2, 1.0);
+    roads.set(2, 3, 1.0);
+    roads.set(0, 2, 5.0);
+    std::cout << "BFS levels from 0: ";
+    for (size_t level : breadthFirstSearch(roads, 0))
+        std::cout << level << " ";
+    std::cout << "\nShortest paths from 0: ";
+    for (double distance : shortestPaths(roads, 0))
+        std::cout << distance << " ";
+    std::cout << "\n";
+
+    // Для достижимости важен только портрет: дробные и большие веса — тоже рёбра
+    SparseMatrix<double> weighted(4, 4);
+    weighted.set(0, 1, 0.5);
+    weighted.set(1, 2, 256.0);
+    weighted.set(2, 3, 1.0);
+    std::cout << "Weighted graph BFS levels from 0: ";
+    for (size_t level : breadthFirstSearch(weighted, 0))
+        std::cout << level << " ";
+    std::cout << "\n";
+
     return 0;
 }
@@ -0,0 +1,330 @@
+#ifndef MATRIX_BATCH_HPP
+#define MATRIX_BATCH_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "fixed_matrix.hpp"
+#include "parallel_spmv.hpp"
+
+// Пакеты однотипных малых матриц и векторов в формате «структура массивов»:
+// MatrixBatch<T, R, C, Pattern> хранит count матриц R x C с общим портретом (см. fixed_matrix.hpp)
+// как storedEntries() массивов длины count — k-я хранимая позиция всех матриц подряд.
+// Операции над пакетом обходят матрицы блоками по batch_detail::blockSize: внутри блока
+// одна и та же формула применяется к соседним элементам массивов, и компилятор раскладывает
+// блок по SIMD-регистрам (GCC векторизует такие циклы уже с -O2: у полного блока постоянное
+// число итераций, позиции выбираются при компиляции, формулы подставляются в цикл;
+// -march=native расширяет регистры до AVX); блоки распределяются между потоками.
+//
+// Суммы в умножениях состоят не более чем из 8 слагаемых и накапливаются в T, без перехода
+// к Accumulator<T>, чтобы float занимал вдвое больше линий SIMD.
+//
+//   MatrixBatch<double, 3, 3> a(1000000), b(1000000);
+//   ...
+//   MatrixBatch<double, 3, 3> c = multiply(a, b); // миллион умножений 3x3
+//   MatrixBatch<double, 3, 3> inv = a.inverse();
+
+namespace batch_detail
+{
+    // Матриц в блоке: входы и выход блока 4x4 double помещаются в кеш L1
+    constexpr size_t blockSize = 64;
+
+    // Меньше этого числа матриц на поток пакет не делится
+    constexpr size_t minimumPerThread = 4096;
+
+    using FullBlock = std::integral_constant<size_t, blockSize>;
+
+    // f(first, length) для блоков [first, first + length) пакета из count матриц. Для полных
+    // блоков length — FullBlock: циклы по блоку получают постоянное число итераций, и GCC
+    // векторизует их уже с -O2 (там допускается только векторизация без скалярного остатка).
+    // Неполный последний блок получает length типа size_t
+    template <typename F>
+    void forEachBlock(size_t count, size_t threads, F f)
+    {
+        size_t blocks = (count + blockSize - 1) / blockSize;
+        size_t parts = std::max<size_t>(1, std::min(threads, count / minimumPerThread));
+        runParallel(parts, [&](size_t p)
+                    {
+            for (size_t block = blocks * p / parts; block < blocks * (p + 1) / parts; ++block)
+            {
+                size_t first = block * blockSize;
+                if (count - first >= blockSize)
+                    f(first, FullBlock());
+                else
+                    f(first, count - first);
+            } });
+    }
+}
+
+template <typename T, size_t N>
+class VectorBatch
+{
+private:
+    size_t count;
+    std::vector<T> data; // data[i * count + b] — элемент i вектора b
+
+public:
+    using value_type = T;
+
+    explicit VectorBatch(size_t count) : count(count), data(N * count, T(0)) {}
+
+    size_t size() const { return count; }
+    static constexpr size_t getSize() { return N; }
+
+    T get(size_t vector, size_t index) const
+    {
+        if (vector >= count || index >= N)
+            throw std::out_of_range("Index out of range");
+        return data[index * count + vector];
+    }
+
+    void set(size_t vector, size_t index, T value)
+    {
+        if (vector >= count || index >= N)
+            throw std::out_of_range("Index out of range");
+        data[index * count + vector] = value;
+    }
+
+    // Элемент index всех векторов пакета подряд
+    T *lane(size_t index) { return data.data() + index * count; }
+    const T *lane(size_t index) const { return data.data() + index * count; }
+
+    FixedVector<T, N> vector(size_t vector) const
+    {
+        FixedVector<T, N> result;
+        for (size_t i = 0; i < N; ++i)
+            result.set(i, get(vector, i));
+        return result;
+    }
+
+    template <uint64_t Pattern>
+    void setVector(size_t vector, const FixedVector<T, N, Pattern> &value)
+    {
+        for (size_t i = 0; i < N; ++i)
+            set(vector, i, value.get(i));
+    }
+};
+
+template <typename T, size_t R, size_t C, uint64_t Pattern = fullPattern(R, C)>
+class MatrixBatch
+{
+private:
+    using Matrix = FixedMatrix<T, R, C, Pattern>;
+
+    size_t count;
+    std::vector<T> data; // data[slot * count + b] — хранимая позиция slot матрицы b
+
+    static constexpr size_t slot(size_t row, size_t col) { return fixed_detail::slotOf(Pattern, row * C + col); }
+
+public:
+    using value_type = T;
+
+    explicit MatrixBatch(size_t count) : count(count), data(Matrix::storedEntries() * count, T(0)) {}
+
+    size_t size() const { return count; }
+    static constexpr size_t getRows() { return R; }
+    static constexpr size_t getCols() { return C; }
+    static constexpr bool stores(size_t row, size_t col) { return Matrix::stores(row, col); }
+
+    T get(size_t matrix, size_t row, size_t col) const
+    {
+        if (matrix >= count || row >= R || col >= C)
+            throw std::out_of_range("Index out of range");
+        return stores(row, col) ? data[slot(row, col) * count + matrix] : T(0);
+    }
+
+    void set(size_t matrix, size_t row, size_t col, T value)
+    {
+        if (matrix >= count || row >= R || col >= C)
+            throw std::out_of_range("Index out of range");
+        if (stores(row, col))
+            data[slot(row, col) * count + matrix] = value;
+        else if (value != 0)
+            throw std::invalid_argument("Position is outside the sparsity pattern");
+    }
+
+    // Позиция (row, col) всех матриц пакета подряд; позиция должна входить в портрет
+    T *lane(size_t row, size_t col) { return data.data() + slot(row, col) * count; }
+    const T *lane(size_t row, size_t col) const { return data.data() + slot(row, col) * count; }
+
+    // То же для позиции, известной при компиляции: номер хранимой позиции не пересчитывается
+    // внутри блочных циклов, которые без этого не векторизуются с -O2
+    template <size_t Row, size_t Col>
+    const T *lane() const
+    {
+        static_assert(stores(Row, Col), "Position is outside the sparsity pattern");
+        constexpr size_t s = slot(Row, Col);
+        return data.data() + s * count;
+    }
+
+    template <size_t Row, size_t Col>
+    T *lane()
+    {
+        static_assert(stores(Row, Col), "Position is outside the sparsity pattern");
+        constexpr size_t s = slot(Row, Col);
+        return data.data() + s * count;
+    }
+
+    Matrix matrix(size_t matrix) const
+    {
+        Matrix result;
+        for (size_t i = 0; i < R; ++i)
+            for (size_t j = 0; j < C; ++j)
+                result.set(i, j, get(matrix, i, j));
+        return result;
+    }
+
+    void setMatrix(size_t matrix, const Matrix &value)
+    {
+        for (size_t i = 0; i < R; ++i)
+            for (size_t j = 0; j < C; ++j)
+                set(matrix, i, j, value.get(i, j));
+    }
+
+    // result_b = A_b x_b для всех b; result — пакет того же размера, переиспользуется между вызовами
+    void multiply(const VectorBatch<T, C> &vectors, VectorBatch<T, R> &result, size_t threads = defaultThreadCount()) const
+    {
+        if (vectors.size() != count || result.size() != count)
+            throw std::invalid_argument("Batch sizes do not match");
+        batch_detail::forEachBlock(count, threads, [&](size_t first, auto length)
+                                   {
+            fixed_detail::unroll<R>([&](auto i)
+                                    {
+                constexpr size_t I = decltype(i)::value;
+                T sum[batch_detail::blockSize];
+                for (size_t b = 0; b < length; ++b)
+                {
+                    T s = T(0);
+                    fixed_detail::unroll<C>([&](auto k)
+                                            {
+                        constexpr size_t K = decltype(k)::value;
+                        if constexpr (stores(I, K))
+                            s += lane<I, K>()[first + b] * vectors.lane(K)[first + b]; });
+                    sum[b] = s;
+                }
+                std::copy(sum, sum + length, result.lane(I) + first); }); });
+    }
+
+    VectorBatch<T, R> multiply(const VectorBatch<T, C> &vectors, size_t threads = defaultThreadCount()) const
+    {
+        VectorBatch<T, R> result(count);
+        multiply(vectors, result, threads);
+        return result;
+    }
+
+    // Обратные матрицы (1x1 - 4x4) по формулам FixedMatrix::inverse, но с одним делением на матрицу
+    // (дополнения умножаются на 1 / det). При вырожденной матрице в пакете исключение бросается
+    // после обработки всего пакета
+    void inverse(MatrixBatch<T, R, C> &result, size_t threads = defaultThreadCount()) const
+    {
+        static_assert(R == C && R >= 1 && R <= 4, "Inverse is implemented for square matrices up to 4x4");
+        constexpr size_t entries = R * C;
+        if (result.size() != count)
+            throw std::invalid_argument("Batch sizes do not match");
+        std::atomic<bool> singular{false};
+        batch_detail::forEachBlock(count, threads, [&](size_t first, auto length)
+                                   {
+            // Выход блока — локальный массив, чтобы компилятор видел, что он не пересекается
+            // со входами. Тело цикла без ветвлений: нулевой определитель заменяется единицей
+            // и отмечается в zeros
+            T out[entries][batch_detail::blockSize], zeros[batch_detail::blockSize];
+            for (size_t b = 0; b < length; ++b)
+            {
+                std::array<T, entries> m, adj;
+                fixed_detail::unroll<entries>([&](auto p)
+                                              {
+                    constexpr size_t I = decltype(p)::value / C, J = decltype(p)::value % C;
+                    if constexpr (stores(I, J))
+                        m[p] = lane<I, J>()[first + b];
+                    else
+                        m[p] = T(0); });
+                T det = fixed_detail::adjugate<T, R>(m, adj);
+                zeros[b] = T(det == 0);
+                T scale = T(1) / (det + zeros[b]);
+                fixed_detail::unroll<entries>([&](auto k)
+                                              { out[k][b] = adj[k] * scale; });
+            }
+            bool zero = false;
+            for (size_t b = 0; b < length; ++b)
+                zero |= zeros[b] != 0;
+            for (size_t k = 0; k < entries; ++k)
+                std::copy(out[k], out[k] + length, result.lane(k / C, k % C) + first);
+            if (zero)
+                singular.store(true, std::memory_order_relaxed); });
+        if (singular.load(std::memory_order_relaxed))
+            throw std::invalid_argument("Matrix is singular and cannot be inverted");
+    }
+
+    MatrixBatch<T, R, C> inverse(size_t threads = defaultThreadCount()) const
+    {
+        MatrixBatch<T, R, C> result(count);
+        inverse(result, threads);
+        return result;
+    }
+};
+
+// result_b = A_b B_b для всех b; портрет результата — как у произведения FixedMatrix
+template <typename T, size_t R, size_t C, size_t K, uint64_t Left, uint64_t Right>
+void multiply(const MatrixBatch<T, R, C, Left> &a, const MatrixBatch<T, C, K, Right> &b,
+              MatrixBatch<T, R, K, fixed_detail::productPattern(Left, Right, R, C, K)> &result,
+              size_t threads = defaultThreadCount())
+{
+    using Result = MatrixBatch<T, R, K, fixed_detail::productPattern(Left, Right, R, C, K)>;
+    if (a.size() != b.size() || result.size() != a.size())
+        throw std::invalid_argument("Batch sizes do not match");
+    batch_detail::forEachBlock(a.size(), threads, [&](size_t first, auto length)
+                               {
+        // Все позиции результата считаются в одном цикле по блоку: элемент A_b или B_b
+        // загружается один раз и используется во всех произведениях, где участвует
+        T out[R * K][batch_detail::blockSize];
+        for (size_t m = 0; m < length; ++m)
+        {
+            fixed_detail::unroll<R * K>([&](auto p)
+                                        {
+                constexpr size_t I = decltype(p)::value / K, J = decltype(p)::value % K;
+                if constexpr (Result::stores(I, J))
+                {
+                    T s = T(0);
+                    fixed_detail::unroll<C>([&](auto l)
+                                            {
+                        constexpr size_t L = decltype(l)::value;
+                        if constexpr (MatrixBatch<T, R, C, Left>::stores(I, L) && MatrixBatch<T, C, K, Right>::stores(L, J))
+                            s += a.template lane<I, L>()[first + m] * b.template lane<L, J>()[first + m]; });
+                    out[p][m] = s;
+                } });
+        }
+        fixed_detail::unroll<R * K>([&](auto p)
+                                    {
+            constexpr size_t I = decltype(p)::value / K, J = decltype(p)::value % K;
+            if constexpr (Result::stores(I, J))
+                std::copy(out[p], out[p] + length, result.template lane<I, J>() + first); }); });
+}
+
+template <typename T, size_t R, size_t C, size_t K, uint64_t Left, uint64_t Right>
+MatrixBatch<T, R, K, fixed_detail::productPattern(Left, Right, R, C, K)>
+multiply(const MatrixBatch<T, R, C, Left> &a, const MatrixBatch<T, C, K, Right> &b,
+         size_t threads = defaultThreadCount())
+{
+    MatrixBatch<T, R, K, fixed_detail::productPattern(Left, Right, R, C, K)> result(a.size());
+    multiply(a, b, result, threads);
+    return result;
+}
+
+template <typename T, size_t R, size_t C, size_t K, uint64_t Left, uint64_t Right>
+auto operator*(const MatrixBatch<T, R, C, Left> &a, const MatrixBatch<T, C, K, Right> &b)
+{
+    return multiply(a, b);
+}
+
+template <typename T, size_t R, size_t C, uint64_t Pattern>
+VectorBatch<T, R> operator*(const MatrixBatch<T, R, C, Pattern> &a, const VectorBatch<T, C> &x)
+{
+    return a.multiply(x);
+}
+
+#endif // MATRIX_BATCH_HPP
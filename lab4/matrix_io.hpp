@@ -0,0 +1,535 @@
+#ifndef MATRIX_IO_HPP
+#define MATRIX_IO_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "csr_matrix.hpp"
+#include "compressed_vector.hpp"
+#include "parallel_spmv.hpp"
+#include "triplet_builder.hpp"
+
+// Файл, отображённый в память только для чтения
+class MappedFile
+{
+private:
+    const char *address = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    void close()
+    {
+#ifdef _WIN32
+        if (address)
+            UnmapViewOfFile(address);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (address)
+            munmap(const_cast<char *>(address), length);
+#endif
+        address = nullptr;
+        length = 0;
+    }
+
+public:
+    explicit MappedFile(const std::string &path)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Cannot open file: " + path);
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length > 0)
+        {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping)
+            {
+                close();
+                throw std::runtime_error("Cannot map file: " + path);
+            }
+            address = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open file: " + path);
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat file: " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0)
+        {
+            void *mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+            address = mapped == MAP_FAILED ? nullptr : static_cast<const char *>(mapped);
+        }
+        ::close(fd);
+#endif
+        if (length > 0 && !address)
+        {
+            close();
+            throw std::runtime_error("Cannot map file: " + path);
+        }
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { close(); }
+
+    const char *data() const { return address; }
+    size_t size() const { return length; }
+};
+
+// Чтение Matrix Market (формат coordinate: real, integer или pattern;
+// general, symmetric или skew-symmetric). Файл отображается в память, тело делится
+// на части по границам строк, каждая часть разбирается своим потоком в TripletBuilder.
+template <typename T>
+CSRMatrix<T> readMatrixMarket(const std::string &path, size_t threads = defaultThreadCount())
+{
+    MappedFile file(path);
+    const char *begin = file.data();
+    const char *end = begin + file.size();
+    auto nextLine = [&](const char *p)
+    {
+        p = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        return p ? p + 1 : end;
+    };
+
+    const char *lineEnd = nextLine(begin);
+    std::string banner(begin, lineEnd);
+    for (char &c : banner)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (banner.rfind("%%matrixmarket", 0) != 0 || banner.find("matrix") == std::string::npos)
+        throw std::invalid_argument("Not a Matrix Market file: " + path);
+    if (banner.find("coordinate") == std::string::npos)
+        throw std::invalid_argument("Only coordinate Matrix Market files are supported");
+    if (banner.find("complex") != std::string::npos)
+        throw std::invalid_argument("Complex Matrix Market files are not supported");
+    bool pattern = banner.find("pattern") != std::string::npos;
+    bool symmetric = banner.find(" symmetric") != std::string::npos;
+    bool skew = banner.find("skew-symmetric") != std::string::npos;
+
+    const char *p = lineEnd;
+    while (p < end && (*p == '%' || *p == '\n' || *p == '\r'))
+        p = nextLine(p);
+
+    auto skipSpaces = [&](const char *q)
+    {
+        while (q < end && (*q == ' ' || *q == '\t' || *q == '\r'))
+            ++q;
+        return q;
+    };
+    auto parseIndex = [&](const char *&q, size_t &value)
+    {
+        q = skipSpaces(q);
+        auto result = std::from_chars(q, end, value);
+        if (result.ec != std::errc())
+            throw std::invalid_argument("Malformed Matrix Market entry");
+        q = result.ptr;
+    };
+
+    size_t rows, cols, declared;
+    parseIndex(p, rows);
+    parseIndex(p, cols);
+    parseIndex(p, declared);
+    p = nextLine(p);
+
+    // Границы частей сдвигаются к началу следующей строки
+    size_t parts = std::max<size_t>(1, std::min(threads, static_cast<size_t>(end - p) / (1 << 16) + 1));
+    std::vector<const char *> bounds(parts + 1, end);
+    bounds[0] = p;
+    for (size_t t = 1; t < parts; ++t)
+    {
+        const char *guess = p + (end - p) * t / parts;
+        bounds[t] = std::max(bounds[t - 1], guess == p ? p : nextLine(guess - 1));
+    }
+
+    TripletBuilder<T> builder(rows, cols);
+    std::atomic<size_t> parsed(0);
+    std::vector<std::string> errors(parts);
+    auto parseChunk = [&](size_t t)
+    {
+        try
+        {
+            auto appender = builder.appender((declared / parts + 1) * (symmetric || skew ? 2 : 1));
+            size_t count = 0;
+            for (const char *q = bounds[t]; q < bounds[t + 1]; q = nextLine(q))
+            {
+                const char *first = skipSpaces(q);
+                if (first >= end || *first == '\n' || *first == '%')
+                    continue;
+                size_t row, col;
+                parseIndex(q, row);
+                parseIndex(q, col);
+                T value = 1;
+                if (!pattern)
+                {
+                    q = skipSpaces(q);
+                    double parsedValue;
+                    auto result = std::from_chars(q, end, parsedValue);
+                    if (result.ec != std::errc())
+                        throw std::invalid_argument("Malformed Matrix Market entry");
+                    q = result.ptr;
+                    value = static_cast<T>(parsedValue);
+                }
+                if (row == 0 || col == 0)
+                    throw std::out_of_range("Matrix Market indices are 1-based");
+                appender.add(row - 1, col - 1, value);
+                if ((symmetric || skew) && row != col)
+                    appender.add(col - 1, row - 1, skew ? -value : value);
+                ++count;
+            }
+            parsed += count;
+        }
+        catch (const std::exception &e)
+        {
+            errors[t] = e.what();
+        }
+    };
+    runParallel(parts, parseChunk);
+    for (const std::string &error : errors)
+        if (!error.empty())
+            throw std::invalid_argument(error);
+    if (parsed != declared)
+        throw std::invalid_argument("Matrix Market entry count does not match the header");
+    return builder.build(threads);
+}
+
+template <typename T>
+void writeMatrixMarket(const std::string &path, const CSRMatrix<T> &matrix)
+{
+    std::ofstream out(path);
+    if (!out)
+        throw std::runtime_error("Cannot open file: " + path);
+    out.precision(17);
+    out << "%%MatrixMarket matrix coordinate " << (std::is_integral<T>::value ? "integer" : "real") << " general\n";
+    out << matrix.getRows() << " " << matrix.getCols() << " " << matrix.nonZeros() << "\n";
+    for (size_t i = 0; i < matrix.getRows(); ++i)
+        for (size_t k = matrix.rowPtr()[i]; k < matrix.rowPtr()[i + 1]; ++k)
+            out << i + 1 << " " << matrix.colIdx()[k] + 1 << " " << matrix.getValues()[k] << "\n";
+}
+
+// Двоичный снимок: заголовок и массивы, выровненные по 64 байта. Индексы хранятся
+// как uint64_t в порядке байтов машины, поэтому отображённый файл используется
+// напрямую, без разбора и копирования.
+struct SnapshotHeader
+{
+    char magic[8];          // "SPSNAP1"
+    uint32_t byteOrder;     // 0x01020304 в порядке байтов записавшей машины
+    uint32_t kind;          // 1 — матрица CSR, 2 — сжатый вектор
+    uint32_t valueSize;     // sizeof(T)
+    uint32_t valueIsFloat;  // 1 — число с плавающей точкой
+    uint64_t rows, cols;    // для вектора cols = 1
+    uint64_t nonZeros;
+    uint64_t offsets[3];    // смещения массивов: row_ptr/indices, col_idx, values
+};
+
+namespace snapshot_detail
+{
+    constexpr uint32_t byteOrderMark = 0x01020304;
+    constexpr uint64_t alignment = 64;
+    constexpr uint32_t matrixKind = 1, vectorKind = 2;
+
+    inline uint64_t alignUp(uint64_t offset) { return (offset + alignment - 1) / alignment * alignment; }
+
+    template <typename T>
+    SnapshotHeader makeHeader(uint32_t kind, uint64_t rows, uint64_t cols, uint64_t nonZeros)
+    {
+        SnapshotHeader header{};
+        std::memcpy(header.magic, "SPSNAP1", 8);
+        header.byteOrder = byteOrderMark;
+        header.kind = kind;
+        header.valueSize = sizeof(T);
+        header.valueIsFloat = std::is_floating_point<T>::value ? 1 : 0;
+        header.rows = rows;
+        header.cols = cols;
+        header.nonZeros = nonZeros;
+        return header;
+    }
+
+    inline void writeArray(std::ofstream &out, uint64_t &offset, const void *data, uint64_t bytes)
+    {
+        static const char padding[alignment] = {};
+        uint64_t aligned = alignUp(offset);
+        out.write(padding, static_cast<std::streamsize>(aligned - offset));
+        out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        offset = aligned + bytes;
+    }
+
+    // Массив из count элементов по elementSize байт, начинающийся с offset, лежит после
+    // заголовка, выровнен и целиком помещается в файл; проверка не переполняется
+    inline bool sectionFits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize)
+    {
+        return offset % alignment == 0 && offset >= sizeof(SnapshotHeader) && offset <= fileSize &&
+               count <= (fileSize - offset) / elementSize;
+    }
+
+    // Полная проверка CSR: row_ptr начинается с нуля, не убывает и заканчивается nnz,
+    // столбцы каждой строки меньше cols и строго возрастают
+    inline void checkCompressedRows(const uint64_t *row_ptr, const uint64_t *col_idx, uint64_t rows, uint64_t cols,
+                                    uint64_t nnz)
+    {
+        if (row_ptr[0] != 0 || row_ptr[rows] != nnz)
+            throw std::invalid_argument("Snapshot row pointers are inconsistent");
+        for (uint64_t i = 0; i < rows; ++i)
+            if (row_ptr[i] > row_ptr[i + 1])
+                throw std::invalid_argument("Snapshot row pointers are inconsistent");
+        for (uint64_t i = 0; i < rows; ++i)
+            for (uint64_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                if (col_idx[k] >= cols || (k > row_ptr[i] && col_idx[k - 1] >= col_idx[k]))
+                    throw std::invalid_argument("Snapshot column indices are inconsistent");
+    }
+
+    inline void checkIndices(const uint64_t *indices, uint64_t count, uint64_t size)
+    {
+        for (uint64_t k = 0; k < count; ++k)
+            if (indices[k] >= size || (k > 0 && indices[k - 1] >= indices[k]))
+                throw std::invalid_argument("Snapshot indices are inconsistent");
+    }
+
+    template <typename T>
+    const SnapshotHeader &validate(const MappedFile &file, uint32_t kind)
+    {
+        if (file.size() < sizeof(SnapshotHeader))
+            throw std::invalid_argument("Snapshot file is truncated");
+        const SnapshotHeader &header = *reinterpret_cast<const SnapshotHeader *>(file.data());
+        if (std::memcmp(header.magic, "SPSNAP1", 8) != 0)
+            throw std::invalid_argument("Not a sparse snapshot file");
+        if (header.byteOrder != byteOrderMark)
+            throw std::invalid_argument("Snapshot was written with a different byte order");
+        if (header.kind != kind)
+            throw std::invalid_argument("Snapshot holds a different container kind");
+        if (header.valueSize != sizeof(T) || header.valueIsFloat != (std::is_floating_point<T>::value ? 1u : 0u))
+            throw std::invalid_argument("Snapshot value type does not match");
+        if (kind == matrixKind && header.rows == std::numeric_limits<uint64_t>::max())
+            throw std::invalid_argument("Snapshot dimensions are invalid");
+        uint64_t indexCount = kind == matrixKind ? header.rows + 1 : header.nonZeros;
+        if (!sectionFits(header.offsets[0], indexCount, sizeof(uint64_t), file.size()) ||
+            !sectionFits(header.offsets[2], header.nonZeros, sizeof(T), file.size()) ||
+            (kind == matrixKind && !sectionFits(header.offsets[1], header.nonZeros, sizeof(uint64_t), file.size())))
+            throw std::invalid_argument("Snapshot sections do not fit the file");
+        return header;
+    }
+}
+
+template <typename T>
+void saveSnapshot(const std::string &path, const CSRMatrix<T> &matrix)
+{
+    static_assert(sizeof(size_t) == sizeof(uint64_t), "Snapshots require 64-bit size_t");
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("Cannot open file: " + path);
+    SnapshotHeader header = snapshot_detail::makeHeader<T>(snapshot_detail::matrixKind, matrix.getRows(),
+                                                           matrix.getCols(), matrix.nonZeros());
+    uint64_t offset = sizeof(SnapshotHeader);
+    header.offsets[0] = snapshot_detail::alignUp(offset);
+    header.offsets[1] = snapshot_detail::alignUp(header.offsets[0] + (matrix.getRows() + 1) * sizeof(uint64_t));
+    header.offsets[2] = snapshot_detail::alignUp(header.offsets[1] + matrix.nonZeros() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    snapshot_detail::writeArray(out, offset, matrix.rowPtr().data(), (matrix.getRows() + 1) * sizeof(uint64_t));
+    snapshot_detail::writeArray(out, offset, matrix.colIdx().data(), matrix.nonZeros() * sizeof(uint64_t));
+    snapshot_detail::writeArray(out, offset, matrix.getValues().data(), matrix.nonZeros() * sizeof(T));
+    if (!out)
+        throw std::runtime_error("Cannot write snapshot: " + path);
+}
+
+template <typename T>
+void saveSnapshot(const std::string &path, const CompressedVector<T> &vec)
+{
+    static_assert(sizeof(size_t) == sizeof(uint64_t), "Snapshots require 64-bit size_t");
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("Cannot open file: " + path);
+    SnapshotHeader header = snapshot_detail::makeHeader<T>(snapshot_detail::vectorKind, vec.getSize(), 1,
+                                                           vec.nonZeros());
+    uint64_t offset = sizeof(SnapshotHeader);
+    header.offsets[0] = snapshot_detail::alignUp(offset);
+    header.offsets[1] = header.offsets[0];
+    header.offsets[2] = snapshot_detail::alignUp(header.offsets[0] + vec.nonZeros() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    snapshot_detail::writeArray(out, offset, vec.getIndices().data(), vec.nonZeros() * sizeof(uint64_t));
+    snapshot_detail::writeArray(out, offset, vec.getValues().data(), vec.nonZeros() * sizeof(T));
+    if (!out)
+        throw std::runtime_error("Cannot write snapshot: " + path);
+}
+
+template <typename T>
+void saveSnapshot(const std::string &path, const SparseMatrix<T> &matrix)
+{
+    saveSnapshot(path, CSRMatrix<T>(matrix));
+}
+
+template <typename T>
+void saveSnapshot(const std::string &path, const SparseVector<T> &vec)
+{
+    saveSnapshot(path, CompressedVector<T>(vec));
+}
+
+// Проверка снимка при открытии. Full проходит по всем индексам (row_ptr не убывает,
+// индексы меньше размеров и упорядочены) и подгружает их страницы; Trusted ограничивается
+// заголовком, границами секций и row_ptr[rows] == nnz — для снимков, записанных этой же
+// программой, когда важно открытие за O(1). С повреждённым доверенным снимком
+// поведение не определено.
+enum class SnapshotCheck
+{
+    Full,
+    Trusted
+};
+
+// CSR-матрица, работающая прямо с отображённым снимком. Страницы файла подгружаются
+// системой при первом обращении; время открытия определяется выбранной проверкой.
+template <typename T>
+class SnapshotMatrix
+{
+private:
+    MappedFile file;
+    size_t rows, cols, nnz;
+    const uint64_t *row_ptr;
+    const uint64_t *col_idx;
+    const T *values;
+
+public:
+    explicit SnapshotMatrix(const std::string &path, SnapshotCheck check = SnapshotCheck::Full) : file(path)
+    {
+        const SnapshotHeader &header = snapshot_detail::validate<T>(file, snapshot_detail::matrixKind);
+        rows = header.rows;
+        cols = header.cols;
+        nnz = header.nonZeros;
+        row_ptr = reinterpret_cast<const uint64_t *>(file.data() + header.offsets[0]);
+        col_idx = reinterpret_cast<const uint64_t *>(file.data() + header.offsets[1]);
+        values = reinterpret_cast<const T *>(file.data() + header.offsets[2]);
+        if (check == SnapshotCheck::Full)
+            snapshot_detail::checkCompressedRows(row_ptr, col_idx, rows, cols, nnz);
+        else if (row_ptr[rows] != nnz)
+            throw std::invalid_argument("Snapshot row pointers are inconsistent");
+    }
+
+    size_t getRows() const { return rows; }
+    size_t getCols() const { return cols; }
+    size_t nonZeros() const { return nnz; }
+
+    const uint64_t *rowPtr() const { return row_ptr; }
+    const uint64_t *colIdx() const { return col_idx; }
+    const T *getValues() const { return values; }
+
+    T get(size_t row, size_t col) const
+    {
+        if (row >= rows || col >= cols)
+            throw std::out_of_range("Index out of range");
+        const uint64_t *first = col_idx + row_ptr[row];
+        const uint64_t *last = col_idx + row_ptr[row + 1];
+        const uint64_t *it = std::lower_bound(first, last, static_cast<uint64_t>(col));
+        if (it != last && *it == col)
+            return values[it - col_idx];
+        return 0;
+    }
+
+    std::vector<T> operator*(const std::vector<T> &vec) const
+    {
+        if (cols != vec.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<T> result(rows);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            Accumulator<T> sum = 0;
+            for (uint64_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                sum += static_cast<Accumulator<T>>(values[k]) * vec[col_idx[k]];
+            result[i] = static_cast<T>(sum);
+        }
+        return result;
+    }
+
+    // Копия в памяти, например для изменения
+    CSRMatrix<T> toCSR() const
+    {
+        return CSRMatrix<T>(rows, cols, std::vector<size_t>(row_ptr, row_ptr + rows + 1),
+                            std::vector<size_t>(col_idx, col_idx + nnz), std::vector<T>(values, values + nnz));
+    }
+};
+
+template <typename T>
+class SnapshotVector
+{
+private:
+    MappedFile file;
+    size_t size, nnz;
+    const uint64_t *indices;
+    const T *values;
+
+public:
+    explicit SnapshotVector(const std::string &path, SnapshotCheck check = SnapshotCheck::Full) : file(path)
+    {
+        const SnapshotHeader &header = snapshot_detail::validate<T>(file, snapshot_detail::vectorKind);
+        size = header.rows;
+        nnz = header.nonZeros;
+        indices = reinterpret_cast<const uint64_t *>(file.data() + header.offsets[0]);
+        values = reinterpret_cast<const T *>(file.data() + header.offsets[2]);
+        if (check == SnapshotCheck::Full)
+            snapshot_detail::checkIndices(indices, nnz, size);
+    }
+
+    size_t getSize() const { return size; }
+    size_t nonZeros() const { return nnz; }
+
+    const uint64_t *getIndices() const { return indices; }
+    const T *getValues() const { return values; }
+
+    T get(size_t index) const
+    {
+        const uint64_t *it = std::lower_bound(indices, indices + nnz, static_cast<uint64_t>(index));
+        if (it != indices + nnz && *it == index)
+            return values[it - indices];
+        return 0;
+    }
+
+    T dot(const std::vector<T> &dense) const
+    {
+        if (dense.size() != size)
+            throw std::invalid_argument("Vector sizes do not match");
+        Accumulator<T> result = 0;
+        for (size_t k = 0; k < nnz; ++k)
+            result += static_cast<Accumulator<T>>(values[k]) * dense[indices[k]];
+        return static_cast<T>(result);
+    }
+
+    CompressedVector<T> toCompressed() const
+    {
+        return CompressedVector<T>(size, std::vector<size_t>(indices, indices + nnz),
+                                   std::vector<T>(values, values + nnz));
+    }
+};
+
+#endif // MATRIX_IO_HPP
@@ -0,0 +1,71 @@
+#ifndef MEMORY_RESOURCE_HPP
+#define MEMORY_RESOURCE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <utility>
+
+// Источники памяти для SparseVector/SparseMatrix (std::pmr). Контейнер получает
+// std::pmr::memory_resource* в конструкторе; из него выделяются хеш-таблицы,
+// строки и массивы значений, а также промежуточные результаты операций над контейнером.
+//
+//   ArenaResource      — монотонная арена: выделение сдвигом указателя, освобождение
+//                        только целиком при уничтожении арены. Для короткоживущих результатов.
+//   threadPoolResource — пул блоков одного размера для текущего потока. Для долгоживущих
+//                        матриц с частыми вставками и удалениями; контейнер должен
+//                        использоваться и уничтожаться в том же потоке до его завершения.
+//   CountingResource   — обёртка, считающая байты и число выделений через неё.
+
+using ArenaResource = std::pmr::monotonic_buffer_resource;
+
+inline std::pmr::memory_resource *threadPoolResource()
+{
+    thread_local std::pmr::unsynchronized_pool_resource pool;
+    return &pool;
+}
+
+class CountingResource : public std::pmr::memory_resource
+{
+private:
+    std::pmr::memory_resource *upstream;
+    size_t inUse = 0;
+    size_t peak = 0;
+    size_t allocations = 0;
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        void *pointer = upstream->allocate(bytes, alignment);
+        inUse += bytes;
+        peak = std::max(peak, inUse);
+        ++allocations;
+        return pointer;
+    }
+
+    void do_deallocate(void *pointer, size_t bytes, size_t alignment) override
+    {
+        upstream->deallocate(pointer, bytes, alignment);
+        inUse -= bytes;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+public:
+    explicit CountingResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : upstream(upstream) {}
+
+    size_t bytesInUse() const { return inUse; }
+    size_t peakBytes() const { return peak; }
+    size_t allocationCount() const { return allocations; }
+
+    // Начало нового замера: счётчик выделений обнуляется, пик — текущий объём.
+    // Цикл без выделений памяти: resetStatistics(), цикл, затем allocationCount() == 0
+    void resetStatistics()
+    {
+        allocations = 0;
+        peak = inUse;
+    }
+};
+
+#endif // MEMORY_RESOURCE_HPP
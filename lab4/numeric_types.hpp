@@ -0,0 +1,34 @@
+#ifndef NUMERIC_TYPES_HPP
+#define NUMERIC_TYPES_HPP
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+// Тип, в котором накапливаются суммы произведений значений T (скалярное произведение,
+// умножение матрицы на вектор): значения float хранятся вдвое компактнее, но складываются
+// в double, чтобы ошибка округления не росла с длиной строки.
+template <typename T>
+struct AccumulatorOf
+{
+    using type = T;
+};
+
+template <>
+struct AccumulatorOf<float>
+{
+    using type = double;
+};
+
+template <typename T>
+using Accumulator = typename AccumulatorOf<T>::type;
+
+// Размерность контейнера с индексами типа Index: все индексы меньше dimension должны помещаться в Index
+template <typename Index>
+void checkIndexRange(size_t dimension)
+{
+    if (dimension > static_cast<size_t>(std::numeric_limits<Index>::max()))
+        throw std::out_of_range("Dimension exceeds the range of the index type");
+}
+
+#endif // NUMERIC_TYPES_HPP
@@ -0,0 +1,268 @@
+#ifndef PARALLEL_SPMV_HPP
+#define PARALLEL_SPMV_HPP
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "csr_matrix.hpp"
+#include "thread_pool.hpp"
+
+// Разбиение строк на parts непрерывных диапазонов с примерно равной работой.
+// Вес строки — число её ненулевых элементов плюс один (запись результата),
+// поэтому пустые строки тоже распределяются равномерно.
+// Возвращает границы: диапазон p — строки [bounds[p], bounds[p + 1]).
+inline std::vector<size_t> partitionRowsByNonZeros(const std::vector<size_t> &row_ptr, size_t parts)
+{
+    size_t rows = row_ptr.size() - 1;
+    parts = std::max<size_t>(1, std::min(parts, std::max<size_t>(rows, 1)));
+    size_t total = row_ptr[rows] + rows;
+    std::vector<size_t> bounds(parts + 1, rows);
+    bounds[0] = 0;
+    for (size_t p = 1; p < parts; ++p)
+    {
+        // Первая строка, у которой накопленный вес row_ptr[i] + i не меньше цели
+        size_t target = total * p / parts;
+        size_t lo = bounds[p - 1], hi = rows;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (row_ptr[mid] + mid < target)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        bounds[p] = lo;
+    }
+    return bounds;
+}
+
+// Вызов f(p) для p = 0 .. parts - 1 задачами общего пула (sharedThreadPool); часть 0 выполняет
+// вызывающий поток. Части не должны ждать друг друга: при частях больше, чем потоков, они
+// выполняются по очереди. Исключение из части пробрасывается после завершения всех частей
+template <typename F>
+void runParallel(size_t parts, F f)
+{
+    if (parts <= 1)
+    {
+        if (parts == 1)
+            f(0);
+        return;
+    }
+    sharedThreadPool().parallelFor(parts, f);
+}
+
+// Число частей для алгоритмов с буфером длины cols на каждый поток: не больше nnz / cols,
+// чтобы буферы потоков в сумме не превышали объём самой матрицы
+inline size_t scatterParts(size_t threads, size_t nonZeros, size_t cols)
+{
+    return std::max<size_t>(1, std::min(threads, cols ? nonZeros / cols : threads));
+}
+
+// Умножение CSR-матрицы на плотный вектор с фиксированным разбиением строк.
+// Разбиение вычисляется один раз и переиспользуется в итерационных методах.
+// Каждый поток пишет в свой непересекающийся диапазон y, поэтому блокировки не нужны.
+// Объект хранит ссылку на матрицу и не должен её переживать.
+template <typename T, typename Index = size_t>
+class ParallelSpMV
+{
+private:
+    const CSRMatrix<T, Index> &matrix;
+    std::vector<size_t> bounds;
+
+    void multiplyRows(const std::vector<T> &x, std::vector<T> &y, size_t first, size_t last) const
+    {
+        const size_t *ptr = matrix.rowPtr().data();
+        const Index *idx = matrix.colIdx().data();
+        const T *val = matrix.getValues().data();
+        const T *in = x.data();
+        T *out = y.data();
+        for (size_t i = first; i < last; ++i)
+        {
+            Accumulator<T> sum = 0;
+            for (size_t k = ptr[i]; k < ptr[i + 1]; ++k)
+                sum += static_cast<Accumulator<T>>(val[k]) * in[idx[k]];
+            out[i] = static_cast<T>(sum);
+        }
+    }
+
+public:
+    ParallelSpMV(const CSRMatrix<T, Index> &matrix, size_t threads = defaultThreadCount())
+        : matrix(matrix), bounds(partitionRowsByNonZeros(matrix.rowPtr(), threads)) {}
+    ParallelSpMV(CSRMatrix<T, Index> &&, size_t = defaultThreadCount()) = delete;
+
+    size_t threadCount() const { return bounds.size() - 1; }
+    const std::vector<size_t> &partition() const { return bounds; }
+
+    // y = A * x; y должен иметь размер A.getRows()
+    void multiply(const std::vector<T> &x, std::vector<T> &y) const
+    {
+        if (matrix.getCols() != x.size() || matrix.getRows() != y.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        runParallel(threadCount(), [&](size_t p)
+                    { multiplyRows(x, y, bounds[p], bounds[p + 1]); });
+    }
+
+    std::vector<T> operator*(const std::vector<T> &x) const
+    {
+        std::vector<T> y(matrix.getRows());
+        multiply(x, y);
+        return y;
+    }
+
+    SparseVector<T> operator*(const SparseVector<T> &vec) const
+    {
+        if (matrix.getCols() != vec.getSize())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<T> x(vec.getSize(), T(0));
+        vec.forEach([&](size_t index, T value)
+                    { x[index] = value; });
+        std::vector<T> y = *this * x;
+        SparseVector<T> result(y.size());
+        for (size_t i = 0; i < y.size(); ++i)
+            result.set(i, y[i]);
+        return result;
+    }
+};
+
+// Однократное параллельное умножение: y = A * x
+template <typename T, typename Index>
+void spmvParallel(const CSRMatrix<T, Index> &matrix, const std::vector<T> &x, std::vector<T> &y,
+                  size_t threads = defaultThreadCount())
+{
+    ParallelSpMV<T, Index>(matrix, threads).multiply(x, y);
+}
+
+// y = A^T * x без построения A^T; y должен иметь размер A.getCols().
+// Потоки разбрасывают свои диапазоны строк в собственные буферы длины cols (в Accumulator<T>),
+// после чего буферы суммируются по непересекающимся диапазонам столбцов.
+template <typename T, typename Index>
+void spmvTransposeParallel(const CSRMatrix<T, Index> &matrix, const std::vector<T> &x, std::vector<T> &y,
+                           size_t threads = defaultThreadCount())
+{
+    using Sum = Accumulator<T>;
+    size_t cols = matrix.getCols();
+    if (matrix.getRows() != x.size() || cols != y.size())
+        throw std::invalid_argument("Matrix and vector dimensions do not match");
+    const size_t *ptr = matrix.rowPtr().data();
+    const Index *idx = matrix.colIdx().data();
+    const T *val = matrix.getValues().data();
+    std::vector<size_t> bounds = partitionRowsByNonZeros(matrix.rowPtr(), scatterParts(threads, matrix.nonZeros(), cols));
+    size_t parts = bounds.size() - 1;
+    std::vector<Sum> partial(parts * cols, Sum(0));
+    runParallel(parts, [&](size_t p)
+                {
+        Sum *out = partial.data() + p * cols;
+        for (size_t i = bounds[p]; i < bounds[p + 1]; ++i)
+        {
+            T xi = x[i];
+            if (xi == 0)
+                continue;
+            for (size_t k = ptr[i]; k < ptr[i + 1]; ++k)
+                out[idx[k]] += static_cast<Sum>(val[k]) * xi;
+        } });
+    runParallel(parts, [&](size_t p)
+                {
+        for (size_t c = cols * p / parts; c < cols * (p + 1) / parts; ++c)
+        {
+            Sum sum = partial[c];
+            for (size_t q = 1; q < parts; ++q)
+                sum += partial[q * cols + c];
+            y[c] = static_cast<T>(sum);
+        } });
+}
+
+namespace parallel_detail
+{
+    // Транспонирование CSR-массивов матрицы с cols столбцами параллельной сортировкой подсчётом.
+    // Каждый поток считает элементы по столбцам в своём диапазоне строк; по префиксным суммам
+    // в порядке (столбец, поток) он получает позиции записи и раскладывает свои элементы.
+    // Диапазоны потоков идут по возрастанию строк, поэтому строки внутри столбца отсортированы.
+    template <typename T, typename Index>
+    void transposeArrays(size_t cols, const std::vector<size_t> &ptr, const std::vector<Index> &idx,
+                         const std::vector<T> &val, size_t threads, std::vector<size_t> &outPtr,
+                         std::vector<Index> &outIdx, std::vector<T> &outVal)
+    {
+        checkIndexRange<Index>(ptr.size() - 1);
+        std::vector<size_t> bounds = partitionRowsByNonZeros(ptr, scatterParts(threads, val.size(), cols));
+        size_t parts = bounds.size() - 1;
+        // counts[p * cols + c]: число элементов столбца c у части p, затем её позиция записи
+        std::vector<size_t> counts(parts * cols, 0);
+        runParallel(parts, [&](size_t p)
+                    {
+            size_t *local = counts.data() + p * cols;
+            for (size_t k = ptr[bounds[p]]; k < ptr[bounds[p + 1]]; ++k)
+                ++local[idx[k]]; });
+
+        outPtr.assign(cols + 1, 0);
+        runParallel(parts, [&](size_t p)
+                    {
+            for (size_t c = cols * p / parts; c < cols * (p + 1) / parts; ++c)
+                for (size_t q = 0; q < parts; ++q)
+                    outPtr[c + 1] += counts[q * cols + c]; });
+        for (size_t c = 0; c < cols; ++c)
+            outPtr[c + 1] += outPtr[c];
+        runParallel(parts, [&](size_t p)
+                    {
+            for (size_t c = cols * p / parts; c < cols * (p + 1) / parts; ++c)
+            {
+                size_t offset = outPtr[c];
+                for (size_t q = 0; q < parts; ++q)
+                {
+                    size_t count = counts[q * cols + c];
+                    counts[q * cols + c] = offset;
+                    offset += count;
+                }
+            } });
+
+        outIdx.resize(val.size());
+        outVal.resize(val.size());
+        runParallel(parts, [&](size_t p)
+                    {
+            size_t *next = counts.data() + p * cols;
+            for (size_t i = bounds[p]; i < bounds[p + 1]; ++i)
+                for (size_t k = ptr[i]; k < ptr[i + 1]; ++k)
+                {
+                    size_t dest = next[idx[k]]++;
+                    outIdx[dest] = static_cast<Index>(i);
+                    outVal[dest] = val[k];
+                } });
+    }
+}
+
+// Параллельное транспонирование: O(nnz / threads + cols * threads)
+template <typename T, typename Index>
+CSRMatrix<T, Index> transposeParallel(const CSRMatrix<T, Index> &matrix, size_t threads = defaultThreadCount())
+{
+    std::vector<size_t> ptr;
+    std::vector<Index> idx;
+    std::vector<T> val;
+    parallel_detail::transposeArrays(matrix.getCols(), matrix.rowPtr(), matrix.colIdx(),
+                                     matrix.getValues(), threads, ptr, idx, val);
+    return CSRMatrix<T, Index>(matrix.getCols(), matrix.getRows(), std::move(ptr), std::move(idx), std::move(val));
+}
+
+// Параллельные преобразования CSR <-> CSC (массивы одного формата — транспонированные массивы другого)
+template <typename T, typename Index>
+CSCMatrix<T, Index> toCSCParallel(const CSRMatrix<T, Index> &matrix, size_t threads = defaultThreadCount())
+{
+    std::vector<size_t> ptr;
+    std::vector<Index> idx;
+    std::vector<T> val;
+    parallel_detail::transposeArrays(matrix.getCols(), matrix.rowPtr(), matrix.colIdx(),
+                                     matrix.getValues(), threads, ptr, idx, val);
+    return CSCMatrix<T, Index>(matrix.getRows(), matrix.getCols(), std::move(ptr), std::move(idx), std::move(val));
+}
+
+template <typename T, typename Index>
+CSRMatrix<T, Index> toCSRParallel(const CSCMatrix<T, Index> &matrix, size_t threads = defaultThreadCount())
+{
+    std::vector<size_t> ptr;
+    std::vector<Index> idx;
+    std::vector<T> val;
+    parallel_detail::transposeArrays(matrix.getRows(), matrix.colPtr(), matrix.rowIdx(),
+                                     matrix.getValues(), threads, ptr, idx, val);
+    return CSRMatrix<T, Index>(matrix.getRows(), matrix.getCols(), std::move(ptr), std::move(idx), std::move(val));
+}
+
+#endif // PARALLEL_SPMV_HPP
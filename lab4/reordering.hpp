@@ -0,0 +1,299 @@
+#ifndef REORDERING_HPP
+#define REORDERING_HPP
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+#include "csr_matrix.hpp"
+
+// Перенумерация строк и столбцов квадратной матрицы для SpMV с локальным доступом к x.
+// Перестановка задаётся как perm[новый номер] = старый номер; inversePermutation даёт
+// обратную (inverse[старый] = новый). permute(A, perm) строит B = P A P^T:
+// B(i, j) = A(perm[i], perm[j]). Для A x = y в новой нумерации умножают
+// B * permuteVector(x, perm), а результат возвращают к исходной через unpermuteVector.
+//
+//   reverseCuthillMcKee — уменьшение ширины ленты: соседние по графу строки получают
+//                         близкие номера, и обращения к x в строке идут к близким адресам
+//   degreeOrdering      — строки с наибольшим числом элементов первыми; для степенных
+//                         графов часто используемые элементы x оказываются рядом
+
+namespace reordering_detail
+{
+    // Граф симметризованного портрета A + A^T без диагонали в виде массивов смежности
+    template <typename T>
+    void symmetricGraph(const CSRMatrix<T> &matrix, std::vector<size_t> &ptr, std::vector<size_t> &adjacent)
+    {
+        size_t n = matrix.getRows();
+        if (n != matrix.getCols())
+            throw std::invalid_argument("Matrix must be square");
+        const std::vector<size_t> &row_ptr = matrix.rowPtr();
+        const std::vector<size_t> &col_idx = matrix.colIdx();
+        ptr.assign(n + 1, 0);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                if (col_idx[k] != i)
+                {
+                    ++ptr[i + 1];
+                    ++ptr[col_idx[k] + 1];
+                }
+        for (size_t i = 0; i < n; ++i)
+            ptr[i + 1] += ptr[i];
+        adjacent.resize(ptr[n]);
+        std::vector<size_t> next(ptr.begin(), ptr.end() - 1);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                if (col_idx[k] != i)
+                {
+                    adjacent[next[i]++] = col_idx[k];
+                    adjacent[next[col_idx[k]]++] = i;
+                }
+        // Симметричные пары (i, j) и (j, i) дают повторы; они удаляются с уплотнением
+        size_t write = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto first = adjacent.begin() + ptr[i], last = adjacent.begin() + ptr[i + 1];
+            std::sort(first, last);
+            last = std::unique(first, last);
+            size_t begin = write;
+            for (auto it = first; it != last; ++it)
+                adjacent[write++] = *it;
+            ptr[i] = begin;
+        }
+        ptr[n] = write;
+        adjacent.resize(write);
+    }
+
+    // Обход в ширину из start по вершинам с mark[v] != stamp. В order дописываются вершины
+    // по уровням (соседи каждой вершины — в порядке возрастания степени); в lastLevel
+    // возвращается позиция в order первой вершины последнего уровня, результат — число уровней.
+    inline size_t breadthFirst(size_t start, const std::vector<size_t> &ptr, const std::vector<size_t> &adjacent,
+                               std::vector<size_t> &mark, size_t stamp, std::vector<size_t> &order, size_t &lastLevel)
+    {
+        size_t head = order.size(), levels = 0;
+        order.push_back(start);
+        mark[start] = stamp;
+        while (head < order.size())
+        {
+            size_t levelEnd = order.size();
+            lastLevel = head;
+            ++levels;
+            for (; head < levelEnd; ++head)
+            {
+                size_t v = order[head];
+                size_t firstNew = order.size();
+                for (size_t k = ptr[v]; k < ptr[v + 1]; ++k)
+                    if (mark[adjacent[k]] != stamp)
+                    {
+                        mark[adjacent[k]] = stamp;
+                        order.push_back(adjacent[k]);
+                    }
+                std::sort(order.begin() + firstNew, order.end(), [&](size_t a, size_t b)
+                          { return ptr[a + 1] - ptr[a] < ptr[b + 1] - ptr[b]; });
+            }
+        }
+        return levels;
+    }
+}
+
+// Обратная перестановка: inverse[perm[i]] = i
+inline std::vector<size_t> inversePermutation(const std::vector<size_t> &perm)
+{
+    std::vector<size_t> inverse(perm.size(), perm.size());
+    for (size_t i = 0; i < perm.size(); ++i)
+    {
+        if (perm[i] >= perm.size() || inverse[perm[i]] != perm.size())
+            throw std::invalid_argument("Invalid permutation");
+        inverse[perm[i]] = i;
+    }
+    return inverse;
+}
+
+// Обратный порядок Катхилла — Макки. Каждая компонента связности нумеруется обходом
+// в ширину из псевдопериферийной вершины (эвристика Джорджа — Лю: повторный обход
+// из вершины наименьшей степени на последнем уровне, пока растёт число уровней).
+template <typename T>
+std::vector<size_t> reverseCuthillMcKee(const CSRMatrix<T> &matrix)
+{
+    using namespace reordering_detail;
+    std::vector<size_t> ptr, adjacent;
+    symmetricGraph(matrix, ptr, adjacent);
+    size_t n = matrix.getRows();
+    auto degree = [&](size_t v)
+    { return ptr[v + 1] - ptr[v]; };
+
+    std::vector<size_t> byDegree(n);
+    std::iota(byDegree.begin(), byDegree.end(), 0);
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&](size_t a, size_t b)
+                     { return degree(a) < degree(b); });
+
+    // mark[v] == 1 — вершина пронумерована; пробные обходы используют метки 2, 3, ...
+    // Компоненты нумеруются целиком, поэтому пробный обход не заходит в пронумерованные вершины
+    std::vector<size_t> mark(n, 0), order, trial;
+    order.reserve(n);
+    size_t stamp = 1;
+    // Число уровней обхода из start и вершина наименьшей степени на последнем уровне
+    auto probe = [&](size_t start, size_t &farthest)
+    {
+        trial.clear();
+        size_t last = 0;
+        size_t levels = breadthFirst(start, ptr, adjacent, mark, ++stamp, trial, last);
+        farthest = trial[last];
+        for (size_t k = last; k < trial.size(); ++k)
+            if (degree(trial[k]) < degree(farthest))
+                farthest = trial[k];
+        return levels;
+    };
+    for (size_t candidate : byDegree)
+    {
+        if (mark[candidate] == 1)
+            continue;
+        size_t start = candidate, farthest, next;
+        size_t levels = probe(start, farthest);
+        while (farthest != start)
+        {
+            size_t farthestLevels = probe(farthest, next);
+            if (farthestLevels <= levels)
+                break;
+            start = farthest;
+            levels = farthestLevels;
+            farthest = next;
+        }
+        size_t last;
+        breadthFirst(start, ptr, adjacent, mark, 1, order, last);
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+template <typename T, typename Index>
+std::vector<size_t> reverseCuthillMcKee(const SparseMatrix<T, Index> &matrix)
+{
+    return reverseCuthillMcKee(CSRMatrix<T>(matrix));
+}
+
+// Строки по убыванию числа ненулевых элементов; при равенстве сохраняется исходный порядок
+template <typename T>
+std::vector<size_t> degreeOrdering(const CSRMatrix<T> &matrix)
+{
+    if (matrix.getRows() != matrix.getCols())
+        throw std::invalid_argument("Matrix must be square");
+    const std::vector<size_t> &row_ptr = matrix.rowPtr();
+    std::vector<size_t> perm(matrix.getRows());
+    std::iota(perm.begin(), perm.end(), 0);
+    std::stable_sort(perm.begin(), perm.end(), [&](size_t a, size_t b)
+                     { return row_ptr[a + 1] - row_ptr[a] > row_ptr[b + 1] - row_ptr[b]; });
+    return perm;
+}
+
+template <typename T, typename Index>
+std::vector<size_t> degreeOrdering(const SparseMatrix<T, Index> &matrix)
+{
+    return degreeOrdering(CSRMatrix<T>(matrix));
+}
+
+// Ширина ленты: наибольшее |i - j| по ненулевым элементам
+template <typename T>
+size_t bandwidth(const CSRMatrix<T> &matrix)
+{
+    size_t width = 0;
+    for (size_t i = 0; i < matrix.getRows(); ++i)
+        for (size_t k = matrix.rowPtr()[i]; k < matrix.rowPtr()[i + 1]; ++k)
+        {
+            size_t col = matrix.colIdx()[k];
+            width = std::max(width, col > i ? col - i : i - col);
+        }
+    return width;
+}
+
+// B = P A P^T: B(i, j) = A(perm[i], perm[j])
+template <typename T>
+CSRMatrix<T> permute(const CSRMatrix<T> &matrix, const std::vector<size_t> &perm)
+{
+    size_t n = matrix.getRows();
+    if (n != matrix.getCols() || perm.size() != n)
+        throw std::invalid_argument("Permutation size does not match the matrix");
+    std::vector<size_t> inverse = inversePermutation(perm);
+    const std::vector<size_t> &ptr = matrix.rowPtr();
+    const std::vector<size_t> &idx = matrix.colIdx();
+    const std::vector<T> &val = matrix.getValues();
+    std::vector<size_t> row_ptr(n + 1, 0), col_idx(idx.size());
+    std::vector<T> values(val.size());
+    std::vector<std::pair<size_t, T>> line;
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t old = perm[i];
+        line.clear();
+        for (size_t k = ptr[old]; k < ptr[old + 1]; ++k)
+            line.emplace_back(inverse[idx[k]], val[k]);
+        std::sort(line.begin(), line.end(), [](const auto &a, const auto &b)
+                  { return a.first < b.first; });
+        size_t write = row_ptr[i];
+        for (const auto &[col, value] : line)
+        {
+            col_idx[write] = col;
+            values[write++] = value;
+        }
+        row_ptr[i + 1] = write;
+    }
+    return CSRMatrix<T>(n, n, std::move(row_ptr), std::move(col_idx), std::move(values));
+}
+
+template <typename T, typename Index>
+SparseMatrix<T, Index> permute(const SparseMatrix<T, Index> &matrix, const std::vector<size_t> &perm)
+{
+    return SparseMatrix<T, Index>(permute(CSRMatrix<T>(matrix), perm).toSparseMatrix(), matrix.resource());
+}
+
+// x' = P x: x'[i] = x[perm[i]]
+template <typename T>
+std::vector<T> permuteVector(const std::vector<T> &vec, const std::vector<size_t> &perm)
+{
+    if (vec.size() != perm.size())
+        throw std::invalid_argument("Permutation size does not match the vector");
+    std::vector<T> result(vec.size());
+    for (size_t i = 0; i < perm.size(); ++i)
+        result[i] = vec[perm[i]];
+    return result;
+}
+
+// Обратно к исходной нумерации: x[perm[i]] = x'[i]
+template <typename T>
+std::vector<T> unpermuteVector(const std::vector<T> &vec, const std::vector<size_t> &perm)
+{
+    if (vec.size() != perm.size())
+        throw std::invalid_argument("Permutation size does not match the vector");
+    std::vector<T> result(vec.size());
+    for (size_t i = 0; i < perm.size(); ++i)
+        result[perm[i]] = vec[i];
+    return result;
+}
+
+template <typename T, typename Index>
+SparseVector<T, Index> permuteVector(const SparseVector<T, Index> &vec, const std::vector<size_t> &perm)
+{
+    if (vec.getSize() != perm.size())
+        throw std::invalid_argument("Permutation size does not match the vector");
+    std::vector<size_t> inverse = inversePermutation(perm);
+    SparseVector<T, Index> result(vec.getSize(), vec.resource());
+    vec.forEach([&](size_t index, T value)
+                { result.set(inverse[index], value); });
+    return result;
+}
+
+template <typename T, typename Index>
+SparseVector<T, Index> unpermuteVector(const SparseVector<T, Index> &vec, const std::vector<size_t> &perm)
+{
+    if (vec.getSize() != perm.size())
+        throw std::invalid_argument("Permutation size does not match the vector");
+    SparseVector<T, Index> result(vec.getSize(), vec.resource());
+    vec.forEach([&](size_t index, T value)
+                { result.set(perm[index], value); });
+    return result;
+}
+
+#endif // REORDERING_HPP
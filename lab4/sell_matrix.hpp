@@ -0,0 +1,289 @@
+#ifndef SELL_MATRIX_HPP
+#define SELL_MATRIX_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "csr_matrix.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SELL_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// Вариант ядра умножения SELL-матрицы на вектор (по возрастанию требований к процессору)
+enum class SellKernel
+{
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+inline const char *sellKernelName(SellKernel kernel)
+{
+    switch (kernel)
+    {
+    case SellKernel::AVX2:
+        return "AVX2";
+    case SellKernel::AVX512:
+        return "AVX-512";
+    default:
+        return "scalar";
+    }
+}
+
+// Лучшее ядро, поддерживаемое процессором (определяется один раз во время выполнения)
+inline SellKernel detectSellKernel()
+{
+#ifdef SELL_X86_KERNELS
+    static const SellKernel detected = []
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return SellKernel::AVX512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return SellKernel::AVX2;
+        return SellKernel::Scalar;
+    }();
+    return detected;
+#else
+    return SellKernel::Scalar;
+#endif
+}
+
+#ifdef SELL_X86_KERNELS
+// Ядра обрабатывают один срез высотой C: values и col хранятся по столбцам среза,
+// элемент j строки r лежит по смещению j * C + r. Результат C строк пишется в out.
+// Gather с полной маской и нулевым источником вместо обычного, чтобы не читать
+// неинициализированный регистр.
+
+__attribute__((target("avx2,fma"))) inline void sellSliceAvx2(const double *values, const int32_t *col, size_t width,
+                                                                size_t C, const double *x, double *out)
+{
+    for (size_t lane = 0; lane < C; lane += 4)
+    {
+        __m256d acc = _mm256_setzero_pd();
+        for (size_t j = 0; j < width; ++j)
+        {
+            __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i *>(col + j * C + lane));
+            __m256d xv = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, idx, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+            acc = _mm256_fmadd_pd(_mm256_loadu_pd(values + j * C + lane), xv, acc);
+        }
+        _mm256_storeu_pd(out + lane, acc);
+    }
+}
+
+__attribute__((target("avx2,fma"))) inline void sellSliceAvx2(const float *values, const int32_t *col, size_t width,
+                                                                size_t C, const float *x, float *out)
+{
+    for (size_t lane = 0; lane < C; lane += 8)
+    {
+        __m256 acc = _mm256_setzero_ps();
+        for (size_t j = 0; j < width; ++j)
+        {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(col + j * C + lane));
+            __m256 xv = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), x, idx, _mm256_castsi256_ps(_mm256_set1_epi32(-1)), 4);
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(values + j * C + lane), xv, acc);
+        }
+        _mm256_storeu_ps(out + lane, acc);
+    }
+}
+
+__attribute__((target("avx512f"))) inline void sellSliceAvx512(const double *values, const int32_t *col, size_t width,
+                                                                 size_t C, const double *x, double *out)
+{
+    for (size_t lane = 0; lane < C; lane += 8)
+    {
+        __m512d acc = _mm512_setzero_pd();
+        for (size_t j = 0; j < width; ++j)
+        {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(col + j * C + lane));
+            __m512d xv = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, idx, x, 8);
+            acc = _mm512_fmadd_pd(_mm512_loadu_pd(values + j * C + lane), xv, acc);
+        }
+        _mm512_storeu_pd(out + lane, acc);
+    }
+}
+
+__attribute__((target("avx512f"))) inline void sellSliceAvx512(const float *values, const int32_t *col, size_t width,
+                                                                 size_t C, const float *x, float *out)
+{
+    for (size_t lane = 0; lane < C; lane += 16)
+    {
+        __m512 acc = _mm512_setzero_ps();
+        for (size_t j = 0; j < width; ++j)
+        {
+            __m512i idx = _mm512_loadu_si512(col + j * C + lane);
+            __m512 xv = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, idx, x, 4);
+            acc = _mm512_fmadd_ps(_mm512_loadu_ps(values + j * C + lane), xv, acc);
+        }
+        _mm512_storeu_ps(out + lane, acc);
+    }
+}
+#endif
+
+// Разреженная матрица в формате SELL-C-σ (sliced ELLPACK).
+// Строки сортируются по убыванию длины внутри окон из sigma строк и группируются
+// в срезы по C строк; каждый срез дополняется нулями до длины самой длинной строки
+// и хранится по столбцам, так что C соседних строк обрабатываются одной SIMD-инструкцией.
+// Преобразование выполняется один раз, после чего матрицу можно умножать многократно.
+// Номера столбцов внутри срезов — int32_t (этого требует gather), Index — тип перестановки
+// строк, как у исходной CSRMatrix<T, Index>. Суммы строк накапливаются в T, без перехода
+// к Accumulator<T>: векторные ядра складывают float в регистрах float, и скалярное ядро
+// повторяет их, чтобы результат не зависел от выбранного ядра.
+template <typename T, typename Index = size_t>
+class SellMatrix
+{
+    static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value,
+                  "SellMatrix supports float and double only");
+
+private:
+    size_t rows, cols;
+    size_t C, sigma;
+    std::vector<Index> permutation;  // позиция в срезах -> исходная строка
+    std::vector<size_t> slice_ptr;   // начало среза в col_idx/values
+    std::vector<size_t> slice_width; // длина строк среза после дополнения
+    std::vector<int32_t> col_idx;
+    std::vector<T> values;
+
+    // Ширина SIMD-регистра в элементах T для ядра
+    static size_t laneCount(SellKernel kernel)
+    {
+        size_t bytes = kernel == SellKernel::AVX512 ? 64 : kernel == SellKernel::AVX2 ? 32
+                                                                                        : 1;
+        return std::max<size_t>(1, bytes / sizeof(T));
+    }
+
+    void multiplySlice(size_t slice, const T *x, T *out, SellKernel kernel) const
+    {
+        const T *val = values.data() + slice_ptr[slice];
+        const int32_t *col = col_idx.data() + slice_ptr[slice];
+        size_t width = slice_width[slice];
+#ifdef SELL_X86_KERNELS
+        if (kernel == SellKernel::AVX512)
+            return sellSliceAvx512(val, col, width, C, x, out);
+        if (kernel == SellKernel::AVX2)
+            return sellSliceAvx2(val, col, width, C, x, out);
+#else
+        (void)kernel;
+#endif
+        for (size_t r = 0; r < C; ++r)
+            out[r] = 0;
+        for (size_t j = 0; j < width; ++j)
+            for (size_t r = 0; r < C; ++r)
+                out[r] += val[j * C + r] * x[col[j * C + r]];
+    }
+
+public:
+    explicit SellMatrix(const CSRMatrix<T, Index> &matrix, size_t C = 16, size_t sigma = 256)
+        : rows(matrix.getRows()), cols(matrix.getCols()), C(C), sigma(std::max<size_t>(sigma, 1))
+    {
+        if (C == 0)
+            throw std::invalid_argument("Slice height must be positive");
+        if (cols > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+            throw std::invalid_argument("SELL format supports at most 2^31 - 1 columns");
+
+        const std::vector<size_t> &ptr = matrix.rowPtr();
+        auto length = [&](size_t row)
+        { return ptr[row + 1] - ptr[row]; };
+
+        checkIndexRange<Index>(rows);
+        permutation.resize(rows);
+        std::iota(permutation.begin(), permutation.end(), Index(0));
+        for (size_t first = 0; first < rows; first += this->sigma)
+        {
+            size_t last = std::min(rows, first + this->sigma);
+            std::stable_sort(permutation.begin() + first, permutation.begin() + last,
+                             [&](Index a, Index b)
+                             { return length(a) > length(b); });
+        }
+
+        size_t slices = (rows + C - 1) / C;
+        slice_ptr.assign(slices + 1, 0);
+        slice_width.assign(slices, 0);
+        for (size_t s = 0; s < slices; ++s)
+        {
+            for (size_t r = s * C; r < std::min(rows, (s + 1) * C); ++r)
+                slice_width[s] = std::max(slice_width[s], length(permutation[r]));
+            slice_ptr[s + 1] = slice_ptr[s] + slice_width[s] * C;
+        }
+
+        // Дополнение: нулевое значение и столбец 0, чтобы gather не выходил за границы x
+        col_idx.assign(slice_ptr[slices], 0);
+        values.assign(slice_ptr[slices], T(0));
+        for (size_t s = 0; s < slices; ++s)
+        {
+            for (size_t r = s * C; r < std::min(rows, (s + 1) * C); ++r)
+            {
+                size_t row = permutation[r];
+                size_t lane = r - s * C;
+                for (size_t k = ptr[row], j = 0; k < ptr[row + 1]; ++k, ++j)
+                {
+                    col_idx[slice_ptr[s] + j * C + lane] = static_cast<int32_t>(matrix.colIdx()[k]);
+                    values[slice_ptr[s] + j * C + lane] = matrix.getValues()[k];
+                }
+            }
+        }
+    }
+
+    size_t getRows() const { return rows; }
+    size_t getCols() const { return cols; }
+    size_t sliceHeight() const { return C; }
+    size_t storedEntries() const { return values.size(); }
+
+    // Подходит ли высота среза для векторного ядра (C кратно ширине регистра)
+    bool supports(SellKernel kernel) const
+    {
+        return kernel == SellKernel::Scalar || C % laneCount(kernel) == 0;
+    }
+
+    // Лучшее ядро, доступное и процессору, и выбранной высоте среза
+    SellKernel bestKernel() const
+    {
+        SellKernel kernel = detectSellKernel();
+        if (kernel == SellKernel::AVX512 && !supports(kernel))
+            kernel = SellKernel::AVX2;
+        if (kernel == SellKernel::AVX2 && !supports(kernel))
+            kernel = SellKernel::Scalar;
+        return kernel;
+    }
+
+    void multiply(const std::vector<T> &x, std::vector<T> &y, SellKernel kernel) const
+    {
+        if (cols != x.size() || rows != y.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        if (!supports(kernel) || static_cast<int>(kernel) > static_cast<int>(detectSellKernel()))
+            throw std::invalid_argument("SIMD kernel is not available for this matrix or CPU");
+        if (cols == 0)
+        {
+            std::fill(y.begin(), y.end(), T(0));
+            return;
+        }
+        std::vector<T> out(C);
+        for (size_t s = 0; s + 1 < slice_ptr.size(); ++s)
+        {
+            multiplySlice(s, x.data(), out.data(), kernel);
+            for (size_t r = s * C; r < std::min(rows, (s + 1) * C); ++r)
+                y[permutation[r]] = out[r - s * C];
+        }
+    }
+
+    void multiply(const std::vector<T> &x, std::vector<T> &y) const
+    {
+        multiply(x, y, bestKernel());
+    }
+
+    std::vector<T> operator*(const std::vector<T> &x) const
+    {
+        std::vector<T> y(rows);
+        multiply(x, y);
+        return y;
+    }
+};
+
+#endif // SELL_MATRIX_HPP
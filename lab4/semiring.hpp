@@ -0,0 +1,242 @@
+#ifndef SEMIRING_HPP
+#define SEMIRING_HPP
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "compressed_vector.hpp"
+#include "csr_matrix.hpp"
+#include "parallel_spmv.hpp"
+
+// Умножение разреженной матрицы на вектор над произвольным полукольцом (в духе GraphBLAS).
+// Полукольцо S задаёт тип значений S::value_type, нейтральный элемент сложения S::zero(),
+// операции S::add и S::multiply, а также S::isTerminal(v) — признак того, что дальнейшие
+// слагаемые уже не изменят сумму (для логического «или» — первое true).
+//
+// Маска выбирает позиции результата, которые разрешено записывать; остальные позиции
+// не вычисляются вовсе, поэтому работа обходов графа сокращается до непосещённых вершин.
+//
+//   mxv<S>(A, x, y, mask)   — y_i = (+)_k A_ik (*) x_k для разрешённых i («pull», по строкам A)
+//   vxm<S>(x, A, mask)      — y_j = (+)_k x_k (*) A_kj для разреженного x («push», по строкам A,
+//                             соответствующим ненулям x; работа пропорциональна рёбрам фронта)
+//
+// Хранимые значения матрицы переводятся в область полукольца через S::fromValue: для OrAnd
+// любое хранимое ненулевое значение — ребро, поэтому матрица смежности с весами double
+// годится и для OrAnd, и для MinPlus<double>.
+
+namespace semiring_detail
+{
+    // Меньше этого числа ненулевых элементов на поток mxv не делится: шаги обхода с маленьким
+    // фронтом не окупают запуск потоков
+    constexpr size_t minimumPerThread = 1 << 15;
+}
+
+template <typename T>
+struct PlusTimes
+{
+    using value_type = T;
+    template <typename W>
+    static T fromValue(W value) { return static_cast<T>(value); }
+    static constexpr T zero() { return T(0); }
+    static T add(T a, T b) { return a + b; }
+    static T multiply(T a, T b) { return a * b; }
+    static constexpr bool isTerminal(T) { return false; }
+};
+
+// Кратчайшие пути: «сложение» — минимум, «умножение» — сумма; ноль — бесконечность
+// (для целых типов — максимальное значение, сумма с ним насыщается)
+template <typename T>
+struct MinPlus
+{
+    using value_type = T;
+    template <typename W>
+    static T fromValue(W value) { return static_cast<T>(value); }
+    static constexpr T zero()
+    {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+    }
+    static T add(T a, T b) { return std::min(a, b); }
+    static T multiply(T a, T b) { return a == zero() || b == zero() ? zero() : a + b; }
+    static constexpr bool isTerminal(T) { return false; }
+};
+
+// Достижимость. Тип значений — char, а не bool: std::vector<bool> хранит элементы битами,
+// и потоки не могут писать соседние элементы результата независимо
+struct OrAnd
+{
+    using value_type = char;
+    template <typename W>
+    static char fromValue(W value) { return value != W(0); }
+    static constexpr char zero() { return 0; }
+    static char add(char a, char b) { return a || b; }
+    static char multiply(char a, char b) { return a && b; }
+    static constexpr bool isTerminal(char v) { return v != 0; }
+};
+
+// Маска результата: без маски, по битам (разрешены позиции с true) или по дополнению битов.
+// Маска хранит указатель на биты, они должны жить до конца операции
+class Mask
+{
+private:
+    const std::vector<bool> *bits;
+    bool complement;
+
+    Mask(const std::vector<bool> *bits, bool complement) : bits(bits), complement(complement) {}
+
+public:
+    Mask() : bits(nullptr), complement(false) {}
+
+    static Mask of(const std::vector<bool> &bits) { return Mask(&bits, false); }
+    static Mask complementOf(const std::vector<bool> &bits) { return Mask(&bits, true); }
+
+    bool allows(size_t index) const { return !bits || (*bits)[index] != complement; }
+
+    void check(size_t size) const
+    {
+        if (bits && bits->size() != size)
+            throw std::invalid_argument("Mask and vector dimensions do not match");
+    }
+};
+
+// Рабочая память vxm: плотный накопитель с журналом занятых позиций. Переиспользуется между
+// вызовами, очищается за время, пропорциональное числу занятых позиций
+template <typename V>
+class SpMSpVWorkspace
+{
+private:
+    std::vector<V> values;
+    std::vector<bool> occupied;
+    std::vector<size_t> touched;
+
+    template <typename S, typename T>
+    friend CompressedVector<typename S::value_type> vxm(const CompressedVector<typename S::value_type> &x,
+                                                        const CSRMatrix<T> &matrix, const Mask &mask,
+                                                        SpMSpVWorkspace<typename S::value_type> &workspace);
+
+public:
+    explicit SpMSpVWorkspace(size_t size = 0) : values(size), occupied(size, false) {}
+};
+
+// y_i = (+)_k A_ik (*) x_k для строк i, разрешённых маской; остальные y_i не изменяются.
+// Строки делятся между потоками по числу ненулевых элементов, как в ParallelSpMV
+template <typename S, typename T>
+void mxv(const CSRMatrix<T> &matrix, const std::vector<typename S::value_type> &x,
+         std::vector<typename S::value_type> &y, const Mask &mask = Mask(), size_t threads = defaultThreadCount())
+{
+    using V = typename S::value_type;
+    if (matrix.getCols() != x.size() || matrix.getRows() != y.size())
+        throw std::invalid_argument("Matrix and vector dimensions do not match");
+    mask.check(y.size());
+    const size_t *ptr = matrix.rowPtr().data();
+    const size_t *idx = matrix.colIdx().data();
+    const T *val = matrix.getValues().data();
+    auto multiplyRows = [&](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            if (!mask.allows(i))
+                continue;
+            V sum = S::zero();
+            for (size_t k = ptr[i]; k < ptr[i + 1] && !S::isTerminal(sum); ++k)
+                sum = S::add(sum, S::multiply(S::fromValue(val[k]), x[idx[k]]));
+            y[i] = sum;
+        }
+    };
+    size_t parts = std::max<size_t>(1, std::min(threads, matrix.nonZeros() / semiring_detail::minimumPerThread));
+    std::vector<size_t> bounds = partitionRowsByNonZeros(matrix.rowPtr(), parts);
+    runParallel(bounds.size() - 1, [&](size_t p)
+                { multiplyRows(bounds[p], bounds[p + 1]); });
+}
+
+template <typename S, typename T>
+std::vector<typename S::value_type> mxv(const CSRMatrix<T> &matrix, const std::vector<typename S::value_type> &x,
+                                        const Mask &mask = Mask(), size_t threads = defaultThreadCount())
+{
+    std::vector<typename S::value_type> y(matrix.getRows(), S::zero());
+    mxv<S>(matrix, x, y, mask, threads);
+    return y;
+}
+
+// y_j = (+)_k x_k (*) A_kj по ненулям x; в результат попадают только разрешённые маской столбцы,
+// до которых дошло хотя бы одно ребро. Индексы результата упорядочиваются сортировкой журнала,
+// а при большом числе занятых позиций — проходом по всему накопителю
+template <typename S, typename T>
+CompressedVector<typename S::value_type> vxm(const CompressedVector<typename S::value_type> &x,
+                                             const CSRMatrix<T> &matrix, const Mask &mask,
+                                             SpMSpVWorkspace<typename S::value_type> &workspace)
+{
+    using V = typename S::value_type;
+    size_t cols = matrix.getCols();
+    if (matrix.getRows() != x.getSize())
+        throw std::invalid_argument("Matrix and vector dimensions do not match");
+    mask.check(cols);
+    if (workspace.values.size() != cols)
+    {
+        workspace.values.assign(cols, S::zero());
+        workspace.occupied.assign(cols, false);
+    }
+    const size_t *ptr = matrix.rowPtr().data();
+    const size_t *idx = matrix.colIdx().data();
+    const T *val = matrix.getValues().data();
+    const std::vector<size_t> &xIndices = x.getIndices();
+    const std::vector<V> &xValues = x.getValues();
+    std::vector<size_t> &touched = workspace.touched;
+    for (size_t n = 0; n < xIndices.size(); ++n)
+    {
+        size_t k = xIndices[n];
+        for (size_t e = ptr[k]; e < ptr[k + 1]; ++e)
+        {
+            size_t j = idx[e];
+            if (!mask.allows(j))
+                continue;
+            V product = S::multiply(xValues[n], S::fromValue(val[e]));
+            if (workspace.occupied[j])
+                workspace.values[j] = S::add(workspace.values[j], product);
+            else
+            {
+                workspace.occupied[j] = true;
+                workspace.values[j] = product;
+                touched.push_back(j);
+            }
+        }
+    }
+
+    if (touched.size() > cols / 16)
+    {
+        touched.clear();
+        for (size_t j = 0; j < cols; ++j)
+            if (workspace.occupied[j])
+                touched.push_back(j);
+    }
+    else
+        std::sort(touched.begin(), touched.end());
+
+    std::vector<size_t> indices;
+    std::vector<V> values;
+    indices.reserve(touched.size());
+    values.reserve(touched.size());
+    for (size_t j : touched)
+    {
+        if (workspace.values[j] != S::zero())
+        {
+            indices.push_back(j);
+            values.push_back(workspace.values[j]);
+        }
+        workspace.occupied[j] = false;
+        workspace.values[j] = S::zero();
+    }
+    touched.clear();
+    return CompressedVector<V>(cols, std::move(indices), std::move(values));
+}
+
+template <typename S, typename T>
+CompressedVector<typename S::value_type> vxm(const CompressedVector<typename S::value_type> &x,
+                                             const CSRMatrix<T> &matrix, const Mask &mask = Mask())
+{
+    SpMSpVWorkspace<typename S::value_type> workspace(matrix.getCols());
+    return vxm<S>(x, matrix, mask, workspace);
+}
+
+#endif // SEMIRING_HPP
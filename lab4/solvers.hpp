@@ -0,0 +1,466 @@
+#ifndef SOLVERS_HPP
+#define SOLVERS_HPP
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "csr_matrix.hpp"
+#include "parallel_spmv.hpp"
+
+// Итерационные методы решения A x = b для разреженных матриц.
+// Обращение большой разреженной матрицы даёт плотный результат, поэтому вместо inverse()
+// система решается методами подпространств Крылова, которым нужно только умножение
+// матрицы на вектор (ParallelSpMV) и скалярные произведения.
+
+template <typename T>
+T denseDot(const std::vector<T> &a, const std::vector<T> &b)
+{
+    Accumulator<T> result = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        result += static_cast<Accumulator<T>>(a[i]) * b[i];
+    return static_cast<T>(result);
+}
+
+template <typename T>
+double denseNorm(const std::vector<T> &a)
+{
+    return std::sqrt(static_cast<double>(denseDot(a, a)));
+}
+
+// y += alpha * x
+template <typename T>
+void denseAxpy(T alpha, const std::vector<T> &x, std::vector<T> &y)
+{
+    for (size_t i = 0; i < x.size(); ++i)
+        y[i] += alpha * x[i];
+}
+
+// Предобусловливатель: z = M^{-1} r
+template <typename T>
+class Preconditioner
+{
+public:
+    virtual ~Preconditioner() = default;
+    virtual void apply(const std::vector<T> &r, std::vector<T> &z) const = 0;
+};
+
+template <typename T>
+class IdentityPreconditioner : public Preconditioner<T>
+{
+public:
+    void apply(const std::vector<T> &r, std::vector<T> &z) const override { z = r; }
+};
+
+// Якоби: деление на диагональ
+template <typename T>
+class JacobiPreconditioner : public Preconditioner<T>
+{
+private:
+    std::vector<T> inverseDiagonal;
+
+public:
+    explicit JacobiPreconditioner(const CSRMatrix<T> &matrix) : inverseDiagonal(matrix.getRows())
+    {
+        for (size_t i = 0; i < matrix.getRows(); ++i)
+        {
+            T diagonal = matrix.get(i, i);
+            if (diagonal == 0)
+                throw std::invalid_argument("Jacobi preconditioner requires a nonzero diagonal");
+            inverseDiagonal[i] = T(1) / diagonal;
+        }
+    }
+
+    void apply(const std::vector<T> &r, std::vector<T> &z) const override
+    {
+        z.resize(r.size());
+        for (size_t i = 0; i < r.size(); ++i)
+            z[i] = r[i] * inverseDiagonal[i];
+    }
+};
+
+// Неполное LU-разложение без заполнения ILU(0): L и U имеют портрет исходной матрицы.
+// Множители L (с единичной диагональю) и U хранятся в одном наборе CSR-массивов.
+template <typename T>
+class ILU0Preconditioner : public Preconditioner<T>
+{
+private:
+    std::vector<size_t> row_ptr, col_idx, diagonal;
+    std::vector<T> values;
+
+public:
+    explicit ILU0Preconditioner(const CSRMatrix<T> &matrix)
+        : row_ptr(matrix.rowPtr()), col_idx(matrix.colIdx()), diagonal(matrix.getRows()), values(matrix.getValues())
+    {
+        size_t n = matrix.getRows();
+        if (n != matrix.getCols())
+            throw std::invalid_argument("Matrix must be square");
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto first = col_idx.begin() + row_ptr[i];
+            auto last = col_idx.begin() + row_ptr[i + 1];
+            auto it = std::lower_bound(first, last, i);
+            if (it == last || *it != i)
+                throw std::invalid_argument("ILU(0) requires every diagonal entry to be stored");
+            diagonal[i] = it - col_idx.begin();
+        }
+
+        // Вариант IKJ: position[j] — позиция столбца j в текущей строке или n, если его нет
+        std::vector<size_t> position(n, values.size());
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                position[col_idx[k]] = k;
+            for (size_t k = row_ptr[i]; k < diagonal[i]; ++k)
+            {
+                size_t pivotRow = col_idx[k];
+                if (values[diagonal[pivotRow]] == 0)
+                    throw std::invalid_argument("Zero pivot in ILU(0)");
+                values[k] /= values[diagonal[pivotRow]];
+                for (size_t m = diagonal[pivotRow] + 1; m < row_ptr[pivotRow + 1]; ++m)
+                {
+                    size_t target = position[col_idx[m]];
+                    if (target != values.size())
+                        values[target] -= values[k] * values[m];
+                }
+            }
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                position[col_idx[k]] = values.size();
+        }
+    }
+
+    void apply(const std::vector<T> &r, std::vector<T> &z) const override
+    {
+        size_t n = diagonal.size();
+        z.resize(n);
+        // L y = r, L с единичной диагональю
+        for (size_t i = 0; i < n; ++i)
+        {
+            Accumulator<T> sum = r[i];
+            for (size_t k = row_ptr[i]; k < diagonal[i]; ++k)
+                sum -= static_cast<Accumulator<T>>(values[k]) * z[col_idx[k]];
+            z[i] = static_cast<T>(sum);
+        }
+        // U z = y
+        for (size_t i = n; i-- > 0;)
+        {
+            Accumulator<T> sum = z[i];
+            for (size_t k = diagonal[i] + 1; k < row_ptr[i + 1]; ++k)
+                sum -= static_cast<Accumulator<T>>(values[k]) * z[col_idx[k]];
+            z[i] = static_cast<T>(sum / values[diagonal[i]]);
+        }
+    }
+};
+
+enum class SolverMethod
+{
+    CG,       // сопряжённые градиенты, симметричные положительно определённые матрицы
+    BiCGSTAB, // стабилизированный метод бисопряжённых градиентов
+    GMRES     // обобщённый метод минимальных невязок с перезапуском
+};
+
+enum class PreconditionerType
+{
+    None,
+    Jacobi,
+    ILU0
+};
+
+struct SolverOptions
+{
+    SolverMethod method = SolverMethod::CG;
+    PreconditionerType preconditioner = PreconditionerType::None;
+    double tolerance = 1e-8;   // по относительной невязке ||b - A x|| / ||b||
+    size_t maxIterations = 1000;
+    size_t restart = 30;       // размер подпространства GMRES
+    size_t threads = 1;        // потоки для умножения матрицы на вектор
+};
+
+// Сведения о сходимости: невязка и время по итерациям для подбора параметров
+struct SolverStats
+{
+    size_t iterations = 0;
+    bool converged = false;
+    std::vector<double> residuals;        // относительная невязка, [0] — начальная
+    std::vector<double> iterationSeconds; // длительность каждой итерации
+    double setupSeconds = 0;              // построение предобусловливателя
+    double totalSeconds = 0;
+};
+
+template <typename T>
+struct SolveResult
+{
+    std::vector<T> x;
+    SolverStats stats;
+};
+
+template <typename T>
+std::unique_ptr<Preconditioner<T>> makePreconditioner(const CSRMatrix<T> &matrix, PreconditionerType type)
+{
+    switch (type)
+    {
+    case PreconditionerType::Jacobi:
+        return std::make_unique<JacobiPreconditioner<T>>(matrix);
+    case PreconditionerType::ILU0:
+        return std::make_unique<ILU0Preconditioner<T>>(matrix);
+    default:
+        return std::make_unique<IdentityPreconditioner<T>>();
+    }
+}
+
+// Реализации методов. Вызываются через solve().
+template <typename T>
+class KrylovSolver
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const ParallelSpMV<T> &spmv;
+    const Preconditioner<T> &preconditioner;
+    const SolverOptions &options;
+    SolverStats &stats;
+    double bNorm;
+    Clock::time_point iterationStart;
+
+    // Завершение итерации: запись невязки и времени; true — точность достигнута
+    bool finishIteration(double residualNorm)
+    {
+        stats.iterationSeconds.push_back(std::chrono::duration<double>(Clock::now() - iterationStart).count());
+        stats.residuals.push_back(residualNorm / bNorm);
+        ++stats.iterations;
+        iterationStart = Clock::now();
+        stats.converged = stats.residuals.back() <= options.tolerance;
+        return stats.converged;
+    }
+
+    void residual(const std::vector<T> &b, const std::vector<T> &x, std::vector<T> &r) const
+    {
+        spmv.multiply(x, r);
+        for (size_t i = 0; i < r.size(); ++i)
+            r[i] = b[i] - r[i];
+    }
+
+public:
+    KrylovSolver(const ParallelSpMV<T> &spmv, const Preconditioner<T> &preconditioner, const SolverOptions &options,
+                 SolverStats &stats)
+        : spmv(spmv), preconditioner(preconditioner), options(options), stats(stats), bNorm(1) {}
+
+    // Возвращает true, если начальное приближение уже удовлетворяет точности
+    bool start(const std::vector<T> &b, const std::vector<T> &x, std::vector<T> &r)
+    {
+        bNorm = denseNorm(b);
+        if (bNorm == 0)
+            bNorm = 1;
+        residual(b, x, r);
+        stats.residuals.push_back(denseNorm(r) / bNorm);
+        stats.converged = stats.residuals.back() <= options.tolerance;
+        iterationStart = Clock::now();
+        return stats.converged;
+    }
+
+    void conjugateGradient(const std::vector<T> &b, std::vector<T> &x)
+    {
+        size_t n = b.size();
+        std::vector<T> r(n), z(n), p(n), q(n);
+        if (start(b, x, r))
+            return;
+        preconditioner.apply(r, z);
+        p = z;
+        T rz = denseDot(r, z);
+        while (stats.iterations < options.maxIterations)
+        {
+            spmv.multiply(p, q);
+            T pq = denseDot(p, q);
+            if (pq == 0)
+                break;
+            T alpha = rz / pq;
+            denseAxpy(alpha, p, x);
+            denseAxpy(-alpha, q, r);
+            if (finishIteration(denseNorm(r)))
+                return;
+            preconditioner.apply(r, z);
+            T rzNext = denseDot(r, z);
+            T beta = rzNext / rz;
+            rz = rzNext;
+            for (size_t i = 0; i < n; ++i)
+                p[i] = z[i] + beta * p[i];
+        }
+    }
+
+    // Правое предобусловливание: невязка в истории — истинная невязка системы
+    void biCGSTAB(const std::vector<T> &b, std::vector<T> &x)
+    {
+        size_t n = b.size();
+        std::vector<T> r(n), rHat(n), p(n, T(0)), v(n, T(0)), s(n), t(n), pHat(n), sHat(n);
+        if (start(b, x, r))
+            return;
+        rHat = r;
+        T rho = 1, alpha = 1, omega = 1;
+        while (stats.iterations < options.maxIterations)
+        {
+            T rhoNext = denseDot(rHat, r);
+            if (rhoNext == 0)
+                break;
+            T beta = (rhoNext / rho) * (alpha / omega);
+            rho = rhoNext;
+            for (size_t i = 0; i < n; ++i)
+                p[i] = r[i] + beta * (p[i] - omega * v[i]);
+            preconditioner.apply(p, pHat);
+            spmv.multiply(pHat, v);
+            T rHatV = denseDot(rHat, v);
+            if (rHatV == 0)
+                break;
+            alpha = rho / rHatV;
+            for (size_t i = 0; i < n; ++i)
+                s[i] = r[i] - alpha * v[i];
+            double sNorm = denseNorm(s);
+            if (sNorm / bNorm <= options.tolerance)
+            {
+                denseAxpy(alpha, pHat, x);
+                finishIteration(sNorm);
+                return;
+            }
+            preconditioner.apply(s, sHat);
+            spmv.multiply(sHat, t);
+            T tt = denseDot(t, t);
+            if (tt == 0)
+                break;
+            omega = denseDot(t, s) / tt;
+            denseAxpy(alpha, pHat, x);
+            denseAxpy(omega, sHat, x);
+            for (size_t i = 0; i < n; ++i)
+                r[i] = s[i] - omega * t[i];
+            if (finishIteration(denseNorm(r)) || omega == 0)
+                return;
+        }
+    }
+
+    // GMRES(m) с правым предобусловливанием, ортогонализацией Грама–Шмидта
+    // (модифицированной) и вращениями Гивенса для задачи наименьших квадратов
+    void gmres(const std::vector<T> &b, std::vector<T> &x)
+    {
+        size_t n = b.size();
+        size_t m = std::max<size_t>(1, options.restart);
+        std::vector<T> r(n), w(n), z(n);
+        std::vector<std::vector<T>> basis(m + 1, std::vector<T>(n));
+        std::vector<std::vector<T>> hessenberg(m + 1, std::vector<T>(m, T(0)));
+        std::vector<T> cs(m), sn(m), g(m + 1);
+        if (start(b, x, r))
+            return;
+        while (stats.iterations < options.maxIterations)
+        {
+            T beta = static_cast<T>(denseNorm(r));
+            if (beta == 0)
+                return;
+            for (size_t i = 0; i < n; ++i)
+                basis[0][i] = r[i] / beta;
+            std::fill(g.begin(), g.end(), T(0));
+            g[0] = beta;
+
+            size_t j = 0;
+            bool done = false;
+            for (; j < m && stats.iterations < options.maxIterations; ++j)
+            {
+                preconditioner.apply(basis[j], z);
+                spmv.multiply(z, w);
+                for (size_t i = 0; i <= j; ++i)
+                {
+                    hessenberg[i][j] = denseDot(w, basis[i]);
+                    denseAxpy(-hessenberg[i][j], basis[i], w);
+                }
+                hessenberg[j + 1][j] = static_cast<T>(denseNorm(w));
+                if (hessenberg[j + 1][j] != 0)
+                    for (size_t i = 0; i < n; ++i)
+                        basis[j + 1][i] = w[i] / hessenberg[j + 1][j];
+
+                for (size_t i = 0; i < j; ++i)
+                {
+                    T temp = cs[i] * hessenberg[i][j] + sn[i] * hessenberg[i + 1][j];
+                    hessenberg[i + 1][j] = -sn[i] * hessenberg[i][j] + cs[i] * hessenberg[i + 1][j];
+                    hessenberg[i][j] = temp;
+                }
+                T denom = static_cast<T>(std::hypot(static_cast<double>(hessenberg[j][j]),
+                                                    static_cast<double>(hessenberg[j + 1][j])));
+                cs[j] = denom == 0 ? T(1) : hessenberg[j][j] / denom;
+                sn[j] = denom == 0 ? T(0) : hessenberg[j + 1][j] / denom;
+                hessenberg[j][j] = denom;
+                hessenberg[j + 1][j] = 0;
+                g[j + 1] = -sn[j] * g[j];
+                g[j] = cs[j] * g[j];
+
+                // |g[j + 1]| — норма невязки без явного вычисления x
+                if (finishIteration(std::abs(static_cast<double>(g[j + 1]))) || denom == 0)
+                {
+                    ++j;
+                    done = true;
+                    break;
+                }
+            }
+
+            // y = H^{-1} g, x += M^{-1} V y
+            std::vector<T> y(j);
+            for (size_t i = j; i-- > 0;)
+            {
+                T sum = g[i];
+                for (size_t k = i + 1; k < j; ++k)
+                    sum -= hessenberg[i][k] * y[k];
+                y[i] = hessenberg[i][i] == 0 ? T(0) : sum / hessenberg[i][i];
+            }
+            std::fill(w.begin(), w.end(), T(0));
+            for (size_t i = 0; i < j; ++i)
+                denseAxpy(y[i], basis[i], w);
+            preconditioner.apply(w, z);
+            denseAxpy(T(1), z, x);
+            if (done)
+                return;
+            residual(b, x, r);
+        }
+    }
+};
+
+// Решение A x = b. x0 — начальное приближение (по умолчанию нулевое).
+template <typename T>
+SolveResult<T> solve(const CSRMatrix<T> &matrix, const std::vector<T> &b, const SolverOptions &options = SolverOptions(),
+                     const std::vector<T> &x0 = std::vector<T>())
+{
+    if (matrix.getRows() != matrix.getCols())
+        throw std::invalid_argument("Matrix must be square");
+    if (matrix.getRows() != b.size() || (!x0.empty() && x0.size() != b.size()))
+        throw std::invalid_argument("Matrix and vector dimensions do not match");
+
+    auto started = std::chrono::steady_clock::now();
+    SolveResult<T> result;
+    result.x = x0.empty() ? std::vector<T>(b.size(), T(0)) : x0;
+    std::unique_ptr<Preconditioner<T>> preconditioner = makePreconditioner(matrix, options.preconditioner);
+    result.stats.setupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    ParallelSpMV<T> spmv(matrix, std::max<size_t>(1, options.threads));
+    KrylovSolver<T> solver(spmv, *preconditioner, options, result.stats);
+    switch (options.method)
+    {
+    case SolverMethod::CG:
+        solver.conjugateGradient(b, result.x);
+        break;
+    case SolverMethod::BiCGSTAB:
+        solver.biCGSTAB(b, result.x);
+        break;
+    case SolverMethod::GMRES:
+        solver.gmres(b, result.x);
+        break;
+    }
+    result.stats.totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+template <typename T>
+SolveResult<T> solve(const SparseMatrix<T> &matrix, const SparseVector<T> &b, const SolverOptions &options = SolverOptions())
+{
+    std::vector<T> dense(b.getSize(), T(0));
+    b.forEach([&](size_t index, T value)
+              { dense[index] = value; });
+    return solve(CSRMatrix<T>(matrix), dense, options);
+}
+
+#endif // SOLVERS_HPP
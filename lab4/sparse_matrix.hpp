@@ -0,0 +1,918 @@
+#ifndef SPARSE_MATRIX_HPP
+#define SPARSE_MATRIX_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <memory_resource>
+#include <type_traits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "expression.hpp"
+#include "flat_hash_map.hpp"
+#include "sparse_vector.hpp"
+#include "storage_format.hpp"
+#include "memory_resource.hpp"
+#include "numeric_types.hpp"
+#include "instrumentation.hpp"
+
+// Шаблонный класс для разреженной матрицы
+// Сложение, вычитание и умножение на скаляр возвращают ленивые выражения (expression.hpp);
+// +=, -=, *=, axpy и операторы с временным операндом изменяют существующее хранилище
+//
+// Как и SparseVector, матрица сама выбирает формат хранения по заполненности
+// (storage_format.hpp): плотный массив по строкам, вложенные хеш-таблицы или
+// отсортированные по столбцам строки.
+// Хеш-таблицы, строки и значения выделяются из std::pmr::memory_resource,
+// переданного в конструкторе; копии и результаты операций используют тот же источник.
+// Index — тип хранимых номеров строк и столбцов (как у SparseVector): с uint32_t элемент
+// сжатой строки из float занимает 8 байт вместо 16.
+template <typename T, typename Index>
+class SparseMatrix : public MatrixExpression<SparseMatrix<T, Index>>
+{
+private:
+    using Row = std::pmr::vector<std::pair<Index, T>>;
+    using HashRows = FlatHashMap<FlatHashMap<T, Index>, Index>; // строка -> (столбец -> значение)
+
+    HashRows data;                    // StorageFormat::Hash
+    std::pmr::vector<T> dense;        // StorageFormat::Dense, rows * cols по строкам
+    std::pmr::vector<Row> compressed; // StorageFormat::Compressed
+    size_t rows, cols;
+    size_t count = 0;   // число ненулевых элементов
+    size_t longest = 0; // верхняя оценка длины самой длинной строки (в плотном формате не ведётся)
+    StorageFormat format = StorageFormat::Hash;
+    bool adaptive = true;
+
+    void clearStorage()
+    {
+        HashRows(resource()).swap(data);
+        std::pmr::vector<T>(resource()).swap(dense);
+        std::pmr::vector<Row>(resource()).swap(compressed);
+    }
+
+    void convert(StorageFormat target)
+    {
+        if (target == format)
+            return;
+        SPARSE_OPERATION(FormatConversion);
+        SPARSE_WORK(count, 0);
+        if (target == StorageFormat::Dense)
+        {
+            std::pmr::vector<T> result(rows * cols, T(0), resource());
+            forEach([&](size_t row, size_t col, T value)
+                    { result[row * cols + col] = value; });
+            clearStorage();
+            dense.swap(result);
+        }
+        else if (target == StorageFormat::Compressed)
+        {
+            std::pmr::vector<Row> result(rows, resource());
+            forEach([&](size_t row, size_t col, T value)
+                    { result[row].emplace_back(col, value); });
+            if (format == StorageFormat::Hash)
+                for (Row &row : result)
+                    std::sort(row.begin(), row.end(), [](const auto &a, const auto &b)
+                              { return a.first < b.first; });
+            clearStorage();
+            compressed.swap(result);
+        }
+        else
+        {
+            HashRows result(resource());
+            forEach([&](size_t row, size_t col, T value)
+                    { result[row].emplace(col, value); });
+            clearStorage();
+            data.swap(result);
+        }
+        format = target;
+        if (format != StorageFormat::Dense)
+            longest = longestRow();
+    }
+
+    // Точная длина самой длинной строки
+    size_t longestRow() const
+    {
+        size_t result = 0;
+        if (format == StorageFormat::Dense)
+        {
+            for (size_t row = 0; row < rows; ++row)
+                result = std::max<size_t>(result, std::count_if(dense.begin() + row * cols, dense.begin() + (row + 1) * cols,
+                                                                [](const T &value)
+                                                                { return value != 0; }));
+        }
+        else if (format == StorageFormat::Compressed)
+        {
+            for (const Row &row : compressed)
+                result = std::max(result, row.size());
+        }
+        else
+        {
+            for (const auto &entry : data)
+                result = std::max(result, entry.second.size());
+        }
+        return result;
+    }
+
+    // Переход в формат, подходящий для текущей заполненности. Оценка longest после удалений
+    // может быть завышена (но не больше count); при выходе из плотного формата она измеряется
+    void adapt()
+    {
+        if (!adaptive)
+            return;
+        longest = std::min(longest, count);
+        StorageFormat target = chooseMatrixStorageFormat(format, count, rows, cols, longest);
+        if (format == StorageFormat::Dense && target != StorageFormat::Dense)
+        {
+            longest = longestRow();
+            target = chooseMatrixStorageFormat(format, count, rows, cols, longest);
+        }
+        convert(target);
+    }
+
+    // Матрица из готовых строк, отсортированных по столбцам и без нулей
+    // Строки должны быть выделены из источника памяти этой матрицы
+    SparseMatrix fromRows(size_t resultRows, size_t resultCols, std::pmr::vector<Row> &&rowData) const
+    {
+        SparseMatrix result(resultRows, resultCols, resource());
+        result.clearStorage();
+        result.compressed = std::move(rowData);
+        result.format = StorageFormat::Compressed;
+        for (const Row &row : result.compressed)
+        {
+            result.count += row.size();
+            result.longest = std::max(result.longest, row.size());
+        }
+        result.adapt();
+        return result;
+    }
+
+    // Слияние строки line с scale * other (обе отсортированы по столбцам) на месте:
+    // строка расширяется, слияние идёт с конца, затем результат сдвигается к началу без нулей.
+    // Возвращает изменение числа ненулевых элементов.
+    static std::ptrdiff_t mergeRow(Row &line, T scale, const Row &other)
+    {
+        size_t n = line.size(), m = other.size();
+        line.resize(n + m);
+        size_t i = n, j = m, write = n + m;
+        while (j > 0)
+        {
+            --write;
+            if (i > 0 && line[i - 1].first > other[j - 1].first)
+                line[write] = line[--i];
+            else if (i > 0 && line[i - 1].first == other[j - 1].first)
+            {
+                --i;
+                --j;
+                line[write] = {line[i].first, line[i].second + scale * other[j].second};
+            }
+            else
+            {
+                --j;
+                line[write] = {other[j].first, scale * other[j].second};
+            }
+        }
+        size_t count = i;
+        for (size_t k = write; k < n + m; ++k)
+            if (line[k].second != 0)
+                line[count++] = line[k];
+        line.resize(count);
+        return static_cast<std::ptrdiff_t>(count) - static_cast<std::ptrdiff_t>(n);
+    }
+
+    // Буферы построчного умножения; переиспользуются между умножениями в power()
+    struct ProductWorkspace
+    {
+        std::pmr::vector<T> accumulator;
+        std::pmr::vector<bool> used;
+        std::pmr::vector<size_t> touched;
+
+        explicit ProductWorkspace(std::pmr::memory_resource *resource)
+            : accumulator(resource), used(resource), touched(resource) {}
+    };
+
+    // Построчное умножение (Густавсон) в out: ненулевой элемент (row, col) умножается
+    // только на ненулевые элементы строки col второй матрицы, строка результата
+    // накапливается в плотном буфере и переносится в out один раз.
+    // Если out уже хранится в сжатом формате с тем же числом строк, память его строк
+    // переиспользуется. out не должна совпадать с операндами.
+    void multiplyInto(const SparseMatrix &other, SparseMatrix &out, ProductWorkspace &workspace) const
+    {
+        if (cols != other.rows)
+            throw std::invalid_argument("Matrix dimensions do not allow multiplication");
+        SPARSE_OPERATION(MatrixMultiply);
+        StorageFormat target = out.format;
+        if (out.format == StorageFormat::Compressed && out.rows == rows)
+            for (Row &line : out.compressed)
+                line.clear();
+        else
+        {
+            out.clearStorage();
+            out.compressed.resize(rows);
+            out.format = StorageFormat::Compressed;
+        }
+        out.rows = rows;
+        out.cols = other.cols;
+        out.count = 0;
+        out.longest = 0;
+
+        auto &[accumulator, used, touched] = workspace;
+        size_t products = 0;
+        accumulator.assign(other.cols, T(0));
+        used.assign(other.cols, false);
+        touched.clear();
+        for (size_t row = 0; row < rows; ++row)
+        {
+            forEachInRow(row, [&](size_t col, T value)
+                         { other.forEachInRow(col, [&](size_t k, T otherValue)
+                                              {
+                    if (!used[k])
+                    {
+                        used[k] = true;
+                        touched.push_back(k);
+                    }
+                    accumulator[k] += value * otherValue;
+                    ++products; }); });
+            if (touched.empty())
+                continue;
+            std::sort(touched.begin(), touched.end());
+            Row &resultRow = out.compressed[row];
+            resultRow.reserve(touched.size());
+            for (size_t k : touched)
+            {
+                if (accumulator[k] != 0)
+                    resultRow.emplace_back(k, accumulator[k]);
+                accumulator[k] = 0;
+                used[k] = false;
+            }
+            out.count += resultRow.size();
+            out.longest = std::max(out.longest, resultRow.size());
+            touched.clear();
+        }
+        SPARSE_WORK(count + out.count, 2 * products);
+        if (out.adaptive)
+            out.adapt();
+        else
+            out.convert(target);
+    }
+
+    // Обход ненулевых элементов строки: f(col, value)
+    template <typename F>
+    void forEachInRow(size_t row, F f) const
+    {
+        if (format == StorageFormat::Dense)
+        {
+            const T *line = dense.data() + row * cols;
+            for (size_t col = 0; col < cols; ++col)
+                if (line[col] != 0)
+                    f(col, line[col]);
+        }
+        else if (format == StorageFormat::Compressed)
+        {
+            for (const auto &[col, value] : compressed[row])
+                f(col, value);
+        }
+        else
+        {
+            auto it = data.find(row);
+            if (it != data.end())
+                for (const auto &[col, value] : it->second)
+                    f(col, value);
+        }
+    }
+
+public:
+    using value_type = T;
+    using index_type = Index;
+    static constexpr bool is_leaf = true;
+
+    SparseMatrix(size_t rows, size_t cols, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : data(resource), dense(resource), compressed(resource), rows(rows), cols(cols)
+    {
+        checkIndexRange<Index>(rows);
+        checkIndexRange<Index>(cols);
+        adapt();
+    }
+
+    // Матрица из массивов CSR (столбцы в строках отсортированы): сжатые строки заполняются
+    // напрямую, без поэлементной вставки через set(); нули пропускаются
+    template <typename ColIndex>
+    static SparseMatrix fromCompressedRows(size_t rows, size_t cols, const std::vector<size_t> &row_ptr,
+                                           const std::vector<ColIndex> &col_idx, const std::vector<T> &values,
+                                           std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+    {
+        SparseMatrix result(rows, cols, resource);
+        std::pmr::vector<Row> rowData(rows, result.resource());
+        for (size_t i = 0; i < rows; ++i)
+        {
+            Row &line = rowData[i];
+            line.reserve(row_ptr[i + 1] - row_ptr[i]);
+            for (size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                if (values[k] != 0)
+                    line.emplace_back(static_cast<Index>(col_idx[k]), values[k]);
+        }
+        return result.fromRows(rows, cols, std::move(rowData));
+    }
+
+    // Копия использует источник памяти оригинала
+    SparseMatrix(const SparseMatrix &other) : SparseMatrix(other, other.resource()) {}
+
+    SparseMatrix(const SparseMatrix &other, std::pmr::memory_resource *resource)
+        : data(other.data, resource), dense(other.dense, resource), compressed(other.compressed, resource),
+          rows(other.rows), cols(other.cols), count(other.count), longest(other.longest), format(other.format),
+          adaptive(other.adaptive) {}
+
+    SparseMatrix(SparseMatrix &&other) = default;
+    SparseMatrix &operator=(const SparseMatrix &other) = default;
+    SparseMatrix &operator=(SparseMatrix &&other) = default;
+
+    // Преобразование из матрицы с другим типом индексов
+    template <typename OtherIndex>
+    explicit SparseMatrix(const SparseMatrix<T, OtherIndex> &other,
+                          std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : SparseMatrix(other.getRows(), other.getCols(), resource)
+    {
+        std::pmr::vector<Row> result(rows, this->resource());
+        other.forEach([&](size_t row, size_t col, T value)
+                      { result[row].emplace_back(static_cast<Index>(col), value); });
+        if (other.storageFormat() == StorageFormat::Hash)
+            for (Row &line : result)
+                std::sort(line.begin(), line.end(), [](const auto &a, const auto &b)
+                          { return a.first < b.first; });
+        *this = fromRows(rows, cols, std::move(result));
+    }
+
+    // Вычисление выражения за один проход по позициям ненулевых элементов операндов.
+    // Если по оценке результат заполнен плотно, он сразу вычисляется в плотный массив.
+    template <typename E>
+    SparseMatrix(const MatrixExpression<E> &expression,
+                 std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : data(resource), dense(resource), compressed(resource),
+          rows(expression.self().getRows()), cols(expression.self().getCols())
+    {
+        checkIndexRange<Index>(rows);
+        checkIndexRange<Index>(cols);
+        const E &expr = expression.self();
+        size_t bound = std::min(expr.nonZerosBound(), rows * cols);
+        SPARSE_OPERATION(MatrixEvaluate);
+        SPARSE_WORK(bound, bound);
+        if (chooseMatrixStorageFormat(StorageFormat::Hash, bound, rows, cols, bound) == StorageFormat::Dense)
+        {
+            format = StorageFormat::Dense;
+            dense.assign(rows * cols, T(0));
+            expr.forEachIndex([&](size_t row, size_t col)
+                              {
+                T value = expr.get(row, col);
+                dense[row * cols + col] = value != 0 ? value : T(0); });
+            for (const T &value : dense)
+                count += value != 0;
+        }
+        else
+        {
+            expr.forEachIndex([&](size_t row, size_t col)
+                              {
+                auto &resultRow = data[row];
+                if (resultRow.count(col))
+                    return;
+                T value = expr.get(row, col);
+                if (value != 0)
+                {
+                    resultRow.emplace(col, value);
+                    ++count;
+                }
+                else if (resultRow.empty())
+                    data.erase(row); });
+            longest = longestRow();
+        }
+        adapt();
+    }
+
+    template <typename E>
+    SparseMatrix &operator=(const MatrixExpression<E> &expression)
+    {
+        SparseMatrix result(expression, resource());
+        result.adaptive = adaptive;
+        if (!adaptive)
+            result.convert(format);
+        *this = std::move(result);
+        return *this;
+    }
+
+    // this += scale * other без создания новой матрицы. Память не выделяется, если эта матрица
+    // плотная, хранится в хеш-таблицах с достаточной ёмкостью или обе матрицы сжатые и ёмкости
+    // строк хватает на объединение столбцов. Сжатая матрица и несжатая other: строки other
+    // по очереди упорядочиваются в одном временном буфере.
+    SparseMatrix &axpy(T scale, const SparseMatrix &other)
+    {
+        if (rows != other.rows || cols != other.cols)
+            throw std::invalid_argument("Matrix dimensions do not match");
+        if (scale == 0)
+            return *this;
+        if (&other == this)
+            return *this *= T(1) + scale;
+        SPARSE_OPERATION(MatrixAxpy);
+        SPARSE_WORK(other.count, 2 * other.count);
+        if (format == StorageFormat::Dense)
+        {
+            other.forEach([&](size_t row, size_t col, T value)
+                          {
+                T &entry = dense[row * cols + col];
+                count -= entry != 0;
+                entry += scale * value;
+                if (entry == 0)
+                    entry = 0; // -0 хранится как 0
+                count += entry != 0; });
+        }
+        else if (format == StorageFormat::Hash)
+        {
+            other.forEach([&](size_t row, size_t col, T value)
+                          {
+                auto &line = data[static_cast<Index>(row)];
+                T &entry = line[static_cast<Index>(col)];
+                bool had = entry != 0;
+                entry += scale * value;
+                if (entry != 0)
+                {
+                    count += !had;
+                    longest = std::max(longest, line.size());
+                }
+                else
+                {
+                    count -= had;
+                    line.erase(static_cast<Index>(col));
+                    if (line.empty())
+                        data.erase(static_cast<Index>(row));
+                } });
+        }
+        else if (other.format == StorageFormat::Compressed)
+        {
+            for (size_t row = 0; row < rows; ++row)
+            {
+                count += mergeRow(compressed[row], scale, other.compressed[row]);
+                longest = std::max(longest, compressed[row].size());
+            }
+        }
+        else
+        {
+            Row buffer(resource());
+            for (size_t row = 0; row < rows; ++row)
+            {
+                buffer.clear();
+                other.forEachInRow(row, [&](size_t col, T value)
+                                   { buffer.emplace_back(static_cast<Index>(col), value); });
+                if (buffer.empty())
+                    continue;
+                if (other.format == StorageFormat::Hash)
+                    std::sort(buffer.begin(), buffer.end(), [](const auto &a, const auto &b)
+                              { return a.first < b.first; });
+                count += mergeRow(compressed[row], scale, buffer);
+                longest = std::max(longest, compressed[row].size());
+            }
+        }
+        adapt();
+        return *this;
+    }
+
+    SparseMatrix &operator+=(const SparseMatrix &other) { return axpy(T(1), other); }
+    SparseMatrix &operator-=(const SparseMatrix &other) { return axpy(T(-1), other); }
+
+    // A += B * a и A -= B * a без вычисления B * a
+    SparseMatrix &operator+=(const MatrixScaled<SparseMatrix> &scaled) { return axpy(scaled.factor(), scaled.operand()); }
+    SparseMatrix &operator-=(const MatrixScaled<SparseMatrix> &scaled) { return axpy(-scaled.factor(), scaled.operand()); }
+
+    // Прочие выражения вычисляются во временную матрицу
+    template <typename E>
+    SparseMatrix &operator+=(const MatrixExpression<E> &expression)
+    {
+        return axpy(T(1), SparseMatrix(expression, resource()));
+    }
+
+    template <typename E>
+    SparseMatrix &operator-=(const MatrixExpression<E> &expression)
+    {
+        return axpy(T(-1), SparseMatrix(expression, resource()));
+    }
+
+    SparseMatrix &operator*=(T scalar)
+    {
+        SPARSE_OPERATION(MatrixScale);
+        SPARSE_WORK(count, count);
+        if (format == StorageFormat::Dense)
+        {
+            count = 0;
+            for (T &value : dense)
+            {
+                value *= scalar;
+                if (value == 0)
+                    value = 0;
+                count += value != 0;
+            }
+        }
+        else if (format == StorageFormat::Compressed)
+        {
+            count = 0;
+            for (Row &line : compressed)
+            {
+                size_t kept = 0;
+                for (const auto &[col, value] : line)
+                    if (value * scalar != 0)
+                        line[kept++] = {col, value * scalar};
+                line.resize(kept);
+                count += kept;
+            }
+        }
+        else if (scalar == 0)
+        {
+            data.clear();
+            count = 0;
+        }
+        else
+        {
+            count = 0;
+            data.eraseIf([&](auto &entry)
+                         {
+                entry.second.eraseIf([&](auto &element)
+                                     {
+                    element.second *= scalar;
+                    return element.second == 0; });
+                count += entry.second.size();
+                return entry.second.empty(); });
+        }
+        adapt();
+        return *this;
+    }
+
+    // Операнд-временный объект отдаёт своё хранилище результату. Шаблоны принимают только
+    // сами SparseMatrix (без неявного преобразования выражений), а сложение двух lvalue
+    // по-прежнему возвращает ленивое выражение
+    template <typename L, typename R>
+    static constexpr bool stealsOperand = std::is_same_v<std::decay_t<L>, SparseMatrix> &&
+                                          std::is_same_v<std::decay_t<R>, SparseMatrix> &&
+                                          !std::is_lvalue_reference_v<L>;
+
+    template <typename L, typename R, std::enable_if_t<stealsOperand<L, R> || stealsOperand<R, L>, int> = 0>
+    friend SparseMatrix operator+(L &&left, R &&right)
+    {
+        if constexpr (stealsOperand<L, R>)
+            return std::move(left += right);
+        else
+            return std::move(right += left);
+    }
+
+    template <typename L, typename R, std::enable_if_t<stealsOperand<L, R>, int> = 0>
+    friend SparseMatrix operator-(L &&left, R &&right) { return std::move(left -= right); }
+
+    template <typename V, std::enable_if_t<stealsOperand<V, V>, int> = 0>
+    friend SparseMatrix operator*(V &&matrix, T scalar) { return std::move(matrix *= scalar); }
+
+    T get(size_t row, size_t col) const
+    {
+        if (row >= rows || col >= cols)
+            return 0;
+        if (format == StorageFormat::Dense)
+            return dense[row * cols + col];
+        if (format == StorageFormat::Compressed)
+        {
+            const Row &line = compressed[row];
+            auto it = std::lower_bound(line.begin(), line.end(), col, [](const auto &entry, size_t c)
+                                       { return entry.first < c; });
+            return it != line.end() && it->first == col ? it->second : T(0);
+        }
+        auto rowIt = data.find(row);
+        if (rowIt == data.end())
+            return 0;
+        auto it = rowIt->second.find(col);
+        return it != rowIt->second.end() ? it->second : T(0);
+    }
+
+    void set(size_t row, size_t col, T value)
+    {
+        if (row >= rows || col >= cols)
+            throw std::out_of_range("Index out of range");
+        if (format == StorageFormat::Dense)
+        {
+            T &entry = dense[row * cols + col];
+            count += (value != 0);
+            count -= (entry != 0);
+            entry = value != 0 ? value : T(0); // -0 хранится как 0
+        }
+        else if (format == StorageFormat::Compressed)
+        {
+            Row &line = compressed[row];
+            auto it = std::lower_bound(line.begin(), line.end(), col, [](const auto &entry, size_t c)
+                                       { return entry.first < c; });
+            if (it != line.end() && it->first == col)
+            {
+                if (value != 0)
+                    it->second = value;
+                else
+                {
+                    line.erase(it);
+                    --count;
+                }
+            }
+            else if (value != 0)
+            {
+                line.insert(it, {static_cast<Index>(col), value});
+                ++count;
+                longest = std::max(longest, line.size());
+            }
+        }
+        else if (value != 0)
+        {
+            auto &line = data[row];
+            auto it = line.find(col);
+            if (it != line.end())
+                it->second = value;
+            else
+            {
+                line.emplace(col, value);
+                ++count;
+                longest = std::max(longest, line.size());
+            }
+        }
+        else
+        {
+            auto rowIt = data.find(row);
+            if (rowIt != data.end() && rowIt->second.erase(col))
+            {
+                --count;
+                if (rowIt->second.empty())
+                    data.erase(row);
+            }
+        }
+        adapt();
+    }
+
+    size_t getRows() const { return rows; }
+    size_t getCols() const { return cols; }
+
+    size_t nonZeros() const { return count; }
+
+    std::pmr::memory_resource *resource() const { return dense.get_allocator().resource(); }
+
+    // Байты, занятые хранилищем
+    size_t memoryUsage() const
+    {
+        size_t bytes = data.memoryUsage() + dense.capacity() * sizeof(T) + compressed.capacity() * sizeof(Row);
+        for (const auto &entry : data)
+            bytes += entry.second.memoryUsage();
+        for (const Row &row : compressed)
+            bytes += row.capacity() * sizeof(typename Row::value_type);
+        return bytes;
+    }
+
+    double density() const { return rows * cols ? static_cast<double>(count) / (rows * cols) : 0; }
+
+    StorageFormat storageFormat() const { return format; }
+
+    // Принудительный выбор формата; автоматическое переключение при этом отключается
+    void setStorageFormat(StorageFormat target)
+    {
+        adaptive = false;
+        convert(target);
+    }
+
+    // Включение (с немедленным выбором формата) или отключение автоматического переключения
+    void setAdaptive(bool enabled)
+    {
+        adaptive = enabled;
+        if (format != StorageFormat::Dense)
+            longest = longestRow();
+        adapt();
+    }
+
+    // Обход ненулевых элементов в порядке хранения: f(row, col, value)
+    template <typename F>
+    void forEach(F f) const
+    {
+        if (format == StorageFormat::Hash)
+        {
+            for (const auto &[row, cols] : data)
+                for (const auto &[col, value] : cols)
+                    f(row, col, value);
+        }
+        else
+        {
+            for (size_t row = 0; row < rows; ++row)
+                forEachInRow(row, [&](size_t col, T value)
+                             { f(row, col, value); });
+        }
+    }
+
+    // Интерфейс листа выражения
+    size_t nonZerosBound() const { return count; }
+
+    template <typename F>
+    void forEachIndex(F f) const
+    {
+        forEach([&](size_t row, size_t col, const T &)
+                { f(row, col); });
+    }
+
+    SparseMatrix transpose() const
+    {
+        SPARSE_OPERATION(MatrixTranspose);
+        SPARSE_WORK(count, 0);
+        if (format == StorageFormat::Dense)
+        {
+            SparseMatrix result(cols, rows, resource());
+            result.clearStorage();
+            result.format = StorageFormat::Dense;
+            result.dense.resize(rows * cols);
+            for (size_t i = 0; i < rows; ++i)
+                for (size_t j = 0; j < cols; ++j)
+                    result.dense[j * rows + i] = dense[i * cols + j];
+            result.count = count;
+            result.adapt();
+            return result;
+        }
+        // Строки обходятся по возрастанию, поэтому строки результата уже отсортированы.
+        // Длины строк результата подсчитываются заранее, чтобы каждая выделялась один раз.
+        std::vector<size_t> lengths(cols, 0);
+        forEach([&](size_t, size_t col, T)
+                { ++lengths[col]; });
+        std::pmr::vector<Row> result(cols, resource());
+        for (size_t col = 0; col < cols; ++col)
+            result[col].reserve(lengths[col]);
+        for (size_t row = 0; row < rows; ++row)
+            forEachInRow(row, [&](size_t col, T value)
+                         { result[col].emplace_back(row, value); });
+        return fromRows(cols, rows, std::move(result));
+    }
+
+    SparseMatrix operator*(const SparseMatrix &other) const
+    {
+        SparseMatrix result(rows, other.cols, resource());
+        ProductWorkspace workspace(resource());
+        multiplyInto(other, result, workspace);
+        return result;
+    }
+
+    // Каждая строка суммируется локально и записывается в результат один раз
+    SparseVector<T, Index> operator*(const SparseVector<T, Index> &vec) const
+    {
+        if (cols != vec.getSize())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        SPARSE_OPERATION(MatrixVector);
+        SPARSE_WORK(count, 2 * count);
+        std::vector<size_t> resultIndices;
+        std::vector<T> resultValues;
+        for (size_t row = 0; row < rows; ++row)
+        {
+            Accumulator<T> sum = 0;
+            forEachInRow(row, [&](size_t col, T value)
+                         { sum += static_cast<Accumulator<T>>(value) * vec.get(col); });
+            if (sum != 0)
+            {
+                resultIndices.push_back(row);
+                resultValues.push_back(static_cast<T>(sum));
+            }
+        }
+        return SparseVector<T, Index>(rows, resultIndices, resultValues, resource());
+    }
+
+    std::vector<T> operator*(const std::vector<T> &vec) const { return multiply(vec); }
+
+    // Умножение на плотный вектор с элементами другой точности (например, матрица во float,
+    // векторы в double); суммы строк накапливаются в Accumulator от более широкого типа
+    template <typename V>
+    std::vector<V> multiply(const std::vector<V> &vec) const
+    {
+        SPARSE_OPERATION(MatrixVector);
+        SPARSE_WORK(count, 2 * count);
+        if (cols != vec.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<V> result(rows, V(0));
+        multiplyRows(vec, result, 0, rows);
+        return result;
+    }
+
+    // Строки [first, last) произведения на плотный вектор; независимые диапазоны
+    // можно вычислять в разных потоках (task_graph.hpp)
+    template <typename V>
+    void multiplyRows(const std::vector<V> &vec, std::vector<V> &result, size_t first, size_t last) const
+    {
+        using Sum = Accumulator<std::common_type_t<T, V>>;
+        for (size_t row = first; row < last; ++row)
+        {
+            Sum sum = 0;
+            forEachInRow(row, [&](size_t col, T value)
+                         { sum += static_cast<Sum>(value) * vec[col]; });
+            result[row] = static_cast<V>(sum);
+        }
+    }
+
+    // Умножение транспонированной матрицы на вектор без построения A^T:
+    // элемент (row, col) добавляет value * vec[row] к result[col]
+    std::vector<T> multiplyTransposed(const std::vector<T> &vec) const
+    {
+        SPARSE_OPERATION(MatrixTransposeVector);
+        if (rows != vec.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<Accumulator<T>> sums(cols, Accumulator<T>(0));
+        forEach([&](size_t row, size_t col, T value)
+                { sums[col] += static_cast<Accumulator<T>>(value) * vec[row]; });
+        return std::vector<T>(sums.begin(), sums.end());
+    }
+
+    // Просматриваются только строки, соответствующие ненулевым элементам vec
+    SparseVector<T, Index> multiplyTransposed(const SparseVector<T, Index> &vec) const
+    {
+        SPARSE_OPERATION(MatrixTransposeVector);
+        if (rows != vec.getSize())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<Accumulator<T>> accumulator(cols, Accumulator<T>(0));
+        std::vector<bool> used(cols, false);
+        std::vector<size_t> touched;
+        vec.forEach([&](size_t row, T x)
+                    { forEachInRow(row, [&](size_t col, T value)
+                                   {
+                if (!used[col])
+                {
+                    used[col] = true;
+                    touched.push_back(col);
+                }
+                accumulator[col] += static_cast<Accumulator<T>>(value) * x; }); });
+        std::sort(touched.begin(), touched.end());
+        std::vector<T> resultValues(touched.size());
+        for (size_t k = 0; k < touched.size(); ++k)
+            resultValues[k] = static_cast<T>(accumulator[touched[k]]);
+        return SparseVector<T, Index>(cols, touched, resultValues, resource());
+    }
+
+    SparseMatrix inverse() const
+    {
+        if (rows != cols)
+            throw std::invalid_argument("Matrix must be square");
+
+        // Для матриц размером больше 2x2 можно использовать метод Гаусса или другие методы
+        // Здесь мы оставим только пример для 2x2
+        if (rows == 2)
+        {
+            T a = get(0, 0);
+            T b = get(0, 1);
+            T c = get(1, 0);
+            T d = get(1, 1);
+            T det = a * d - b * c;
+            if (det == 0)
+                throw std::invalid_argument("Matrix is singular and cannot be inverted");
+            SparseMatrix inv(2, 2, resource());
+            inv.set(0, 0, d / det);
+            inv.set(0, 1, -b / det);
+            inv.set(1, 0, -c / det);
+            inv.set(1, 1, a / det);
+            return inv;
+        }
+
+        // Для матриц размером больше 2x2, можно использовать метод Гаусса или другие методы
+        // Здесь можно добавить реализацию для больших матриц, если это необходимо
+        throw std::invalid_argument("Inverse not implemented for matrices larger than 2x2");
+    }
+
+    SparseMatrix power(int exponent) const
+    {
+        SPARSE_OPERATION(MatrixPower);
+        if (rows != cols)
+            throw std::invalid_argument("Matrix must be square");
+        if (exponent < 0)
+            throw std::invalid_argument("Exponent must be non-negative");
+
+        SparseMatrix result(rows, cols, resource());
+        for (size_t i = 0; i < rows; ++i)
+            result.set(i, i, 1); // Инициализация единичной матрицы
+        SparseMatrix base = *this;
+        // Произведение пишется в product, который затем меняется местами с result или base:
+        // после первых шагов строки всех трёх матриц переиспользуются
+        SparseMatrix product(rows, cols, resource());
+        ProductWorkspace workspace(resource());
+        while (exponent > 0)
+        {
+            if (exponent % 2 == 1)
+            {
+                result.multiplyInto(base, product, workspace);
+                std::swap(result, product);
+            }
+            exponent /= 2;
+            if (exponent > 0) // Последнее возведение в квадрат не нужно
+            {
+                base.multiplyInto(base, product, workspace);
+                std::swap(base, product);
+            }
+        }
+        return result;
+    }
+
+    void print() const
+    {
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t j = 0; j < cols; ++j)
+                std::cout << get(i, j) << " ";
+            std::cout << "\n";
+        }
+    }
+};
+
+#endif // SPARSE_MATRIX_HPP
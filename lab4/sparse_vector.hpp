@@ -0,0 +1,687 @@
+#ifndef SPARSE_VECTOR_HPP
+#define SPARSE_VECTOR_HPP
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <cmath>
+#include <iterator>
+#include <memory_resource>
+#include <vector>
+
+#include "expression.hpp"
+#include "flat_hash_map.hpp"
+#include "storage_format.hpp"
+#include "memory_resource.hpp"
+#include "numeric_types.hpp"
+#include "instrumentation.hpp"
+
+// Шаблонный класс для разреженного вектора
+// Операторы +, - и умножение на скаляр определены в expression.hpp и возвращают
+// ленивые выражения, которые вычисляются при присваивании в SparseVector
+// +=, -=, *=, axpy и операторы с временным операндом изменяют существующее хранилище
+// без промежуточных векторов
+//
+// Вектор хранится в одном из трёх форматов (storage_format.hpp) и сам переходит
+// между ними при изменении заполненности: плотный массив, хеш-таблица или
+// отсортированные массивы индексов и значений.
+// Память берётся из std::pmr::memory_resource, переданного в конструкторе (memory_resource.hpp);
+// копии и результаты операций используют тот же источник, что и исходный вектор.
+// Index — тип хранимых индексов: uint32_t вдвое уменьшает память на индекс, если длина
+// вектора меньше 2^32. Методы принимают и возвращают индексы как size_t.
+template <typename T, typename Index>
+class SparseVector : public VectorExpression<SparseVector<T, Index>>
+{
+private:
+    FlatHashMap<T, Index> data;       // StorageFormat::Hash
+    std::pmr::vector<T> dense;        // StorageFormat::Dense, все size элементов
+    std::pmr::vector<Index> indices;  // StorageFormat::Compressed, по возрастанию
+    std::pmr::vector<T> values;
+    size_t size;
+    size_t denseNonZeros = 0;
+    StorageFormat format = StorageFormat::Compressed;
+    bool adaptive = true;
+
+    void clearStorage()
+    {
+        FlatHashMap<T, Index>(resource()).swap(data);
+        std::pmr::vector<T>(resource()).swap(dense);
+        std::pmr::vector<Index>(resource()).swap(indices);
+        std::pmr::vector<T>(resource()).swap(values);
+        denseNonZeros = 0;
+    }
+
+    void convert(StorageFormat target)
+    {
+        if (target == format)
+            return;
+        SPARSE_OPERATION(FormatConversion);
+        SPARSE_WORK(nonZeros(), 0);
+        if (target == StorageFormat::Dense)
+        {
+            std::pmr::vector<T> result(size, T(0), resource());
+            forEach([&](size_t index, T value)
+                    { result[index] = value; });
+            size_t count = nonZeros();
+            clearStorage();
+            dense.swap(result);
+            denseNonZeros = count;
+        }
+        else if (target == StorageFormat::Compressed)
+        {
+            std::vector<std::pair<size_t, T>> entries;
+            entries.reserve(nonZeros());
+            forEach([&](size_t index, T value)
+                    { entries.emplace_back(index, value); });
+            if (format == StorageFormat::Hash)
+                std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b)
+                          { return a.first < b.first; });
+            clearStorage();
+            indices.reserve(entries.size());
+            values.reserve(entries.size());
+            for (const auto &[index, value] : entries)
+            {
+                indices.push_back(static_cast<Index>(index));
+                values.push_back(value);
+            }
+        }
+        else
+        {
+            FlatHashMap<T, Index> result(resource());
+            result.reserve(nonZeros());
+            forEach([&](size_t index, T value)
+                    { result.emplace(index, value); });
+            clearStorage();
+            data.swap(result);
+        }
+        format = target;
+    }
+
+    // Переход в формат, подходящий для текущей заполненности
+    void adapt()
+    {
+        if (adaptive)
+            convert(chooseStorageFormat(format, nonZeros(), size));
+    }
+
+    // Применение f к каждому ненулевому значению на месте; появившиеся нули удаляются
+    template <typename F>
+    void transformInPlace(F f)
+    {
+        if (format == StorageFormat::Dense)
+        {
+            denseNonZeros = 0;
+            for (T &value : dense)
+                if (value != 0)
+                {
+                    value = f(value);
+                    if (value != 0)
+                        ++denseNonZeros;
+                    else
+                        value = 0;
+                }
+        }
+        else if (format == StorageFormat::Compressed)
+        {
+            size_t count = 0;
+            for (size_t k = 0; k < values.size(); ++k)
+            {
+                T value = f(values[k]);
+                if (value != 0)
+                {
+                    indices[count] = indices[k];
+                    values[count++] = value;
+                }
+            }
+            indices.resize(count);
+            values.resize(count);
+        }
+        else
+        {
+            data.eraseIf([&](auto &entry)
+                         {
+                entry.second = f(entry.second);
+                return entry.second == 0; });
+        }
+        adapt();
+    }
+
+    template <typename F>
+    SparseVector transform(F f) const
+    {
+        SparseVector result = *this;
+        result.transformInPlace(f);
+        return result;
+    }
+
+    // Слияние со сжатым вектором scale * (otherIndices, otherValues) в массивах этого вектора.
+    // Массивы расширяются до суммы длин, слияние идёт с конца (результат не затирает
+    // непрочитанные элементы), затем результат сдвигается к началу без нулей.
+    // Если ёмкости массивов хватает, память не выделяется.
+    template <typename IndexArray, typename ValueArray>
+    void mergeScaled(T scale, const IndexArray &otherIndices, const ValueArray &otherValues)
+    {
+        size_t n = indices.size(), m = otherIndices.size();
+        indices.resize(n + m);
+        values.resize(n + m);
+        size_t i = n, j = m, write = n + m;
+        while (j > 0)
+        {
+            --write;
+            if (i > 0 && indices[i - 1] > otherIndices[j - 1])
+            {
+                --i;
+                indices[write] = indices[i];
+                values[write] = values[i];
+            }
+            else if (i > 0 && indices[i - 1] == otherIndices[j - 1])
+            {
+                --i;
+                --j;
+                indices[write] = indices[i];
+                values[write] = values[i] + scale * otherValues[j];
+            }
+            else
+            {
+                --j;
+                indices[write] = static_cast<Index>(otherIndices[j]);
+                values[write] = scale * otherValues[j];
+            }
+        }
+        // Элементы [0, i) остались на месте, результат слияния — в [write, n + m)
+        size_t count = i;
+        for (size_t k = write; k < n + m; ++k)
+            if (values[k] != 0)
+            {
+                indices[count] = indices[k];
+                values[count++] = values[k];
+            }
+        indices.resize(count);
+        values.resize(count);
+    }
+
+public:
+    using value_type = T;
+    using index_type = Index;
+    static constexpr bool is_leaf = true;
+
+    explicit SparseVector(size_t size, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : data(resource), dense(resource), indices(resource), values(resource), size(size)
+    {
+        checkIndexRange<Index>(size);
+        adapt();
+    }
+
+    // Копия использует источник памяти оригинала
+    SparseVector(const SparseVector &other) : SparseVector(other, other.resource()) {}
+
+    SparseVector(const SparseVector &other, std::pmr::memory_resource *resource)
+        : data(other.data, resource), dense(other.dense, resource), indices(other.indices, resource),
+          values(other.values, resource), size(other.size), denseNonZeros(other.denseNonZeros),
+          format(other.format), adaptive(other.adaptive) {}
+
+    SparseVector(SparseVector &&other) = default;
+    SparseVector &operator=(const SparseVector &other) = default;
+    SparseVector &operator=(SparseVector &&other) = default;
+
+    // Построение из отсортированных по возрастанию индексов без повторов; нули пропускаются
+    SparseVector(size_t size, const std::vector<size_t> &sortedIndices, const std::vector<T> &sortedValues,
+                 std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : data(resource), dense(resource), indices(resource), values(resource), size(size)
+    {
+        checkIndexRange<Index>(size);
+        if (sortedIndices.size() != sortedValues.size())
+            throw std::invalid_argument("Index and value arrays differ in length");
+        indices.reserve(sortedIndices.size());
+        values.reserve(sortedValues.size());
+        for (size_t k = 0; k < sortedIndices.size(); ++k)
+        {
+            if (sortedIndices[k] >= size)
+                throw std::out_of_range("Index out of range");
+            if (k > 0 && sortedIndices[k] <= sortedIndices[k - 1])
+                throw std::invalid_argument("Indices must be strictly increasing");
+            if (sortedValues[k] != 0)
+            {
+                indices.push_back(static_cast<Index>(sortedIndices[k]));
+                values.push_back(sortedValues[k]);
+            }
+        }
+        adapt();
+    }
+
+    // Преобразование из вектора с другим типом индексов
+    template <typename OtherIndex>
+    explicit SparseVector(const SparseVector<T, OtherIndex> &other,
+                          std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : SparseVector(other.getSize(), resource)
+    {
+        std::vector<std::pair<size_t, T>> entries;
+        entries.reserve(other.nonZeros());
+        other.forEach([&](size_t index, T value)
+                      { entries.emplace_back(index, value); });
+        if (other.storageFormat() == StorageFormat::Hash)
+            std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b)
+                      { return a.first < b.first; });
+        clearStorage();
+        format = StorageFormat::Compressed;
+        indices.reserve(entries.size());
+        values.reserve(entries.size());
+        for (const auto &[index, value] : entries)
+        {
+            indices.push_back(static_cast<Index>(index));
+            values.push_back(value);
+        }
+        adapt();
+    }
+
+    // Вычисление выражения за один проход по позициям ненулевых элементов операндов.
+    // Если по оценке результат заполнен плотно, он сразу вычисляется в плотный массив.
+    template <typename E>
+    SparseVector(const VectorExpression<E> &expression,
+                 std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : data(resource), dense(resource), indices(resource), values(resource), size(expression.self().getSize())
+    {
+        checkIndexRange<Index>(size);
+        const E &expr = expression.self();
+        size_t bound = std::min(expr.nonZerosBound(), size);
+        SPARSE_OPERATION(VectorEvaluate);
+        SPARSE_WORK(bound, bound);
+        if (chooseStorageFormat(StorageFormat::Hash, bound, size) == StorageFormat::Dense)
+        {
+            format = StorageFormat::Dense;
+            dense.assign(size, T(0));
+            expr.forEachIndex([&](size_t index)
+                              {
+                T value = expr.get(index);
+                dense[index] = value != 0 ? value : T(0); });
+            for (const T &value : dense)
+                denseNonZeros += value != 0;
+        }
+        else
+        {
+            format = StorageFormat::Hash;
+            data.reserve(bound);
+            expr.forEachIndex([&](size_t index)
+                              {
+                if (data.count(index))
+                    return;
+                T value = expr.get(index);
+                if (value != 0)
+                    data.emplace(index, value); });
+        }
+        adapt();
+    }
+
+    // Выражение может ссылаться на сам вектор (x = x + y * a),
+    // поэтому результат сначала вычисляется отдельно
+    template <typename E>
+    SparseVector &operator=(const VectorExpression<E> &expression)
+    {
+        SparseVector result(expression, resource());
+        result.adaptive = adaptive;
+        if (!adaptive)
+            result.convert(format);
+        *this = std::move(result);
+        return *this;
+    }
+
+    // this += scale * other без создания нового вектора. Память не выделяется, если этот вектор
+    // плотный, хеш-таблица с достаточной ёмкостью или оба вектора сжатые и ёмкости массивов
+    // хватает на объединение индексов (в цикле с постоянным портретом — начиная со второй итерации).
+    // Сжатый вектор и несжатый other: элементы other упорядочиваются во временных массивах.
+    SparseVector &axpy(T scale, const SparseVector &other)
+    {
+        if (size != other.size)
+            throw std::invalid_argument("Vector sizes do not match");
+        if (scale == 0)
+            return *this;
+        if (&other == this)
+            return *this *= T(1) + scale;
+        SPARSE_OPERATION(VectorAxpy);
+        SPARSE_WORK(other.nonZeros(), 2 * other.nonZeros());
+        if (format == StorageFormat::Dense)
+        {
+            other.forEach([&](size_t index, T value)
+                          {
+                T &entry = dense[index];
+                denseNonZeros -= entry != 0;
+                entry += scale * value;
+                if (entry == 0)
+                    entry = 0; // -0 хранится как 0
+                denseNonZeros += entry != 0; });
+        }
+        else if (format == StorageFormat::Hash)
+        {
+            other.forEach([&](size_t index, T value)
+                          {
+                Index key = static_cast<Index>(index);
+                T &entry = data[key];
+                entry += scale * value;
+                if (entry == 0)
+                    data.erase(key); });
+        }
+        else if (other.format == StorageFormat::Compressed)
+            mergeScaled(scale, other.indices, other.values);
+        else
+        {
+            std::pmr::vector<std::pair<size_t, T>> entries(resource());
+            entries.reserve(other.nonZeros());
+            other.forEach([&](size_t index, T value)
+                          { entries.emplace_back(index, value); });
+            if (other.format == StorageFormat::Hash)
+                std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b)
+                          { return a.first < b.first; });
+            std::pmr::vector<Index> otherIndices(resource());
+            std::pmr::vector<T> otherValues(resource());
+            otherIndices.reserve(entries.size());
+            otherValues.reserve(entries.size());
+            for (const auto &[index, value] : entries)
+            {
+                otherIndices.push_back(static_cast<Index>(index));
+                otherValues.push_back(value);
+            }
+            mergeScaled(scale, otherIndices, otherValues);
+        }
+        adapt();
+        return *this;
+    }
+
+    SparseVector &operator+=(const SparseVector &other) { return axpy(T(1), other); }
+    SparseVector &operator-=(const SparseVector &other) { return axpy(T(-1), other); }
+
+    // x += y * a и x -= y * a без вычисления y * a
+    SparseVector &operator+=(const VectorScaled<SparseVector> &scaled) { return axpy(scaled.factor(), scaled.operand()); }
+    SparseVector &operator-=(const VectorScaled<SparseVector> &scaled) { return axpy(-scaled.factor(), scaled.operand()); }
+
+    // Прочие выражения вычисляются во временный вектор
+    template <typename E>
+    SparseVector &operator+=(const VectorExpression<E> &expression)
+    {
+        return axpy(T(1), SparseVector(expression, resource()));
+    }
+
+    template <typename E>
+    SparseVector &operator-=(const VectorExpression<E> &expression)
+    {
+        return axpy(T(-1), SparseVector(expression, resource()));
+    }
+
+    SparseVector &operator*=(T scalar)
+    {
+        SPARSE_OPERATION(VectorScale);
+        SPARSE_WORK(nonZeros(), nonZeros());
+        if (scalar == 0)
+        {
+            // Ёмкость хранилища сохраняется
+            std::fill(dense.begin(), dense.end(), T(0));
+            denseNonZeros = 0;
+            indices.clear();
+            values.clear();
+            data.clear();
+            adapt();
+            return *this;
+        }
+        transformInPlace([scalar](T value)
+                         { return value * scalar; });
+        return *this;
+    }
+
+    // Операнд-временный объект отдаёт своё хранилище результату. Шаблоны принимают только
+    // сами SparseVector (без неявного преобразования выражений), а сложение двух lvalue
+    // по-прежнему возвращает ленивое выражение
+    template <typename L, typename R>
+    static constexpr bool stealsOperand = std::is_same_v<std::decay_t<L>, SparseVector> &&
+                                          std::is_same_v<std::decay_t<R>, SparseVector> &&
+                                          !std::is_lvalue_reference_v<L>;
+
+    template <typename L, typename R, std::enable_if_t<stealsOperand<L, R> || stealsOperand<R, L>, int> = 0>
+    friend SparseVector operator+(L &&left, R &&right)
+    {
+        if constexpr (stealsOperand<L, R>)
+            return std::move(left += right);
+        else
+            return std::move(right += left);
+    }
+
+    template <typename L, typename R, std::enable_if_t<stealsOperand<L, R>, int> = 0>
+    friend SparseVector operator-(L &&left, R &&right) { return std::move(left -= right); }
+
+    template <typename V, std::enable_if_t<stealsOperand<V, V>, int> = 0>
+    friend SparseVector operator*(V &&vec, T scalar) { return std::move(vec *= scalar); }
+
+    T get(size_t index) const
+    {
+        if (index >= size)
+            return 0;
+        if (format == StorageFormat::Dense)
+            return dense[index];
+        if (format == StorageFormat::Compressed)
+        {
+            auto it = std::lower_bound(indices.begin(), indices.end(), index);
+            if (it != indices.end() && *it == index)
+                return values[it - indices.begin()];
+            return 0;
+        }
+        auto it = data.find(index);
+        return it != data.end() ? it->second : T(0);
+    }
+
+    void set(size_t index, T value)
+    {
+        if (index >= size)
+            throw std::out_of_range("Index out of range");
+        if (format == StorageFormat::Dense)
+        {
+            denseNonZeros += value != 0;
+            denseNonZeros -= dense[index] != 0;
+            dense[index] = value != 0 ? value : T(0); // -0 хранится как 0
+        }
+        else if (format == StorageFormat::Compressed)
+        {
+            auto it = std::lower_bound(indices.begin(), indices.end(), index);
+            size_t position = it - indices.begin();
+            if (it != indices.end() && *it == index)
+            {
+                if (value != 0)
+                    values[position] = value;
+                else
+                {
+                    indices.erase(it);
+                    values.erase(values.begin() + position);
+                }
+            }
+            else if (value != 0)
+            {
+                indices.insert(it, static_cast<Index>(index));
+                values.insert(values.begin() + position, value);
+            }
+        }
+        else if (value != 0)
+            data[index] = value;
+        else
+            data.erase(index);
+        adapt();
+    }
+
+    size_t getSize() const { return size; }
+
+    size_t nonZeros() const
+    {
+        if (format == StorageFormat::Dense)
+            return denseNonZeros;
+        if (format == StorageFormat::Compressed)
+            return values.size();
+        return data.size();
+    }
+
+    std::pmr::memory_resource *resource() const { return values.get_allocator().resource(); }
+
+    // Байты, занятые хранилищем
+    size_t memoryUsage() const
+    {
+        return data.memoryUsage() + dense.capacity() * sizeof(T) + indices.capacity() * sizeof(Index) +
+               values.capacity() * sizeof(T);
+    }
+
+    double density() const { return size ? static_cast<double>(nonZeros()) / size : 0; }
+
+    StorageFormat storageFormat() const { return format; }
+
+    // Принудительный выбор формата; автоматическое переключение при этом отключается
+    void setStorageFormat(StorageFormat target)
+    {
+        adaptive = false;
+        convert(target);
+    }
+
+    // Включение (с немедленным выбором формата) или отключение автоматического переключения
+    void setAdaptive(bool enabled)
+    {
+        adaptive = enabled;
+        adapt();
+    }
+
+    // Обход ненулевых элементов в порядке хранения: f(index, value)
+    template <typename F>
+    void forEach(F f) const
+    {
+        if (format == StorageFormat::Dense)
+        {
+            for (size_t i = 0; i < size; ++i)
+                if (dense[i] != 0)
+                    f(i, dense[i]);
+        }
+        else if (format == StorageFormat::Compressed)
+        {
+            for (size_t k = 0; k < values.size(); ++k)
+                f(indices[k], values[k]);
+        }
+        else
+        {
+            for (const auto &[index, value] : data)
+                f(index, value);
+        }
+    }
+
+    // Интерфейс листа выражения
+    size_t nonZerosBound() const { return nonZeros(); }
+
+    template <typename F>
+    void forEachIndex(F f) const
+    {
+        forEach([&](size_t index, const T &)
+                { f(index); });
+    }
+
+    // Произведения суммируются в Accumulator<T> (для float — в double)
+    T dot(const SparseVector &other) const
+    {
+        if (size != other.size)
+            throw std::invalid_argument("Vector sizes do not match");
+        SPARSE_OPERATION(VectorDot);
+        SPARSE_WORK(nonZeros() + other.nonZeros(), 2 * std::min(nonZeros(), other.nonZeros()));
+        Accumulator<T> result = 0;
+        if (format == StorageFormat::Dense && other.format == StorageFormat::Dense)
+        {
+            for (size_t i = 0; i < size; ++i)
+                result += static_cast<Accumulator<T>>(dense[i]) * other.dense[i];
+        }
+        else if (format == StorageFormat::Compressed && other.format == StorageFormat::Compressed)
+        {
+            for (size_t i = 0, j = 0; i < indices.size() && j < other.indices.size();)
+            {
+                if (indices[i] < other.indices[j])
+                    ++i;
+                else if (other.indices[j] < indices[i])
+                    ++j;
+                else
+                    result += static_cast<Accumulator<T>>(values[i++]) * other.values[j++];
+            }
+        }
+        else
+        {
+            // Обход вектора с меньшим числом элементов и поиск в другом
+            const SparseVector &shorter = nonZeros() <= other.nonZeros() ? *this : other;
+            const SparseVector &longer = &shorter == this ? other : *this;
+            shorter.forEach([&](size_t index, T value)
+                            { result += static_cast<Accumulator<T>>(value) * longer.get(index); });
+        }
+        return static_cast<T>(result);
+    }
+
+    // Итератор по ненулевым элементам для разреженного вектора
+    class Iterator
+    {
+    private:
+        const SparseVector *vector;
+        size_t position; // индекс для плотного формата, номер элемента для сжатого
+        typename FlatHashMap<T, Index>::const_iterator it;
+
+        void skipZeros()
+        {
+            if (vector->format == StorageFormat::Dense)
+                while (position < vector->size && vector->dense[position] == 0)
+                    ++position;
+        }
+
+    public:
+        Iterator(const SparseVector *vector, size_t position,
+                 typename FlatHashMap<T, Index>::const_iterator iterator)
+            : vector(vector), position(position), it(iterator)
+        {
+            skipZeros();
+        }
+
+        std::pair<size_t, T> operator*()
+        {
+            if (vector->format == StorageFormat::Dense)
+                return {position, vector->dense[position]};
+            if (vector->format == StorageFormat::Compressed)
+                return {vector->indices[position], vector->values[position]};
+            return *it;
+        }
+        Iterator &operator++()
+        {
+            if (vector->format == StorageFormat::Hash)
+                ++it;
+            else
+            {
+                ++position;
+                skipZeros();
+            }
+            return *this;
+        }
+        bool operator!=(const Iterator &other) const { return position != other.position || it != other.it; }
+    };
+
+    Iterator begin() { return Iterator(this, 0, data.cbegin()); }
+    Iterator end()
+    {
+        size_t last = format == StorageFormat::Dense ? size : format == StorageFormat::Compressed ? values.size() : 0;
+        return Iterator(this, last, data.cend());
+    }
+
+    // Поэлементное умножение на скаляр
+    SparseVector elementWiseMultiply(T scalar) const
+    {
+        return transform([scalar](T value)
+                         { return value * scalar; });
+    }
+
+    // Поэлементное возведение в степень
+    SparseVector power(T exponent) const
+    {
+        return transform([exponent](T value)
+                         { return static_cast<T>(std::pow(value, exponent)); });
+    }
+
+    void print() const
+    {
+        for (size_t i = 0; i < size; ++i)
+            std::cout << get(i) << " ";
+        std::cout << "\n";
+    }
+};
+
+#endif // SPARSE_VECTOR_HPP
@@ -0,0 +1,297 @@
+#ifndef STORAGE_FORMAT_HPP
+#define STORAGE_FORMAT_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Выбор формата хранения SparseVector/SparseMatrix по заполненности.
+//   Dense      — плотный массив: выгоден, когда ненулевых элементов много;
+//   Compressed — отсортированные массивы индексов и значений (для матрицы — по строкам):
+//                быстрый обход и слияние, но вставка стоит O(длины строки);
+//   Hash       — хеш-таблица: вставка за O(1) при любой длине строки.
+// По умолчанию действуют фиксированные пороги StorageThresholds, поэтому формат (а с ним
+// скорость и порядок обхода) одинаков от запуска к запуску. Переменная окружения
+// SPARSE_STORAGE_PROFILE задаёт файл профиля; значение "calibrate" вместо пути включает
+// короткий замер при первом обращении (его результат стоит сохранить saveStorageProfile).
+
+enum class StorageFormat
+{
+    Dense,
+    Hash,
+    Compressed
+};
+
+inline const char *storageFormatName(StorageFormat format)
+{
+    switch (format)
+    {
+    case StorageFormat::Dense:
+        return "dense";
+    case StorageFormat::Compressed:
+        return "compressed";
+    default:
+        return "hash";
+    }
+}
+
+struct StorageThresholds
+{
+    double denseDensity = 0.25;       // доля ненулевых элементов, начиная с которой вектор хранится плотно
+    double denseMatrixDensity = 0.25; // то же для матрицы (плотный массив rows * cols)
+    size_t compressedNonZeros = 1024; // наибольшая длина строки (вектора) в сжатом формате
+};
+
+namespace storage_detail
+{
+    // Минимальное время из нескольких запусков, секунды
+    template <typename F>
+    double bestTime(F f, int repeats = 3)
+    {
+        double best = 1e30;
+        for (int r = 0; r < repeats; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            f();
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(end - start).count());
+        }
+        return best;
+    }
+
+    inline std::vector<size_t> randomPositions(size_t count, size_t range, std::mt19937_64 &rng)
+    {
+        std::vector<size_t> positions(count);
+        for (size_t &position : positions)
+            position = rng() % range;
+        return positions;
+    }
+
+    inline std::vector<size_t> sortedUnique(std::vector<size_t> positions)
+    {
+        std::sort(positions.begin(), positions.end());
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+        return positions;
+    }
+
+    // Результаты замеров, чтобы компилятор не выбросил вычисления
+    inline volatile double sink = 0;
+}
+
+// Замер на векторах длины 2^14. Порог плотного формата векторов — наименьшая плотность, при которой
+// сложение двух плотных векторов не медленнее сложения в хеш-таблицах и слиянием (порог матриц
+// замер не меняет: выделение rows * cols им не оценивается);
+// порог сжатого формата — наибольшее число элементов, при котором построение вставками
+// в отсортированные массивы и сложение слиянием не медленнее, чем в хеш-таблицах.
+inline StorageThresholds calibrateStorageThresholds()
+{
+    using namespace storage_detail;
+    const size_t n = size_t(1) << 14;
+    std::mt19937_64 rng(12345);
+    StorageThresholds thresholds;
+
+    thresholds.denseDensity = 1.0;
+    for (double density : {0.01, 0.02, 0.05, 0.1, 0.2, 0.3, 0.5, 0.7})
+    {
+        std::vector<size_t> a = sortedUnique(randomPositions(size_t(density * n), n, rng));
+        std::vector<size_t> b = sortedUnique(randomPositions(size_t(density * n), n, rng));
+        std::vector<double> denseA(n, 0), denseB(n, 0), denseResult(n);
+        std::unordered_map<size_t, double> hashA, hashB;
+        for (size_t i : a)
+            denseA[i] = hashA[i] = 1.0 + i;
+        for (size_t i : b)
+            denseB[i] = hashB[i] = 2.0 + i;
+        std::vector<double> valuesA(a.size(), 1.0), valuesB(b.size(), 2.0);
+
+        double dense = bestTime([&]
+                                {
+            size_t count = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                denseResult[i] = denseA[i] + denseB[i];
+                count += denseResult[i] != 0;
+            }
+            sink = count; });
+        double hash = bestTime([&]
+                               {
+            std::unordered_map<size_t, double> result;
+            result.reserve(hashA.size() + hashB.size());
+            for (const auto &[index, value] : hashA)
+                result.emplace(index, value + (hashB.count(index) ? hashB.at(index) : 0.0));
+            for (const auto &[index, value] : hashB)
+                if (!hashA.count(index))
+                    result.emplace(index, value);
+            sink = result.size(); });
+        double compressed = bestTime([&]
+                                     {
+            std::vector<size_t> indices;
+            std::vector<double> values;
+            indices.reserve(a.size() + b.size());
+            values.reserve(a.size() + b.size());
+            size_t i = 0, j = 0;
+            while (i < a.size() || j < b.size())
+            {
+                if (j == b.size() || (i < a.size() && a[i] < b[j]))
+                {
+                    indices.push_back(a[i]);
+                    values.push_back(valuesA[i++]);
+                }
+                else if (i == a.size() || b[j] < a[i])
+                {
+                    indices.push_back(b[j]);
+                    values.push_back(valuesB[j++]);
+                }
+                else
+                {
+                    indices.push_back(a[i]);
+                    values.push_back(valuesA[i++] + valuesB[j++]);
+                }
+            }
+            sink = values.size(); });
+        if (dense <= std::min(hash, compressed))
+        {
+            thresholds.denseDensity = density;
+            break;
+        }
+    }
+
+    thresholds.compressedNonZeros = 0;
+    for (size_t count : {16, 64, 256, 1024, 4096, 8192})
+    {
+        std::vector<size_t> positions = randomPositions(count, n * 16, rng);
+        double compressed = bestTime([&]
+                                     {
+            std::vector<size_t> indices;
+            std::vector<double> values;
+            for (size_t position : positions)
+            {
+                auto it = std::lower_bound(indices.begin(), indices.end(), position);
+                if (it != indices.end() && *it == position)
+                    continue;
+                values.insert(values.begin() + (it - indices.begin()), 1.0);
+                indices.insert(it, position);
+            }
+            double sum = 0;
+            for (size_t k = 0; k < values.size(); ++k)
+                sum += values[k] * indices[k];
+            sink = sum; });
+        double hash = bestTime([&]
+                               {
+            std::unordered_map<size_t, double> table;
+            for (size_t position : positions)
+                table.emplace(position, 1.0);
+            double sum = 0;
+            for (const auto &[index, value] : table)
+                sum += value * index;
+            sink = sum; });
+        if (compressed > hash)
+            break;
+        thresholds.compressedNonZeros = count;
+    }
+    return thresholds;
+}
+
+// Профиль — текстовый файл со строками "ключ значение":
+//   dense_density 0.25
+//   dense_matrix_density 0.25
+//   compressed_nonzeros 1024
+inline StorageThresholds loadStorageProfile(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Cannot open storage profile: " + path);
+    StorageThresholds thresholds;
+    std::string key;
+    while (in >> key)
+    {
+        if (key == "dense_density")
+            in >> thresholds.denseDensity;
+        else if (key == "dense_matrix_density")
+            in >> thresholds.denseMatrixDensity;
+        else if (key == "compressed_nonzeros")
+            in >> thresholds.compressedNonZeros;
+        else
+            throw std::invalid_argument("Unknown storage profile key: " + key);
+        if (!in)
+            throw std::invalid_argument("Invalid value for storage profile key: " + key);
+    }
+    return thresholds;
+}
+
+inline void saveStorageProfile(const std::string &path, const StorageThresholds &thresholds)
+{
+    std::ofstream out(path);
+    if (!out)
+        throw std::runtime_error("Cannot open storage profile: " + path);
+    out << "dense_density " << thresholds.denseDensity << "\n"
+        << "dense_matrix_density " << thresholds.denseMatrixDensity << "\n"
+        << "compressed_nonzeros " << thresholds.compressedNonZeros << "\n";
+}
+
+// Текущие пороги; определяются при первом обращении
+inline StorageThresholds &storageThresholds()
+{
+    static StorageThresholds thresholds = []
+    {
+        const char *profile = std::getenv("SPARSE_STORAGE_PROFILE");
+        if (!profile || !*profile)
+            return StorageThresholds();
+        if (std::string(profile) == "calibrate")
+            return calibrateStorageThresholds();
+        return loadStorageProfile(profile);
+    }();
+    return thresholds;
+}
+
+// Изменение порогов влияет на последующие переключения форматов; не потокобезопасно
+inline void setStorageThresholds(const StorageThresholds &thresholds)
+{
+    storageThresholds() = thresholds;
+}
+
+namespace storage_detail
+{
+    // Формат для nonZeros ненулевых элементов из elements, разбитых на lines строк, самая длинная
+    // из которых содержит longestLine элементов.
+    // Для выхода из текущего формата пороги вдвое строже, чем для входа, чтобы элементы,
+    // добавляемые и удаляемые около порога, не вызывали преобразование при каждом изменении.
+    // Сжатому формату нужен буфер на каждую строку, поэтому он не выбирается для почти пустых матриц.
+    inline StorageFormat choose(StorageFormat current, size_t nonZeros, size_t elements, size_t lines,
+                                size_t longestLine, double denseDensity)
+    {
+        double density = elements ? static_cast<double>(nonZeros) / elements : 0;
+        if (density >= denseDensity || (current == StorageFormat::Dense && density >= denseDensity / 2))
+            return StorageFormat::Dense;
+
+        const StorageThresholds &thresholds = storageThresholds();
+        bool staying = current == StorageFormat::Compressed;
+        double lengthLimit = staying ? thresholds.compressedNonZeros : thresholds.compressedNonZeros / 2.0;
+        size_t lineLimit = staying ? 8 * nonZeros + 128 : 4 * nonZeros + 64;
+        if (longestLine <= lengthLimit && lines <= lineLimit)
+            return StorageFormat::Compressed;
+        return StorageFormat::Hash;
+    }
+}
+
+// Формат вектора длины size с nonZeros ненулевыми элементами
+inline StorageFormat chooseStorageFormat(StorageFormat current, size_t nonZeros, size_t size)
+{
+    return storage_detail::choose(current, nonZeros, size, 1, nonZeros, storageThresholds().denseDensity);
+}
+
+// Формат матрицы rows x cols; longestRow — длина самой длинной строки: одна длинная строка
+// делает вставку в сжатом формате дорогой, даже если средняя длина строк мала
+inline StorageFormat chooseMatrixStorageFormat(StorageFormat current, size_t nonZeros, size_t rows, size_t cols,
+                                               size_t longestRow)
+{
+    return storage_detail::choose(current, nonZeros, rows * cols, rows, longestRow,
+                                  storageThresholds().denseMatrixDensity);
+}
+
+#endif // STORAGE_FORMAT_HPP
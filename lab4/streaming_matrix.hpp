@@ -0,0 +1,430 @@
+#ifndef STREAMING_MATRIX_HPP
+#define STREAMING_MATRIX_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "csr_matrix.hpp"
+#include "matrix_io.hpp"
+#include "numeric_types.hpp"
+
+// Матрица на диске для умножения на вектор без загрузки в память целиком.
+// Файл делится на блоки последовательных строк; каждый блок — самостоятельный кусок CSR
+// (row_ptr от начала блока, номера столбцов, значения). Номера столбцов хранятся
+// как uint32_t, если столбцов меньше 2^32, иначе как uint64_t.
+//
+// Умножение читает блоки по порядку в два буфера: пока считается блок k, следующий блок
+// читается асинхронно, поэтому чтение и вычисления перекрываются. Память под матрицу
+// ограничена двумя буферами наибольшего блока и не должна превышать бюджет
+// (векторы x и y в бюджет не входят). Статистика последнего умножения содержит
+// прочитанные байты, время чтения и ожидания и пересчитывается в ГБ/с и GFLOP/s.
+//
+// Файл пишет StreamingMatrixWriter строка за строкой (матрица тоже не обязана
+// помещаться в память) или writeStreamingMatrix из готовой CSRMatrix.
+
+struct StreamingHeader
+{
+    char magic[8];         // "SPSTRM1"
+    uint32_t byteOrder;    // 0x01020304 в порядке байтов записавшей машины
+    uint32_t valueSize;    // sizeof(T)
+    uint32_t valueIsFloat; // 1 — число с плавающей точкой
+    uint32_t indexSize;    // 4 или 8 байт на номер столбца
+    uint64_t rows, cols;
+    uint64_t nonZeros;
+    uint64_t chunkCount;
+    uint64_t tableOffset; // смещение таблицы блоков (StreamingChunk[chunkCount])
+};
+
+struct StreamingChunk
+{
+    uint64_t firstRow, rowCount;
+    uint64_t nonZeros;
+    uint64_t offset, bytes; // положение блока в файле
+};
+
+namespace streaming_detail
+{
+    // Расположение массивов внутри блока: row_ptr, номера столбцов, значения (с выравниванием по 8)
+    inline uint64_t indexOffset(uint64_t rowCount) { return (rowCount + 1) * sizeof(uint64_t); }
+
+    inline uint64_t valueOffset(uint64_t rowCount, uint64_t nonZeros, uint32_t indexSize)
+    {
+        return (indexOffset(rowCount) + nonZeros * indexSize + 7) / 8 * 8;
+    }
+
+    template <typename T>
+    uint64_t chunkBytes(uint64_t rowCount, uint64_t nonZeros, uint32_t indexSize)
+    {
+        return valueOffset(rowCount, nonZeros, indexSize) + nonZeros * sizeof(T);
+    }
+
+    // Проверка прочитанного блока: row_ptr начинается с нуля, не убывает и заканчивается
+    // числом ненулевых элементов блока, номера столбцов меньше cols
+    template <typename Index>
+    void checkChunk(const uint64_t *ptr, const Index *idx, uint64_t rowCount, uint64_t nonZeros, uint64_t cols)
+    {
+        if (ptr[0] != 0 || ptr[rowCount] != nonZeros)
+            throw std::invalid_argument("Streaming matrix chunk row pointers are inconsistent");
+        for (uint64_t i = 0; i < rowCount; ++i)
+            if (ptr[i] > ptr[i + 1])
+                throw std::invalid_argument("Streaming matrix chunk row pointers are inconsistent");
+        for (uint64_t k = 0; k < nonZeros; ++k)
+            if (idx[k] >= cols)
+                throw std::invalid_argument("Streaming matrix chunk column indices are out of range");
+    }
+}
+
+// Статистика одного потокового умножения
+struct StreamingStats
+{
+    size_t bytesRead = 0;
+    size_t chunks = 0;
+    double flops = 0;
+    double seconds = 0;     // всё умножение
+    double readSeconds = 0; // суммарное время чтения блоков (идёт параллельно с вычислениями)
+    double waitSeconds = 0; // время, когда вычисления ждали чтения
+
+    double gigabytesPerSecond() const { return seconds > 0 ? bytesRead / seconds * 1e-9 : 0; }
+    double gflops() const { return seconds > 0 ? flops / seconds * 1e-9 : 0; }
+};
+
+// Запись потоковой матрицы по строкам. Строка добавляется в текущий блок; блок
+// записывается на диск, когда следующая строка не помещается в chunkBytes.
+// Строка длиннее chunkBytes занимает отдельный блок.
+template <typename T>
+class StreamingMatrixWriter
+{
+private:
+    std::ofstream out;
+    std::string path;
+    StreamingHeader header{};
+    size_t chunkBytes;
+    uint64_t offset;
+    std::vector<StreamingChunk> chunks;
+    std::vector<uint64_t> ptr{0};
+    std::vector<uint64_t> idx;
+    std::vector<T> val;
+    bool finished = false;
+
+    void writePadded(const void *data, uint64_t bytes)
+    {
+        static const char padding[snapshot_detail::alignment] = {};
+        uint64_t aligned = snapshot_detail::alignUp(offset);
+        out.write(padding, static_cast<std::streamsize>(aligned - offset));
+        out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        offset = aligned + bytes;
+    }
+
+    void flushChunk()
+    {
+        uint64_t rowCount = ptr.size() - 1;
+        if (rowCount == 0)
+            return;
+        uint64_t nonZeros = idx.size();
+        StreamingChunk chunk{header.rows - rowCount, rowCount, nonZeros, snapshot_detail::alignUp(offset),
+                             streaming_detail::chunkBytes<T>(rowCount, nonZeros, header.indexSize)};
+        // Блок собирается в памяти и пишется одним вызовом
+        std::vector<char> block(chunk.bytes, 0);
+        std::memcpy(block.data(), ptr.data(), ptr.size() * sizeof(uint64_t));
+        char *indices = block.data() + streaming_detail::indexOffset(rowCount);
+        if (header.indexSize == sizeof(uint32_t))
+            for (uint64_t k = 0; k < nonZeros; ++k)
+            {
+                uint32_t narrow = static_cast<uint32_t>(idx[k]);
+                std::memcpy(indices + k * sizeof(uint32_t), &narrow, sizeof(uint32_t));
+            }
+        else
+            std::memcpy(indices, idx.data(), nonZeros * sizeof(uint64_t));
+        std::memcpy(block.data() + streaming_detail::valueOffset(rowCount, nonZeros, header.indexSize), val.data(),
+                    nonZeros * sizeof(T));
+        writePadded(block.data(), chunk.bytes);
+        if (!out)
+            throw std::runtime_error("Cannot write streaming matrix: " + path);
+        chunks.push_back(chunk);
+        ptr.assign(1, 0);
+        idx.clear();
+        val.clear();
+    }
+
+public:
+    StreamingMatrixWriter(const std::string &path, size_t cols, size_t chunkBytes = size_t(16) << 20)
+        : out(path, std::ios::binary), path(path), chunkBytes(chunkBytes), offset(sizeof(StreamingHeader))
+    {
+        if (!out)
+            throw std::runtime_error("Cannot open file: " + path);
+        std::memcpy(header.magic, "SPSTRM1", 8);
+        header.byteOrder = snapshot_detail::byteOrderMark;
+        header.valueSize = sizeof(T);
+        header.valueIsFloat = std::is_floating_point<T>::value ? 1 : 0;
+        header.indexSize = cols <= std::numeric_limits<uint32_t>::max() ? sizeof(uint32_t) : sizeof(uint64_t);
+        header.cols = cols;
+        // Заголовок перезаписывается в finish(), когда известны размеры
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+
+    StreamingMatrixWriter(const StreamingMatrixWriter &) = delete;
+    StreamingMatrixWriter &operator=(const StreamingMatrixWriter &) = delete;
+
+    // Незавершённый файл дописывается; ошибки при этом не выбрасываются из деструктора
+    ~StreamingMatrixWriter()
+    {
+        if (!finished)
+            try
+            {
+                finish();
+            }
+            catch (...)
+            {
+            }
+    }
+
+    // Добавление строки: номера столбцов по возрастанию, без нулевых значений
+    void appendRow(const size_t *columns, const T *values, size_t count)
+    {
+        if (finished)
+            throw std::logic_error("Streaming matrix is already finished");
+        for (size_t k = 0; k < count; ++k)
+        {
+            if (columns[k] >= header.cols)
+                throw std::out_of_range("Index out of range");
+            if (k > 0 && columns[k - 1] >= columns[k])
+                throw std::invalid_argument("Row columns must be sorted and unique");
+        }
+        uint64_t rowCount = ptr.size() - 1;
+        if (rowCount > 0 &&
+            streaming_detail::chunkBytes<T>(rowCount + 1, idx.size() + count, header.indexSize) > chunkBytes)
+            flushChunk();
+        idx.insert(idx.end(), columns, columns + count);
+        val.insert(val.end(), values, values + count);
+        ptr.push_back(idx.size());
+        ++header.rows;
+        header.nonZeros += count;
+    }
+
+    void appendRow(const std::vector<size_t> &columns, const std::vector<T> &values)
+    {
+        if (columns.size() != values.size())
+            throw std::invalid_argument("Row columns and values sizes do not match");
+        appendRow(columns.data(), values.data(), columns.size());
+    }
+
+    // Запись последнего блока, таблицы блоков и заголовка
+    void finish()
+    {
+        if (finished)
+            return;
+        finished = true;
+        flushChunk();
+        header.chunkCount = chunks.size();
+        header.tableOffset = snapshot_detail::alignUp(offset);
+        writePadded(chunks.data(), chunks.size() * sizeof(StreamingChunk));
+        out.seekp(0);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.close();
+        if (!out)
+            throw std::runtime_error("Cannot write streaming matrix: " + path);
+    }
+};
+
+template <typename T>
+void writeStreamingMatrix(const std::string &path, const CSRMatrix<T> &matrix, size_t chunkBytes = size_t(16) << 20)
+{
+    StreamingMatrixWriter<T> writer(path, matrix.getCols(), chunkBytes);
+    const std::vector<size_t> &ptr = matrix.rowPtr();
+    for (size_t i = 0; i < matrix.getRows(); ++i)
+        writer.appendRow(matrix.colIdx().data() + ptr[i], matrix.getValues().data() + ptr[i], ptr[i + 1] - ptr[i]);
+    writer.finish();
+}
+
+// Потоковая матрица: умножение на вектор и A^T x с чтением блоков с диска.
+// Объект хранит открытый файл и буферы, поэтому умножения одного объекта
+// не должны выполняться из нескольких потоков одновременно.
+template <typename T>
+class StreamingMatrix
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    mutable std::ifstream file;
+    std::string path;
+    StreamingHeader header{};
+    std::vector<StreamingChunk> chunks;
+    size_t largestChunk = 0;
+    mutable std::vector<uint64_t> buffers[2]; // uint64_t — выравнивание массивов блока
+    mutable StreamingStats stats;
+
+    static double since(Clock::time_point start) { return std::chrono::duration<double>(Clock::now() - start).count(); }
+
+    // Чтение блока k в буфер с проверкой его индексов; возвращает время чтения.
+    // Проверка идёт в потоке чтения и перекрывается с вычислениями над предыдущим блоком
+    double readChunk(size_t k, std::vector<uint64_t> &buffer) const
+    {
+        Clock::time_point start = Clock::now();
+        const StreamingChunk &chunk = chunks[k];
+        file.seekg(static_cast<std::streamoff>(chunk.offset));
+        file.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(chunk.bytes));
+        if (!file)
+            throw std::runtime_error("Cannot read streaming matrix chunk: " + path);
+        const char *block = reinterpret_cast<const char *>(buffer.data());
+        const uint64_t *ptr = reinterpret_cast<const uint64_t *>(block);
+        const char *indices = block + streaming_detail::indexOffset(chunk.rowCount);
+        if (header.indexSize == sizeof(uint32_t))
+            streaming_detail::checkChunk(ptr, reinterpret_cast<const uint32_t *>(indices), chunk.rowCount,
+                                         chunk.nonZeros, header.cols);
+        else
+            streaming_detail::checkChunk(ptr, reinterpret_cast<const uint64_t *>(indices), chunk.rowCount,
+                                         chunk.nonZeros, header.cols);
+        return since(start);
+    }
+
+    // Обход блоков с чтением следующего блока во время обработки текущего:
+    // f(chunk, row_ptr, col_idx, values), col_idx — uint32_t* или uint64_t*
+    template <typename F>
+    void stream(F f) const
+    {
+        Clock::time_point start = Clock::now();
+        stats = StreamingStats();
+        if (chunks.empty())
+            return;
+        std::future<double> pending = std::async(std::launch::async, [this]
+                                                 { return readChunk(0, buffers[0]); });
+        for (size_t k = 0; k < chunks.size(); ++k)
+        {
+            Clock::time_point waitStart = Clock::now();
+            stats.readSeconds += pending.get();
+            stats.waitSeconds += since(waitStart);
+            if (k + 1 < chunks.size())
+                pending = std::async(std::launch::async, [this, k]
+                                     { return readChunk(k + 1, buffers[(k + 1) % 2]); });
+            const StreamingChunk &chunk = chunks[k];
+            const char *block = reinterpret_cast<const char *>(buffers[k % 2].data());
+            const uint64_t *ptr = reinterpret_cast<const uint64_t *>(block);
+            const char *indices = block + streaming_detail::indexOffset(chunk.rowCount);
+            const T *values = reinterpret_cast<const T *>(
+                block + streaming_detail::valueOffset(chunk.rowCount, chunk.nonZeros, header.indexSize));
+            if (header.indexSize == sizeof(uint32_t))
+                f(chunk, ptr, reinterpret_cast<const uint32_t *>(indices), values);
+            else
+                f(chunk, ptr, reinterpret_cast<const uint64_t *>(indices), values);
+            stats.bytesRead += chunk.bytes;
+            ++stats.chunks;
+        }
+        stats.flops = 2.0 * header.nonZeros;
+        stats.seconds = since(start);
+    }
+
+public:
+    using value_type = T;
+
+    // memoryBudget — наибольший объём буферов блоков в байтах
+    explicit StreamingMatrix(const std::string &path, size_t memoryBudget = size_t(64) << 20)
+        : file(path, std::ios::binary), path(path)
+    {
+        if (!file)
+            throw std::runtime_error("Cannot open file: " + path);
+        if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+            throw std::invalid_argument("Streaming matrix file is truncated");
+        if (std::memcmp(header.magic, "SPSTRM1", 8) != 0)
+            throw std::invalid_argument("Not a streaming matrix file");
+        if (header.byteOrder != snapshot_detail::byteOrderMark)
+            throw std::invalid_argument("Streaming matrix was written with a different byte order");
+        if (header.valueSize != sizeof(T) || header.valueIsFloat != (std::is_floating_point<T>::value ? 1u : 0u))
+            throw std::invalid_argument("Streaming matrix value type does not match");
+        if (header.indexSize != sizeof(uint32_t) && header.indexSize != sizeof(uint64_t))
+            throw std::invalid_argument("Streaming matrix index size must be 4 or 8 bytes");
+        file.seekg(0, std::ios::end);
+        uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+        // Границы проверяются делением, чтобы повреждённые размеры не переполняли произведения
+        if (header.tableOffset < sizeof(StreamingHeader) || header.tableOffset > fileSize ||
+            header.chunkCount > (fileSize - header.tableOffset) / sizeof(StreamingChunk))
+            throw std::invalid_argument("Streaming matrix file is truncated");
+        chunks.resize(header.chunkCount);
+        file.seekg(static_cast<std::streamoff>(header.tableOffset));
+        if (!file.read(reinterpret_cast<char *>(chunks.data()),
+                       static_cast<std::streamsize>(chunks.size() * sizeof(StreamingChunk))))
+            throw std::invalid_argument("Streaming matrix file is truncated");
+        uint64_t nextRow = 0, totalNonZeros = 0;
+        for (const StreamingChunk &chunk : chunks)
+        {
+            if (chunk.firstRow != nextRow || chunk.rowCount == 0 || chunk.rowCount >= fileSize / sizeof(uint64_t) ||
+                chunk.nonZeros > fileSize / header.indexSize ||
+                chunk.bytes != streaming_detail::chunkBytes<T>(chunk.rowCount, chunk.nonZeros, header.indexSize))
+                throw std::invalid_argument("Streaming matrix chunk table is inconsistent");
+            if (chunk.offset < sizeof(StreamingHeader) || chunk.offset > fileSize ||
+                chunk.bytes > fileSize - chunk.offset)
+                throw std::invalid_argument("Streaming matrix file is truncated");
+            nextRow += chunk.rowCount;
+            totalNonZeros += chunk.nonZeros;
+            largestChunk = std::max<size_t>(largestChunk, chunk.bytes);
+        }
+        if (nextRow != header.rows || totalNonZeros != header.nonZeros)
+            throw std::invalid_argument("Streaming matrix chunk table is inconsistent");
+        if (2 * largestChunk > memoryBudget)
+            throw std::invalid_argument("Memory budget is smaller than two chunks");
+        for (std::vector<uint64_t> &buffer : buffers)
+            buffer.resize((largestChunk + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    }
+
+    size_t getRows() const { return header.rows; }
+    size_t getCols() const { return header.cols; }
+    size_t nonZeros() const { return header.nonZeros; }
+    size_t chunkCount() const { return chunks.size(); }
+
+    // Память под буферы блоков
+    size_t bufferBytes() const { return 2 * largestChunk; }
+
+    // Статистика последнего умножения
+    const StreamingStats &lastStats() const { return stats; }
+
+    template <typename V>
+    std::vector<V> multiply(const std::vector<V> &vec) const
+    {
+        using Sum = Accumulator<std::common_type_t<T, V>>;
+        if (header.cols != vec.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<V> result(header.rows, V(0));
+        stream([&](const StreamingChunk &chunk, const uint64_t *ptr, const auto *idx, const T *val)
+               {
+            for (uint64_t i = 0; i < chunk.rowCount; ++i)
+            {
+                Sum sum = 0;
+                for (uint64_t k = ptr[i]; k < ptr[i + 1]; ++k)
+                    sum += static_cast<Sum>(val[k]) * vec[idx[k]];
+                result[chunk.firstRow + i] = static_cast<V>(sum);
+            } });
+        return result;
+    }
+
+    std::vector<T> operator*(const std::vector<T> &vec) const { return multiply(vec); }
+
+    // A^T x: элемент (row, col) блока добавляет value * vec[row] к result[col]
+    std::vector<T> multiplyTransposed(const std::vector<T> &vec) const
+    {
+        if (header.rows != vec.size())
+            throw std::invalid_argument("Matrix and vector dimensions do not match");
+        std::vector<Accumulator<T>> sums(header.cols, Accumulator<T>(0));
+        stream([&](const StreamingChunk &chunk, const uint64_t *ptr, const auto *idx, const T *val)
+               {
+            for (uint64_t i = 0; i < chunk.rowCount; ++i)
+            {
+                T x = vec[chunk.firstRow + i];
+                if (x == 0)
+                    continue;
+                for (uint64_t k = ptr[i]; k < ptr[i + 1]; ++k)
+                    sums[idx[k]] += static_cast<Accumulator<T>>(val[k]) * x;
+            } });
+        return std::vector<T>(sums.begin(), sums.end());
+    }
+};
+
+#endif // STREAMING_MATRIX_HPP
@@ -0,0 +1,392 @@
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "expression.hpp"
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+#include "csr_matrix.hpp"
+#include "parallel_spmv.hpp"
+#include "thread_pool.hpp"
+
+// Отложенное выполнение цепочек операций. Операции записываются в TaskGraph как узлы
+// ориентированного ациклического графа (ребро — результат одного узла нужен другому),
+// а run() выполняет независимые узлы параллельно в WorkStealingPool. Большие
+// умножения (SpMV и произведение матриц) внутри узла дополнительно делятся по строкам
+// на подзадачи того же пула, так что ядра заняты и при узком месте в одной операции.
+//
+//   TaskGraph graph;
+//   auto a = graph.input(A), b = graph.input(B);
+//   auto c = graph.add(graph.transpose(a), b);      // A^T + B
+//   auto d = graph.multiply(graph.transpose(b), a); // B^T * A, параллельно с c
+//   graph.run(pool);
+//   SparseMatrix<double> C = c.take();
+
+namespace task_graph_detail
+{
+    // Число подзадач для операции с nonZeros элементами: по grain элементов, но не больше
+    // четырёх на поток (остальное выравнивает перехват); без рабочих потоков — одна
+    inline size_t splitCount(const WorkStealingPool &pool, size_t nonZeros, size_t grain)
+    {
+        if (pool.threadCount() == 0)
+            return 1;
+        return std::max<size_t>(1, std::min(nonZeros / grain, 4 * (pool.threadCount() + 1)));
+    }
+}
+
+// Ядра, делящие одну большую операцию на подзадачи по строкам. grain — примерное число
+// ненулевых элементов на подзадачу; операции меньше grain выполняются одной задачей.
+template <typename T, typename Index, typename V>
+std::vector<V> parallelMultiply(WorkStealingPool &pool, const CSRMatrix<T, Index> &matrix, const std::vector<V> &vec,
+                                size_t grain)
+{
+    if (matrix.getCols() != vec.size())
+        throw std::invalid_argument("Matrix and vector dimensions do not match");
+    std::vector<size_t> bounds = partitionRowsByNonZeros(matrix.rowPtr(),
+                                                         task_graph_detail::splitCount(pool, matrix.nonZeros(), grain));
+    std::vector<V> result(matrix.getRows(), V(0));
+    using Sum = Accumulator<std::common_type_t<T, V>>;
+    const size_t *ptr = matrix.rowPtr().data();
+    const Index *idx = matrix.colIdx().data();
+    const T *val = matrix.getValues().data();
+    pool.parallelFor(bounds.size() - 1, [&](size_t p)
+                     {
+        for (size_t i = bounds[p]; i < bounds[p + 1]; ++i)
+        {
+            Sum sum = 0;
+            for (size_t k = ptr[i]; k < ptr[i + 1]; ++k)
+                sum += static_cast<Sum>(val[k]) * vec[idx[k]];
+            result[i] = static_cast<V>(sum);
+        } });
+    return result;
+}
+
+template <typename T, typename Index, typename V>
+std::vector<V> parallelMultiply(WorkStealingPool &pool, const SparseMatrix<T, Index> &matrix,
+                                const std::vector<V> &vec, size_t grain)
+{
+    if (matrix.getCols() != vec.size())
+        throw std::invalid_argument("Matrix and vector dimensions do not match");
+    size_t rows = matrix.getRows();
+    size_t parts = std::min(std::max<size_t>(rows, 1), task_graph_detail::splitCount(pool, matrix.nonZeros(), grain));
+    std::vector<V> result(rows, V(0));
+    pool.parallelFor(parts, [&](size_t p)
+                     { matrix.multiplyRows(vec, result, rows * p / parts, rows * (p + 1) / parts); });
+    return result;
+}
+
+// Произведение CSR-матриц по блокам строк A: каждый блок умножается на B отдельно,
+// затем массивы блоков склеиваются
+template <typename T, typename Index>
+CSRMatrix<T, Index> parallelMultiply(WorkStealingPool &pool, const CSRMatrix<T, Index> &a, const CSRMatrix<T, Index> &b,
+                                     size_t grain)
+{
+    if (a.getCols() != b.getRows())
+        throw std::invalid_argument("Matrix dimensions do not allow multiplication");
+    std::vector<size_t> bounds = partitionRowsByNonZeros(a.rowPtr(), task_graph_detail::splitCount(pool, a.nonZeros(), grain));
+    size_t parts = bounds.size() - 1;
+    if (parts == 1)
+        return a * b;
+    std::vector<std::optional<CSRMatrix<T, Index>>> blocks(parts);
+    const std::vector<size_t> &ptr = a.rowPtr();
+    pool.parallelFor(parts, [&](size_t p)
+                     {
+        size_t first = bounds[p], last = bounds[p + 1];
+        std::vector<size_t> blockPtr(ptr.begin() + first, ptr.begin() + last + 1);
+        for (size_t &offset : blockPtr)
+            offset -= ptr[first];
+        CSRMatrix<T, Index> rows(last - first, a.getCols(), std::move(blockPtr),
+                                 std::vector<Index>(a.colIdx().begin() + ptr[first], a.colIdx().begin() + ptr[last]),
+                                 std::vector<T>(a.getValues().begin() + ptr[first], a.getValues().begin() + ptr[last]));
+        blocks[p].emplace(rows * b); });
+    std::vector<size_t> row_ptr(1, 0);
+    std::vector<Index> col_idx;
+    std::vector<T> values;
+    for (const auto &block : blocks)
+    {
+        size_t base = col_idx.size();
+        for (size_t i = 1; i < block->rowPtr().size(); ++i)
+            row_ptr.push_back(base + block->rowPtr()[i]);
+        col_idx.insert(col_idx.end(), block->colIdx().begin(), block->colIdx().end());
+        values.insert(values.end(), block->getValues().begin(), block->getValues().end());
+    }
+    return CSRMatrix<T, Index>(a.getRows(), b.getCols(), std::move(row_ptr), std::move(col_idx), std::move(values));
+}
+
+// Для SparseMatrix произведение, которое делится на части, считается через CSR
+template <typename T, typename Index>
+SparseMatrix<T, Index> parallelMultiply(WorkStealingPool &pool, const SparseMatrix<T, Index> &a,
+                                        const SparseMatrix<T, Index> &b, size_t grain)
+{
+    if (task_graph_detail::splitCount(pool, a.nonZeros(), grain) == 1)
+        return a * b;
+    return SparseMatrix<T, Index>(
+        parallelMultiply(pool, CSRMatrix<T, Index>(a), CSRMatrix<T, Index>(b), grain).toSparseMatrix(), a.resource());
+}
+
+// Остальные сочетания — обычным оператором в одной задаче
+template <typename A, typename B>
+auto parallelMultiply(WorkStealingPool &, const A &a, const B &b, size_t)
+{
+    return a * b;
+}
+
+namespace task_graph_detail
+{
+    template <typename E, typename = void>
+    struct IsLazy : std::false_type
+    {
+    };
+
+    template <typename E>
+    struct IsLazy<E, std::enable_if_t<!E::is_leaf>> : std::true_type
+    {
+    };
+
+    // Ленивые выражения (expression.hpp) вычисляются в контейнер с типом индексов и источником
+    // памяти операндов, остальное возвращается как есть
+    template <typename E>
+    auto evaluate(E &&value)
+    {
+        using D = std::decay_t<E>;
+        if constexpr (IsLazy<D>::value && std::is_base_of_v<MatrixExpression<D>, D>)
+            return SparseMatrix<typename D::value_type, typename D::index_type>(value, value.resource());
+        else if constexpr (IsLazy<D>::value)
+            return SparseVector<typename D::value_type, typename D::index_type>(value, value.resource());
+        else
+            return D(std::forward<E>(value));
+    }
+
+    template <typename A, typename = void>
+    struct HasInPlaceAdd : std::false_type
+    {
+    };
+
+    template <typename A>
+    struct HasInPlaceAdd<A, std::void_t<decltype(std::declval<A &>() += std::declval<const A &>())>> : std::true_type
+    {
+    };
+
+    // x + y или x - y. Для контейнеров с операциями на месте — копия x и слияние с y:
+    // входы узла константны, а вычисление выражения идёт поэлементно и медленнее
+    template <bool Subtract, typename A, typename B>
+    auto combine(const A &x, const B &y)
+    {
+        if constexpr (std::is_same_v<A, B> && HasInPlaceAdd<A>::value)
+        {
+            A result(x);
+            if constexpr (Subtract)
+                result -= y;
+            else
+                result += y;
+            return result;
+        }
+        else if constexpr (Subtract)
+            return evaluate(x - y);
+        else
+            return evaluate(x + y);
+    }
+
+    // Хранилище результата узла: вычисленное значение или ссылка на внешний объект
+    template <typename R>
+    struct Slot
+    {
+        std::optional<R> value;
+        const R *external = nullptr;
+    };
+}
+
+// Результат узла графа; доступен после TaskGraph::run()
+template <typename R>
+class Deferred
+{
+private:
+    friend class TaskGraph;
+
+    static constexpr size_t noNode = static_cast<size_t>(-1);
+
+    size_t node;
+    std::shared_ptr<task_graph_detail::Slot<R>> slot;
+
+    explicit Deferred(size_t node) : node(node), slot(std::make_shared<task_graph_detail::Slot<R>>()) {}
+
+public:
+    const R &get() const
+    {
+        if (slot->external)
+            return *slot->external;
+        if (!slot->value)
+            throw std::logic_error("Task graph has not been run");
+        return *slot->value;
+    }
+
+    // Перемещение результата из графа
+    R take()
+    {
+        if (slot->external)
+            return *slot->external;
+        if (!slot->value)
+            throw std::logic_error("Task graph has not been run");
+        R result = std::move(*slot->value);
+        slot->value.reset();
+        return result;
+    }
+};
+
+class TaskGraph
+{
+private:
+    struct Node
+    {
+        std::function<void(WorkStealingPool &)> run;
+        std::vector<size_t> dependents;
+        size_t dependencies = 0;
+    };
+
+    std::vector<Node> nodes;
+    size_t grain;
+
+    template <typename... Args>
+    void link(size_t node, const Deferred<Args> &...inputs)
+    {
+        for (size_t input : {inputs.node...})
+            if (input != Deferred<int>::noNode)
+            {
+                nodes[input].dependents.push_back(node);
+                ++nodes[node].dependencies;
+            }
+    }
+
+    // Узел f(pool, входы...) -> результат
+    template <typename F, typename... Args>
+    auto addNode(F f, const Deferred<Args> &...inputs)
+    {
+        using R = std::decay_t<std::invoke_result_t<F, WorkStealingPool &, const Args &...>>;
+        Deferred<R> result(nodes.size());
+        nodes.push_back(Node());
+        nodes.back().run = [f, slot = result.slot, inputs...](WorkStealingPool &pool)
+        { slot->value.emplace(f(pool, inputs.get()...)); };
+        link(result.node, inputs...);
+        return result;
+    }
+
+public:
+    // grain — примерное число ненулевых элементов на подзадачу в умножениях
+    explicit TaskGraph(size_t grain = size_t(1) << 16) : grain(std::max<size_t>(grain, 1)) {}
+
+    size_t size() const { return nodes.size(); }
+
+    // Входные данные по ссылке (без копирования); объект должен жить до конца run()
+    template <typename R>
+    Deferred<R> input(const R &value)
+    {
+        Deferred<R> result(Deferred<R>::noNode);
+        result.slot->external = &value;
+        return result;
+    }
+
+    // Произвольная операция над результатами других узлов
+    template <typename F, typename... Args>
+    auto then(F f, const Deferred<Args> &...inputs)
+    {
+        return addNode([f](WorkStealingPool &, const Args &...values)
+                       { return task_graph_detail::evaluate(f(values...)); },
+                       inputs...);
+    }
+
+    template <typename A>
+    auto transpose(const Deferred<A> &a)
+    {
+        return then([](const A &x)
+                    { return x.transpose(); },
+                    a);
+    }
+
+    template <typename A, typename B>
+    auto add(const Deferred<A> &a, const Deferred<B> &b)
+    {
+        return then([](const A &x, const B &y)
+                    { return task_graph_detail::combine<false>(x, y); },
+                    a, b);
+    }
+
+    template <typename A, typename B>
+    auto subtract(const Deferred<A> &a, const Deferred<B> &b)
+    {
+        return then([](const A &x, const B &y)
+                    { return task_graph_detail::combine<true>(x, y); },
+                    a, b);
+    }
+
+    template <typename A, typename S>
+    auto scale(const Deferred<A> &a, S scalar)
+    {
+        return then([scalar](const A &x)
+                    { return x * scalar; },
+                    a);
+    }
+
+    // Матрица на вектор или матрица на матрицу; большие произведения делятся на подзадачи
+    template <typename A, typename B>
+    auto multiply(const Deferred<A> &a, const Deferred<B> &b)
+    {
+        size_t chunk = grain;
+        return addNode([chunk](WorkStealingPool &pool, const A &x, const B &y)
+                       { return task_graph_detail::evaluate(parallelMultiply(pool, x, y, chunk)); },
+                       a, b);
+    }
+
+    // Выполнение всех узлов: узел ставится в очередь пула, когда готовы все его входы.
+    // После исключения в узле оставшиеся узлы не выполняются, исключение пробрасывается.
+    void run(WorkStealingPool &pool)
+    {
+        std::vector<std::atomic<size_t>> remaining(nodes.size());
+        for (size_t k = 0; k < nodes.size(); ++k)
+            remaining[k].store(nodes[k].dependencies, std::memory_order_relaxed);
+        std::atomic<size_t> unfinished{nodes.size()};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        std::function<void(size_t)> execute = [&](size_t k)
+        {
+            if (!failed.load(std::memory_order_relaxed))
+                try
+                {
+                    nodes[k].run(pool);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error)
+                        error = std::current_exception();
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            for (size_t next : nodes[k].dependents)
+                if (remaining[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    pool.submit([&execute, next]
+                                { execute(next); });
+            unfinished.fetch_sub(1, std::memory_order_release);
+        };
+        for (size_t k = 0; k < nodes.size(); ++k)
+            if (nodes[k].dependencies == 0)
+                pool.submit([&execute, k]
+                            { execute(k); });
+        pool.helpUntil([&]
+                       { return unfinished.load(std::memory_order_acquire) == 0; });
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+#endif // TASK_GRAPH_HPP
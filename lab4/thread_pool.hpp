@@ -0,0 +1,201 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Число потоков по умолчанию: все доступные ядра
+inline size_t defaultThreadCount()
+{
+    size_t count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+// Пул потоков с перехватом задач: у каждого рабочего потока своя очередь, новые задачи
+// рабочий поток кладёт в свою очередь и берёт с того же конца (последние задачи — самые
+// «тёплые» в кеше), а простаивающий поток забирает задачи с другого конца чужих очередей.
+// Поток, ожидающий подзадачи (parallelFor, TaskGraph::run), сам выполняет задачи из очередей,
+// поэтому вложенный параллелизм не приводит к взаимной блокировке.
+class WorkStealingPool
+{
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> nextQueue{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // Пул и номер очереди текущего рабочего потока
+    inline static thread_local WorkStealingPool *currentPool = nullptr;
+    inline static thread_local size_t currentQueue = 0;
+
+    // Своя очередь — с конца, чужие — с начала
+    bool tryTake(size_t self, std::function<void()> &task)
+    {
+        for (size_t k = 0; k < queues.size(); ++k)
+        {
+            Queue &queue = *queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+                continue;
+            if (k == 0)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(size_t index)
+    {
+        currentPool = this;
+        currentQueue = index;
+        std::function<void()> task;
+        while (true)
+        {
+            if (tryTake(index, task))
+            {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [&]
+                      { return stopping || queued.load(std::memory_order_relaxed) > 0; });
+            if (stopping && queued.load(std::memory_order_relaxed) == 0)
+                return;
+        }
+    }
+
+public:
+    // threads — число рабочих потоков; поток, ожидающий результат, тоже выполняет задачи
+    explicit WorkStealingPool(size_t threads = defaultThreadCount())
+    {
+        for (size_t k = 0; k < std::max<size_t>(threads, 1); ++k)
+            queues.push_back(std::make_unique<Queue>());
+        for (size_t k = 0; k < threads; ++k)
+            workers.emplace_back([this, k]
+                                 { workerLoop(k); });
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    // Оставшиеся в очередях задачи выполняются до остановки
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    size_t threadCount() const { return workers.size(); }
+
+    void submit(std::function<void()> task)
+    {
+        size_t index = currentPool == this ? currentQueue : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            // Под мьютексом сна, чтобы засыпающий поток не пропустил уведомление
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queued.fetch_add(1, std::memory_order_relaxed);
+        }
+        wake.notify_one();
+    }
+
+    // Выполнение одной задачи из очередей в вызывающем потоке; false — очереди пусты
+    bool runPendingTask()
+    {
+        std::function<void()> task;
+        if (!tryTake(currentPool == this ? currentQueue : 0, task))
+            return false;
+        task();
+        return true;
+    }
+
+    // Ожидание, пока done() не станет true, с выполнением задач из очередей
+    template <typename Done>
+    void helpUntil(Done done)
+    {
+        while (!done())
+            if (!runPendingTask())
+                std::this_thread::yield();
+    }
+
+    // f(p) для p = 0 .. parts - 1 как отдельные задачи; часть 0 выполняет вызывающий поток.
+    // Первое исключение из частей пробрасывается после завершения всех частей.
+    template <typename F>
+    void parallelFor(size_t parts, F f)
+    {
+        if (parts == 0)
+            return;
+        std::atomic<size_t> remaining{parts - 1};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        auto runPart = [&](size_t p)
+        {
+            try
+            {
+                f(p);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        };
+        for (size_t p = 1; p < parts; ++p)
+            submit([&, p]
+                   {
+                runPart(p);
+                remaining.fetch_sub(1, std::memory_order_release); });
+        runPart(0);
+        helpUntil([&]
+                  { return remaining.load(std::memory_order_acquire) == 0; });
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+// Общий пул процесса для параллельных ядер (runParallel в parallel_spmv.hpp): потоки
+// создаются один раз при первом обращении, а не при каждом умножении. Вызывающий поток
+// выполняет часть работы сам, поэтому рабочих потоков на один меньше, чем ядер
+inline WorkStealingPool &sharedThreadPool()
+{
+    static WorkStealingPool pool(defaultThreadCount() - 1);
+    return pool;
+}
+
+#endif // THREAD_POOL_HPP
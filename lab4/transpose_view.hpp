@@ -0,0 +1,109 @@
+#ifndef TRANSPOSE_VIEW_HPP
+#define TRANSPOSE_VIEW_HPP
+
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+#include "expression.hpp"
+#include "sparse_vector.hpp"
+#include "sparse_matrix.hpp"
+#include "csr_matrix.hpp"
+#include "parallel_spmv.hpp"
+
+namespace transpose_detail
+{
+    // Тип индексов матрицы для вычисления вида как выражения; у плотных матриц его нет
+    template <typename M, typename = void>
+    struct IndexOf
+    {
+        using type = size_t;
+    };
+
+    template <typename M>
+    struct IndexOf<M, std::void_t<typename M::index_type>>
+    {
+        using type = typename M::index_type;
+    };
+}
+
+// Транспонированная матрица без копирования: transposed(A) хранит ссылку на A
+// и переставляет индексы. Умножение на вектор вызывает ядро A^T * x самой матрицы
+// (разбрасывание строк для SparseMatrix/CSR, сбор по столбцам для CSC), поэтому
+// transposed(A) * x не строит A^T. Явная копия — materialize(); для CSR при threads > 1
+// она строится параллельной сортировкой подсчётом.
+// Для SparseMatrix вид — выражение (expression.hpp): SparseMatrix<T> C = transposed(A) + B.
+// Вид не должен переживать матрицу.
+template <typename Matrix>
+class TransposeView : public MatrixExpression<TransposeView<Matrix>>
+{
+private:
+    const Matrix &matrix;
+    size_t threads;
+
+public:
+    using value_type = typename Matrix::value_type;
+    using index_type = typename transpose_detail::IndexOf<Matrix>::type;
+    static constexpr bool is_leaf = false;
+
+    explicit TransposeView(const Matrix &matrix, size_t threads = 1) : matrix(matrix), threads(threads) {}
+
+    const Matrix &base() const { return matrix; }
+
+    size_t getRows() const { return matrix.getCols(); }
+    size_t getCols() const { return matrix.getRows(); }
+    size_t nonZeros() const { return matrix.nonZeros(); }
+
+    value_type get(size_t row, size_t col) const { return matrix.get(col, row); }
+
+    // Интерфейс выражения
+    size_t nonZerosBound() const { return matrix.nonZeros(); }
+    std::pmr::memory_resource *resource() const { return matrix.resource(); }
+
+    template <typename F>
+    void forEachIndex(F f) const
+    {
+        matrix.forEachIndex([&](size_t row, size_t col)
+                            { f(col, row); });
+    }
+
+    std::vector<value_type> operator*(const std::vector<value_type> &vec) const
+    {
+        if constexpr (std::is_same_v<Matrix, CSRMatrix<value_type>>)
+            if (threads > 1)
+            {
+                std::vector<value_type> result(matrix.getCols());
+                spmvTransposeParallel(matrix, vec, result, threads);
+                return result;
+            }
+        return matrix.multiplyTransposed(vec);
+    }
+
+    SparseVector<value_type> operator*(const SparseVector<value_type> &vec) const
+    {
+        return matrix.multiplyTransposed(vec);
+    }
+
+    Matrix materialize() const
+    {
+        if constexpr (std::is_same_v<Matrix, CSRMatrix<value_type>>)
+            if (threads > 1)
+                return transposeParallel(matrix, threads);
+        return matrix.transpose();
+    }
+};
+
+template <typename Matrix>
+TransposeView<Matrix> transposed(const Matrix &matrix, size_t threads = 1)
+{
+    return TransposeView<Matrix>(matrix, threads);
+}
+
+// Транспонирование вида возвращает исходную матрицу
+template <typename Matrix>
+const Matrix &transposed(const TransposeView<Matrix> &view)
+{
+    return view.base();
+}
+
+#endif // TRANSPOSE_VIEW_HPP
@@ -0,0 +1,260 @@
+#ifndef TRIPLET_BUILDER_HPP
+#define TRIPLET_BUILDER_HPP
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "csr_matrix.hpp"
+#include "compressed_vector.hpp"
+#include "parallel_spmv.hpp"
+
+namespace triplet_detail
+{
+    // Резерв под needed элементов с геометрическим ростом: резерв ровно под каждую пачку
+    // делал бы загрузку многими пачками квадратичной
+    template <typename V>
+    void reserveAtLeast(V &buffer, size_t needed)
+    {
+        if (needed > buffer.capacity())
+            buffer.reserve(std::max(2 * buffer.capacity(), needed));
+    }
+}
+
+// Параллельная сортировка: части сортируются в отдельных потоках,
+// затем соседние отсортированные части попарно сливаются (тоже параллельно)
+template <typename It, typename Compare>
+void parallelSort(It first, It last, Compare comp, size_t threads = defaultThreadCount())
+{
+    size_t count = last - first;
+    size_t parts = std::max<size_t>(1, std::min(threads, count / 4096 + 1));
+    std::vector<size_t> bounds(parts + 1);
+    for (size_t p = 0; p <= parts; ++p)
+        bounds[p] = count * p / parts;
+
+    runParallel(parts, [&](size_t p)
+                { std::sort(first + bounds[p], first + bounds[p + 1], comp); });
+    for (size_t width = 1; width < parts; width *= 2)
+    {
+        size_t merges = (parts + 2 * width - 1) / (2 * width);
+        runParallel(merges, [&](size_t m)
+                    {
+            size_t left = 2 * width * m;
+            size_t middle = std::min(parts, left + width);
+            size_t right = std::min(parts, left + 2 * width);
+            if (middle < right)
+                std::inplace_merge(first + bounds[left], first + bounds[middle], first + bounds[right], comp); });
+    }
+}
+
+template <typename T>
+struct Triplet
+{
+    size_t row, col;
+    T value;
+};
+
+// Сборка матрицы из троек (строка, столбец, значение) в формате COO.
+// Тройки добавляются пачками без проверки дубликатов и без хеширования, в том числе
+// из нескольких потоков через отдельные Appender; build() сортирует их параллельно,
+// суммирует дубликаты, отбрасывает нули и возвращает сжатую матрицу.
+// Appender ссылается на свой буфер внутри builder и не должен его переживать; после
+// build() он остаётся действительным и добавляет тройки в следующую сборку, но не
+// должен добавлять одновременно с build().
+template <typename T>
+class TripletBuilder
+{
+private:
+    size_t rows, cols;
+    std::deque<std::vector<Triplet<T>>> buffers; // deque: ссылки на буферы не меняются при добавлении
+    std::mutex mutex;
+
+    void check(size_t row, size_t col) const
+    {
+        if (row >= rows || col >= cols)
+            throw std::out_of_range("Index out of range");
+    }
+
+public:
+    // Буфер одного потока: добавление без синхронизации
+    class Appender
+    {
+    private:
+        TripletBuilder<T> *builder;
+        std::vector<Triplet<T>> *buffer;
+
+    public:
+        Appender(TripletBuilder<T> *builder, std::vector<Triplet<T>> *buffer) : builder(builder), buffer(buffer) {}
+
+        void add(size_t row, size_t col, T value)
+        {
+            builder->check(row, col);
+            buffer->push_back({row, col, value});
+        }
+
+        void addBatch(const std::vector<size_t> &rowIndices, const std::vector<size_t> &colIndices,
+                      const std::vector<T> &values)
+        {
+            if (rowIndices.size() != colIndices.size() || rowIndices.size() != values.size())
+                throw std::invalid_argument("Triplet arrays differ in length");
+            triplet_detail::reserveAtLeast(*buffer, buffer->size() + values.size());
+            for (size_t k = 0; k < values.size(); ++k)
+                add(rowIndices[k], colIndices[k], values[k]);
+        }
+
+        void reserve(size_t count) { triplet_detail::reserveAtLeast(*buffer, buffer->size() + count); }
+    };
+
+    TripletBuilder(size_t rows, size_t cols) : rows(rows), cols(cols), buffers(1) {}
+
+    // Новый буфер для потока; reserve — ожидаемое число троек от этого потока
+    Appender appender(size_t reserve = 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers.emplace_back();
+        buffers.back().reserve(reserve);
+        return Appender(this, &buffers.back());
+    }
+
+    // Добавление в основной буфер (из одного потока)
+    void add(size_t row, size_t col, T value) { Appender(this, &buffers.front()).add(row, col, value); }
+
+    void addBatch(const std::vector<size_t> &rowIndices, const std::vector<size_t> &colIndices,
+                  const std::vector<T> &values)
+    {
+        Appender(this, &buffers.front()).addBatch(rowIndices, colIndices, values);
+    }
+
+    // Резервирование по известной оценке числа ненулевых элементов
+    void reserve(size_t nonZeros) { buffers.front().reserve(nonZeros); }
+
+    size_t size() const
+    {
+        size_t total = 0;
+        for (const auto &buffer : buffers)
+            total += buffer.size();
+        return total;
+    }
+
+    // Построение CSR-матрицы. Память буферов освобождается, после вызова builder пуст.
+    // Сами буферы остаются в deque: на них указывают выданные Appender
+    CSRMatrix<T> build(size_t threads = defaultThreadCount())
+    {
+        size_t total = size();
+        std::vector<Triplet<T>> triplets;
+        triplets.swap(buffers.front());
+        triplets.reserve(total);
+        for (size_t b = 1; b < buffers.size(); ++b)
+        {
+            triplets.insert(triplets.end(), buffers[b].begin(), buffers[b].end());
+            std::vector<Triplet<T>>().swap(buffers[b]);
+        }
+
+        parallelSort(triplets.begin(), triplets.end(), [](const Triplet<T> &a, const Triplet<T> &b)
+                     { return a.row < b.row || (a.row == b.row && a.col < b.col); },
+                     threads);
+
+        // Суммирование дубликатов и удаление нулей за один проход
+        std::vector<size_t> row_ptr(rows + 1, 0), col_idx;
+        std::vector<T> values;
+        col_idx.reserve(triplets.size());
+        values.reserve(triplets.size());
+        for (size_t k = 0; k < triplets.size();)
+        {
+            size_t row = triplets[k].row, col = triplets[k].col;
+            Accumulator<T> sum = 0;
+            for (; k < triplets.size() && triplets[k].row == row && triplets[k].col == col; ++k)
+                sum += triplets[k].value;
+            if (static_cast<T>(sum) != 0)
+            {
+                col_idx.push_back(col);
+                values.push_back(static_cast<T>(sum));
+                ++row_ptr[row + 1];
+            }
+        }
+        for (size_t i = 0; i < rows; ++i)
+            row_ptr[i + 1] += row_ptr[i];
+        return CSRMatrix<T>(rows, cols, std::move(row_ptr), std::move(col_idx), std::move(values));
+    }
+
+    // Отсортированные строки переносятся в SparseMatrix напрямую, без set() на каждый элемент
+    SparseMatrix<T> buildSparseMatrix(size_t threads = defaultThreadCount())
+    {
+        CSRMatrix<T> matrix = build(threads);
+        return SparseMatrix<T>::fromCompressedRows(rows, cols, matrix.rowPtr(), matrix.colIdx(), matrix.getValues());
+    }
+};
+
+// Сборка вектора из пар (индекс, значение) с суммированием дубликатов
+template <typename T>
+class VectorBuilder
+{
+private:
+    size_t size;
+    std::vector<size_t> indices;
+    std::vector<T> values;
+
+public:
+    explicit VectorBuilder(size_t size) : size(size) {}
+
+    void reserve(size_t nonZeros)
+    {
+        indices.reserve(nonZeros);
+        values.reserve(nonZeros);
+    }
+
+    void add(size_t index, T value)
+    {
+        if (index >= size)
+            throw std::out_of_range("Index out of range");
+        indices.push_back(index);
+        values.push_back(value);
+    }
+
+    void addBatch(const std::vector<size_t> &batchIndices, const std::vector<T> &batchValues)
+    {
+        if (batchIndices.size() != batchValues.size())
+            throw std::invalid_argument("Index and value arrays differ in length");
+        triplet_detail::reserveAtLeast(indices, indices.size() + batchIndices.size());
+        triplet_detail::reserveAtLeast(values, values.size() + batchValues.size());
+        for (size_t k = 0; k < batchIndices.size(); ++k)
+            add(batchIndices[k], batchValues[k]);
+    }
+
+    CompressedVector<T> build(size_t threads = defaultThreadCount())
+    {
+        std::vector<std::pair<size_t, T>> entries(indices.size());
+        for (size_t k = 0; k < indices.size(); ++k)
+            entries[k] = {indices[k], values[k]};
+        std::vector<size_t>().swap(indices);
+        std::vector<T>().swap(values);
+        parallelSort(entries.begin(), entries.end(), [](const auto &a, const auto &b)
+                     { return a.first < b.first; },
+                     threads);
+
+        std::vector<size_t> resultIndices;
+        std::vector<T> resultValues;
+        for (size_t k = 0; k < entries.size();)
+        {
+            size_t index = entries[k].first;
+            Accumulator<T> sum = 0;
+            for (; k < entries.size() && entries[k].first == index; ++k)
+                sum += entries[k].second;
+            if (static_cast<T>(sum) != 0)
+            {
+                resultIndices.push_back(index);
+                resultValues.push_back(static_cast<T>(sum));
+            }
+        }
+        return CompressedVector<T>(size, std::move(resultIndices), std::move(resultValues));
+    }
+
+    SparseVector<T> buildSparseVector(size_t threads = defaultThreadCount())
+    {
+        return build(threads).toSparseVector();
+    }
+};
+
+#endif // TRIPLET_BUILDER_HPP